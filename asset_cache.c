@@ -1,17 +1,45 @@
 #include "asset_cache.h"
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rlgl.h"
 #include "utils.h"
 
+// mipmaps are never generated for sheets, the base level is all a texture holds
+static size_t asset_texture_bytes(const Texture texture)
+{
+    return GetPixelDataSize(texture.width, texture.height, texture.format);
+}
+
 AssetEntry* asset_entry_init(const char* asset_path)
 {
     if (!valid_string(asset_path))
         return NULL;
+
+    Image image = LoadImage(asset_path);
+    if (!IsImageReady(image))
+        return NULL;
+
+    AssetEntry* entry = asset_entry_init_from_image(asset_path, image);
+
+    UnloadImage(image);
+
+    return entry;
+}
+
+// uploads an already decoded image, the image stays owned by the caller
+AssetEntry* asset_entry_init_from_image(const char* asset_path, const Image image)
+{
+    if (!valid_string(asset_path) || !IsImageReady(image))
+        return NULL;
     
     const unsigned long int hash_id = hash_string(asset_path);
     if (hash_id == 0)
         return NULL;
 
-    const Texture texture = LoadTexture(asset_path);
+    const Texture texture = LoadTextureFromImage(image);
     if (!IsTextureReady(texture))
         return NULL;
 
@@ -31,6 +59,48 @@ AssetEntry* asset_entry_init(const char* asset_path)
     entry->path = path;
     entry->id = hash_id;
     entry->texture = texture;
+    entry->refs = 0;
+    entry->bytes = asset_texture_bytes(texture);
+    entry->last_used = 0;
+    entry->missing = false;
+    entry->uploading = false;
+    entry->prev = entry->next = NULL;
+
+    return entry;
+}
+
+// an entry for a sheet still being decoded, its texture is uploaded in slices later on, see asset_cache_begin_upload
+AssetEntry* asset_entry_init_pending(const char* asset_path)
+{
+    if (!valid_string(asset_path))
+        return NULL;
+
+    const unsigned long int hash_id = hash_string(asset_path);
+    if (hash_id == 0)
+        return NULL;
+
+    char* path = strdup(asset_path);
+    if (!path)
+        return NULL;
+
+    AssetEntry* entry = malloc(sizeof(AssetEntry));
+    if (!entry) {
+        free(path); path = NULL;
+        return NULL;
+    }
+
+    (*entry) = (AssetEntry) {
+        .texture = (Texture){0},
+        .path = path,
+        .id = hash_id,
+        .refs = 0,
+        .bytes = 0,
+        .last_used = 0,
+        .missing = false,
+        .uploading = true,
+        .prev = NULL,
+        .next = NULL,
+    };
 
     return entry;
 }
@@ -57,20 +127,275 @@ bool asset_entry_is_ready(const AssetEntry* entry)
     return (entry) && (entry->id != 0) && (IsTextureReady(entry->texture)) && (valid_string(entry->path));
 }
 
-void asset_cache_add(AssetCache* cache, AssetEntry* entry)
+AssetCache asset_cache_init(const size_t budget)
 {
-    if (asset_entry_is_ready(entry))
-        HASH_ADD_INT((*cache), id, entry);
+    return (AssetCache) {
+        .slots = NULL,
+        .capacity = 0,
+        .count = 0,
+        .textures = NULL,
+        .texture_capacity = 0,
+        .texture_count = 0,
+        .paths = NULL,
+        .texture_bytes = 0,
+        .budget = budget,
+        .lru_head = NULL,
+        .lru_tail = NULL,
+        .frame = 1,
+        .stats = (AssetCacheStats){0},
+    };
 }
 
-void asset_cache_remove(AssetCache* cache, AssetEntry* entry)
+// fnv-1a ids are weak in their low bits, the finalizer spreads every bit of the key over the slot index
+static size_t asset_hash(unsigned long int id, const size_t capacity)
 {
-    if (!cache || !entry)
+    id ^= id >> 33;
+    id *= 0xff51afd7ed558ccdULL;
+    id ^= id >> 33;
+
+    return id & (capacity - 1);
+}
+
+static size_t asset_slot_index(const AssetCache* cache, const unsigned long int id)
+{
+    return asset_hash(id, cache->capacity);
+}
+
+static size_t asset_cache_probe(const AssetCache* cache, const unsigned long int id)
+{
+    size_t i = asset_slot_index(cache, id);
+
+    while ((cache->slots[i].id != 0) && (cache->slots[i].id != id))
+        i = (i + 1) & (cache->capacity - 1);
+
+    return i;
+}
+
+// keeps the table at most half full so probes stay short
+static bool asset_cache_grow(AssetCache* cache)
+{
+    if ((cache->count + 1) * 2 <= cache->capacity)
+        return true;
+
+    const size_t capacity = (cache->capacity) ? (cache->capacity * 2) : ASSET_CACHE_MIN_SLOTS;
+
+    AssetSlot* slots = calloc(capacity, sizeof(AssetSlot));
+    if (!slots) {
+        fprintf(stderr, "asset_cache_grow: calloc returned null\n");
+        return false;
+    }
+
+    AssetSlot* old_slots = cache->slots;
+    const size_t old_capacity = cache->capacity;
+
+    cache->slots = slots;
+    cache->capacity = capacity;
+
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old_slots[i].id != 0)
+            cache->slots[asset_cache_probe(cache, old_slots[i].id)] = old_slots[i];
+    }
+
+    free(old_slots); old_slots = NULL;
+
+    return true;
+}
+
+static size_t asset_texture_probe(const AssetCache* cache, const unsigned int texture_id)
+{
+    size_t i = asset_hash(texture_id, cache->texture_capacity);
+
+    while ((cache->textures[i].texture_id != 0) && (cache->textures[i].texture_id != texture_id))
+        i = (i + 1) & (cache->texture_capacity - 1);
+
+    return i;
+}
+
+// indexes the resident texture of 'entry' by its GL id, at most half full like the entry table
+static bool asset_texture_put(AssetCache* cache, AssetEntry* entry)
+{
+    if (entry->texture.id == 0)
+        return true;
+
+    if ((cache->texture_count + 1) * 2 > cache->texture_capacity) {
+        const size_t capacity = (cache->texture_capacity) ? (cache->texture_capacity * 2) : ASSET_CACHE_MIN_SLOTS;
+
+        AssetTextureSlot* textures = calloc(capacity, sizeof(AssetTextureSlot));
+        if (!textures) {
+            fprintf(stderr, "asset_texture_put: calloc returned null\n");
+            return false;
+        }
+
+        AssetTextureSlot* old_textures = cache->textures;
+        const size_t old_capacity = cache->texture_capacity;
+
+        cache->textures = textures;
+        cache->texture_capacity = capacity;
+
+        for (size_t i = 0; i < old_capacity; i++) {
+            if (old_textures[i].texture_id != 0)
+                cache->textures[asset_texture_probe(cache, old_textures[i].texture_id)] = old_textures[i];
+        }
+
+        free(old_textures); old_textures = NULL;
+    }
+
+    const size_t i = asset_texture_probe(cache, entry->texture.id);
+
+    cache->texture_count += (cache->textures[i].texture_id == 0);
+    cache->textures[i] = (AssetTextureSlot) {
+        .texture_id = entry->texture.id,
+        .entry = entry,
+    };
+
+    return true;
+}
+
+// drops a texture id about to be unloaded, later slots of its run move back so probes never stop at the hole
+static void asset_texture_remove(AssetCache* cache, const unsigned int texture_id)
+{
+    if ((cache->texture_capacity == 0) || (texture_id == 0))
+        return;
+
+    const size_t mask = cache->texture_capacity - 1;
+    size_t hole = asset_texture_probe(cache, texture_id);
+
+    if (cache->textures[hole].texture_id == 0)
+        return;
+
+    cache->textures[hole] = (AssetTextureSlot){0};
+    cache->texture_count--;
+
+    for (size_t i = (hole + 1) & mask; cache->textures[i].texture_id != 0; i = (i + 1) & mask) {
+        const size_t home = asset_hash(cache->textures[i].texture_id, cache->texture_capacity);
+
+        // a slot may only move back when the hole lies between its home and where it sits
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            cache->textures[hole] = cache->textures[i];
+            cache->textures[i] = (AssetTextureSlot){0};
+            hole = i;
+        }
+    }
+}
+
+// copies 'path' into the arena, the bytes stay put until the cache is freed
+static char* asset_cache_intern(AssetCache* cache, const char* path)
+{
+    const size_t size = strlen(path) + 1;
+    AssetPathBlock* block = cache->paths;
+
+    if (!block || ((block->capacity - block->used) < size)) {
+        const size_t capacity = (size > ASSET_PATH_BLOCK_SIZE) ? size : ASSET_PATH_BLOCK_SIZE;
+
+        block = malloc(sizeof(AssetPathBlock) + capacity);
+        if (!block) {
+            fprintf(stderr, "asset_cache_intern: malloc returned null\n");
+            return NULL;
+        }
+
+        block->used = 0;
+        block->capacity = capacity;
+
+        // a partly used block stays in front unless the new one is larger, short paths keep filling it
+        if (cache->paths && (capacity > ASSET_PATH_BLOCK_SIZE)) {
+            block->next = cache->paths->next;
+            cache->paths->next = block;
+        }
+        else {
+            block->next = cache->paths;
+            cache->paths = block;
+        }
+    }
+
+    char* interned = block->data + block->used;
+    memcpy(interned, path, size);
+    block->used += size;
+
+    return interned;
+}
+
+static void asset_lru_unlink(AssetCache* cache, AssetEntry* entry)
+{
+    if (!entry->prev && !entry->next && (cache->lru_head != entry))
+        return;
+
+    if (entry->prev)
+        entry->prev->next = entry->next;
+    else
+        cache->lru_head = entry->next;
+
+    if (entry->next)
+        entry->next->prev = entry->prev;
+    else
+        cache->lru_tail = entry->prev;
+
+    entry->prev = entry->next = NULL;
+}
+
+// marks 'entry' used this frame, a resident entry nothing holds moves to the front of the eviction order
+static void asset_lru_touch(AssetCache* cache, AssetEntry* entry)
+{
+    entry->last_used = cache->frame;
+
+    if ((entry->texture.id == 0) || (entry->refs > 0) || (cache->lru_head == entry))
         return;
 
-    HASH_DEL((*cache), entry);
+    asset_lru_unlink(cache, entry);
+
+    entry->next = cache->lru_head;
+
+    if (cache->lru_head)
+        cache->lru_head->prev = entry;
+
+    cache->lru_head = entry;
+
+    if (!cache->lru_tail)
+        cache->lru_tail = entry;
+}
+
+// takes ownership of 'entry' on success, a different path hashing to an id already in the table is refused
+bool asset_cache_add(AssetCache* cache, AssetEntry* entry)
+{
+    // a pending entry has no texture yet, it still holds the path a map saved meanwhile refers to
+    if (!cache || !(asset_entry_is_ready(entry) || (entry && entry->uploading && (entry->id != 0) && valid_string(entry->path))))
+        return false;
+
+    if (cache->capacity > 0) {
+        const AssetEntry* existing = cache->slots[asset_cache_probe(cache, entry->id)].entry;
+
+        if (existing) {
+            if (strcmp(existing->path, entry->path) != 0)
+                fprintf(stderr, "asset_cache_add: \"%s\" and \"%s\" share the id %lu\n", existing->path, entry->path, entry->id);
+
+            return false;
+        }
+    }
+
+    if (!asset_cache_grow(cache))
+        return false;
+
+    char* path = asset_cache_intern(cache, entry->path);
+    if (!path)
+        return false;
+
+    free(entry->path);
+    entry->path = path;
+
+    cache->slots[asset_cache_probe(cache, entry->id)] = (AssetSlot) {
+        .id = entry->id,
+        .entry = entry,
+    };
+
+    cache->count++;
+
+    if (!asset_texture_put(cache, entry))
+        fprintf(stderr, "asset_cache_add: renderer holds on \"%s\" will not be found\n", entry->path);
+
+    entry->prev = entry->next = NULL;
+    asset_lru_touch(cache, entry);
+    cache->texture_bytes += entry->bytes;
 
-    asset_entry_free(entry);
+    return true;
 }
 
 void asset_cache_free(AssetCache* cache)
@@ -78,17 +403,239 @@ void asset_cache_free(AssetCache* cache)
     if (!cache)
         return;
 
-    AssetEntry* current, *tmp;
+    for (size_t i = 0; i < cache->capacity; i++) {
+        AssetEntry* entry = cache->slots[i].entry;
+        if (!entry)
+            continue;
 
-    HASH_ITER(hh, (*cache), current, tmp) 
-        asset_cache_remove(cache, current);
+        if (IsTextureReady(entry->texture))
+            cache->texture_bytes -= entry->bytes;
+
+        entry->path = NULL;
+        asset_entry_free(entry);
+    }
+
+    if (cache->slots) {
+        free(cache->slots); cache->slots = NULL;
+    }
+
+    if (cache->textures) {
+        free(cache->textures); cache->textures = NULL;
+    }
+
+    cache->capacity = cache->count = 0;
+    cache->texture_capacity = cache->texture_count = 0;
+    cache->lru_head = cache->lru_tail = NULL;
+
+    while (cache->paths) {
+        AssetPathBlock* next = cache->paths->next;
+        free(cache->paths);
+        cache->paths = next;
+    }
 }
 
 AssetEntry* asset_cache_find(AssetCache* cache, const unsigned long int id)
 {
-    AssetEntry* found = NULL;
+    if (!cache || (cache->capacity == 0) || (id == 0))
+        return NULL;
+
+    return cache->slots[asset_cache_probe(cache, id)].entry;
+}
+
+// the entry loaded from 'path', not one whose different path merely hashes the same
+AssetEntry* asset_cache_find_path(AssetCache* cache, const char* path)
+{
+    AssetEntry* found = asset_cache_find(cache, hash_string(path));
+
+    return (found && (strcmp(found->path, path) == 0)) ? found : NULL;
+}
+
+// the entry currently uploaded as 'texture_id', renderer holds ask on every mesh build and release,
+// atlas pages among them, which miss after a probe or two
+AssetEntry* asset_cache_find_texture(AssetCache* cache, const unsigned int texture_id)
+{
+    if (!cache || (cache->texture_capacity == 0) || (texture_id == 0))
+        return NULL;
+
+    return cache->textures[asset_texture_probe(cache, texture_id)].entry;
+}
+
+// the texture to draw 'entry' with this frame, loaded again from its path when it was evicted
+const Texture* asset_cache_use(AssetCache* cache, AssetEntry* entry)
+{
+    if (!cache || !entry)
+        return NULL;
+
+    if (entry->texture.id != 0) {
+        asset_lru_touch(cache, entry);
+        cache->stats.hits++;
+        return &entry->texture;
+    }
+
+    entry->last_used = cache->frame;
+
+    if (entry->missing || entry->uploading)
+        return NULL;
+
+    cache->stats.misses++;
+
+    const Texture texture = LoadTexture(entry->path);
+    if (!IsTextureReady(texture)) {
+        fprintf(stderr, "asset_cache_use: failed to reload \"%s\"\n", entry->path);
+        entry->missing = true;
+        return NULL;
+    }
+
+    entry->texture = texture;
+    entry->bytes = asset_texture_bytes(texture);
+    cache->texture_bytes += entry->bytes;
+    cache->stats.reloads++;
+
+    if (!asset_texture_put(cache, entry))
+        fprintf(stderr, "asset_cache_use: renderer holds on \"%s\" will not be found\n", entry->path);
+
+    asset_lru_touch(cache, entry);
+
+    return &entry->texture;
+}
+
+// readies 'entry' for width x height pixels uploaded in slices, a pending entry gets its texture storage here,
+// a resident one keeps its texture id so everything drawing with it stays valid, an evicted one is loaded from the new file on its next use
+bool asset_cache_begin_upload(AssetCache* cache, AssetEntry* entry, const int width, const int height)
+{
+    if (!cache || !entry || (width <= 0) || (height <= 0))
+        return false;
 
-    HASH_FIND_INT((*cache), &id, found);
+    if (entry->uploading && (entry->texture.id == 0)) {
+        const Texture texture = {
+            .id = rlLoadTexture(NULL, width, height, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, 1),
+            .width = width,
+            .height = height,
+            .mipmaps = 1,
+            .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8,
+        };
 
-    return found;
+        if (!IsTextureReady(texture)) {
+            fprintf(stderr, "asset_cache_begin_upload: failed to create the texture of \"%s\"\n", entry->path);
+            return false;
+        }
+
+        entry->texture = texture;
+        entry->bytes = asset_texture_bytes(texture);
+        cache->texture_bytes += entry->bytes;
+
+        if (!asset_texture_put(cache, entry))
+            fprintf(stderr, "asset_cache_begin_upload: renderer holds on \"%s\" will not be found\n", entry->path);
+    }
+
+    entry->missing = false;
+
+    if (entry->texture.id == 0)
+        return true;
+
+    if ((width != entry->texture.width) || (height != entry->texture.height))
+        return false;
+
+    // not evicted halfway through
+    asset_cache_retain(cache, entry);
+
+    return true;
+}
+
+// uploads 'rows' rows of image starting at 'first_row', nothing to do for an evicted texture
+bool asset_cache_upload_rows(AssetCache* cache, AssetEntry* entry, const Image* image, const int first_row, const int rows)
+{
+    if (!cache || !entry || !image || !IsImageReady(*image) || (first_row < 0) || (rows <= 0) || ((first_row + rows) > image->height))
+        return false;
+
+    if (entry->texture.id == 0)
+        return true;
+
+    const Rectangle rect = { 0, first_row, image->width, rows };
+
+    if (image->format == entry->texture.format) {
+        UpdateTextureRec(entry->texture, rect, (const unsigned char*)image->data + GetPixelDataSize(image->width, first_row, image->format));
+        return true;
+    }
+
+    // a texture loaded again after an eviction keeps the format of its file
+    Image converted = ImageFromImage(*image, rect);
+    ImageFormat(&converted, entry->texture.format);
+
+    const bool uploaded = IsImageReady(converted) && (converted.format == entry->texture.format);
+    if (uploaded)
+        UpdateTextureRec(entry->texture, rect, converted.data);
+
+    UnloadImage(converted);
+
+    return uploaded;
+}
+
+// the texture is complete, or the upload was abandoned, either way the entry can be evicted again
+void asset_cache_end_upload(AssetCache* cache, AssetEntry* entry)
+{
+    if (!cache || !entry)
+        return;
+
+    entry->uploading = false;
+
+    if (entry->texture.id != 0)
+        asset_cache_release(cache, entry);
+}
+
+// a held entry stays resident until every holder released it, whatever the budget
+void asset_cache_retain(AssetCache* cache, AssetEntry* entry)
+{
+    if (!cache || !entry)
+        return;
+
+    // a held texture is out of the eviction order until its last holder lets go
+    if (entry->refs++ == 0)
+        asset_lru_unlink(cache, entry);
+}
+
+void asset_cache_release(AssetCache* cache, AssetEntry* entry)
+{
+    if (!cache || !entry || (entry->refs == 0))
+        return;
+
+    entry->refs--;
+    asset_lru_touch(cache, entry);
+}
+
+static void asset_cache_evict(AssetCache* cache, AssetEntry* entry)
+{
+    asset_lru_unlink(cache, entry);
+
+    asset_texture_remove(cache, entry->texture.id);
+
+    UnloadTexture(entry->texture);
+    entry->texture = (Texture){0};
+
+    cache->texture_bytes -= entry->bytes;
+    cache->stats.evictions++;
+}
+
+// call once per frame after drawing, evicts the least recently used textures nothing holds until the budget is met
+void asset_cache_trim(AssetCache* cache)
+{
+    if (!cache)
+        return;
+
+    // the tail is the least recently used texture nothing holds, one used this frame means every other one was too
+    while ((cache->budget > 0) && (cache->texture_bytes > cache->budget)) {
+        AssetEntry* oldest = cache->lru_tail;
+
+        if (!oldest || (oldest->last_used == cache->frame))
+            break;
+
+        asset_cache_evict(cache, oldest);
+    }
+
+    cache->frame++;
+}
+
+AssetCacheStats asset_cache_get_stats(const AssetCache* cache)
+{
+    return (cache) ? cache->stats : (AssetCacheStats){0};
 }
\ No newline at end of file
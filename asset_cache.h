@@ -1,28 +1,98 @@
 #ifndef TEXTURE_CACHE_H
 #define TEXTURE_CACHE_H
 
+#include <stdbool.h>
+#include <stddef.h>
+
 #include "raylib.h"
-#include "uthash.h"
 
-typedef struct
+#define ASSET_CACHE_MIN_SLOTS 16
+#define ASSET_PATH_BLOCK_SIZE 4096 // bytes of interned paths per arena block, longer paths get a block of their own
+
+typedef struct AssetEntry
 {
-    UT_hash_handle hh;    // for hashing operations, https://troydhanson.github.io/uthash/ for more information
-    Texture texture;      // image data stored in GPU
-    char* path;           // asset path, allocated
+    Texture texture;      // image data stored in GPU, zeroed while the entry is evicted
+    char* path;           // asset path, allocated, interned in the cache's path arena once added
     unsigned long int id; // the hashcode (generated from the path of the texture)
+    unsigned int refs;    // holders drawing the texture without asking the cache first, a referenced texture is never evicted
+    size_t bytes;         // GPU memory the texture takes while resident
+    unsigned long int last_used; // frame the texture was last asked for
+    bool missing;         // reloading failed, the path is not read again
+    bool uploading;       // added before its texture was complete, never loaded from its path meanwhile
+    struct AssetEntry* prev; // LRU links, most recently used first, only resident entries nothing holds are linked
+    struct AssetEntry* next;
 } AssetEntry;
 
-typedef AssetEntry* AssetCache;
+typedef struct
+{
+    size_t hits;      // textures asked for while resident
+    size_t misses;    // textures asked for after being evicted
+    size_t evictions;
+    size_t reloads;   // misses the path could be loaded again for
+} AssetCacheStats;
+
+// the table keeps ids next to the entry pointers, a probe only touches the entry once the full 64-bit id matched
+typedef struct
+{
+    unsigned long int id; // 0 marks a free slot, hash_string never hands it out
+    AssetEntry* entry;
+} AssetSlot;
+
+// resident textures by GL id, what the renderer's texture holds are resolved with
+typedef struct
+{
+    unsigned int texture_id; // 0 marks a free slot, GL never hands it out
+    AssetEntry* entry;
+} AssetTextureSlot;
+
+typedef struct AssetPathBlock
+{
+    struct AssetPathBlock* next;
+    size_t used;
+    size_t capacity;
+    char data[];
+} AssetPathBlock;
+
+typedef struct
+{
+    AssetSlot* slots;        // open addressing with linear probing, capacity is a power of two, allocated
+    size_t capacity;
+    size_t count;
+    AssetTextureSlot* textures; // open addressing like 'slots', one per resident texture, allocated
+    size_t texture_capacity;
+    size_t texture_count;
+    AssetPathBlock* paths;   // interned paths of every entry added, newest block first
+    size_t texture_bytes;    // held by every resident texture
+    size_t budget;           // textures past it are evicted at the end of the frame, 0 keeps everything resident
+    AssetEntry* lru_head;    // most recently used
+    AssetEntry* lru_tail;    // next to be evicted
+    unsigned long int frame;
+    AssetCacheStats stats;
+} AssetCache;
 
 // entry operations
 AssetEntry* asset_entry_init(const char* asset_path);
+AssetEntry* asset_entry_init_from_image(const char* asset_path, const Image image);
+AssetEntry* asset_entry_init_pending(const char* asset_path);
 void asset_entry_free(AssetEntry* entry);
 bool asset_entry_is_ready(const AssetEntry* entry);
 
 // cache operations
-void asset_cache_add(AssetCache* cache, AssetEntry* entry);
-void asset_cache_remove(AssetCache* cache, AssetEntry* entry);
+AssetCache asset_cache_init(const size_t budget);
+bool asset_cache_add(AssetCache* cache, AssetEntry* entry);
 void asset_cache_free(AssetCache* cache);
 AssetEntry* asset_cache_find(AssetCache* cache, const unsigned long int id);
+AssetEntry* asset_cache_find_path(AssetCache* cache, const char* path);
+AssetEntry* asset_cache_find_texture(AssetCache* cache, const unsigned int texture_id);
+
+// residency operations
+const Texture* asset_cache_use(AssetCache* cache, AssetEntry* entry);
+bool asset_cache_begin_upload(AssetCache* cache, AssetEntry* entry, const int width, const int height);
+bool asset_cache_upload_rows(AssetCache* cache, AssetEntry* entry, const Image* image, const int first_row, const int rows);
+void asset_cache_end_upload(AssetCache* cache, AssetEntry* entry);
+void asset_cache_retain(AssetCache* cache, AssetEntry* entry);
+void asset_cache_release(AssetCache* cache, AssetEntry* entry);
+void asset_cache_trim(AssetCache* cache);
+AssetCacheStats asset_cache_get_stats(const AssetCache* cache);
 
 #endif
\ No newline at end of file
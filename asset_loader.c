@@ -0,0 +1,227 @@
+#include "asset_loader.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "utils.h"
+
+static bool asset_queue_push(AssetQueue* queue, const DecodedAsset* item)
+{
+    const size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    const size_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+
+    if ((tail - head) == ASSET_LOADER_QUEUE_SIZE)
+        return false;
+
+    queue->slots[tail & (ASSET_LOADER_QUEUE_SIZE - 1)] = (*item);
+
+    // publishes the slot contents together with the new tail
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+
+    return true;
+}
+
+static bool asset_queue_pop(AssetQueue* queue, DecodedAsset* out)
+{
+    const size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    const size_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+
+    if (head == tail)
+        return false;
+
+    (*out) = queue->slots[head & (ASSET_LOADER_QUEUE_SIZE - 1)];
+
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+
+    return true;
+}
+
+void decoded_asset_free(DecodedAsset* asset)
+{
+    if (!asset)
+        return;
+
+    if (asset->path) {
+        free(asset->path); asset->path = NULL;
+    }
+
+    if (IsImageReady(asset->image))
+        UnloadImage(asset->image);
+
+    asset->image = (Image){0};
+
+    palette_sheet_free(&asset->sheet);
+    atlas_staging_free(&asset->staging);
+
+    if (asset->rules) {
+        free(asset->rules); asset->rules = NULL;
+    }
+}
+
+static void* asset_loader_work(void* arg)
+{
+    AssetLoader* loader = (AssetLoader*) arg;
+
+    while (true) {
+        sem_wait(&loader->pending);
+
+        if (!atomic_load(&loader->running))
+            break;
+
+        DecodedAsset asset;
+        if (!asset_queue_pop(&loader->requests, &asset))
+            continue;
+
+        asset.image = LoadImage(asset.path);
+        if (IsImageReady(asset.image) && (asset.image.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8))
+            ImageFormat(&asset.image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+        // every pass over the pixels happens here, the main thread only uploads what comes out
+        if (IsImageReady(asset.image) && palette_sheet_init(&asset.sheet, asset.image.width, asset.image.height, &asset.image, asset.sprite_size)) {
+            if (!atlas_staging_init(&asset.staging, &asset.sheet, &asset.image))
+                fprintf(stderr, "asset_loader_work: failed to stage the sprites of \"%s\"\n", asset.path);
+
+            asset.rules = autotile_rules_load(asset.path, palette_sheet_cell_count(&asset.sheet));
+        }
+
+        // in_flight is capped at the queue size, so this only fails if the main thread broke that invariant
+        while (!asset_queue_push(&loader->results, &asset)) {
+            if (!atomic_load(&loader->running)) {
+                decoded_asset_free(&asset);
+                return NULL;
+            }
+
+            usleep(1000);
+        }
+    }
+
+    return NULL;
+}
+
+bool asset_loader_init(AssetLoader* loader)
+{
+    if (!loader)
+        return false;
+
+    memset(loader, 0, sizeof(AssetLoader));
+
+    atomic_init(&loader->requests.head, 0);
+    atomic_init(&loader->requests.tail, 0);
+    atomic_init(&loader->results.head, 0);
+    atomic_init(&loader->results.tail, 0);
+    atomic_init(&loader->running, true);
+
+    if (sem_init(&loader->pending, 0, 0) != 0) {
+        fprintf(stderr, "asset_loader_init: sem_init failed\n");
+        return false;
+    }
+
+    if (pthread_create(&loader->thread, NULL, asset_loader_work, loader) != 0) {
+        fprintf(stderr, "asset_loader_init: pthread_create failed\n");
+        sem_destroy(&loader->pending);
+        return false;
+    }
+
+    return true;
+}
+
+void asset_loader_free(AssetLoader* loader)
+{
+    if (!loader)
+        return;
+
+    atomic_store(&loader->running, false);
+    sem_post(&loader->pending);
+    pthread_join(loader->thread, NULL);
+
+    sem_destroy(&loader->pending);
+
+    DecodedAsset asset;
+
+    while (asset_queue_pop(&loader->requests, &asset))
+        decoded_asset_free(&asset);
+
+    while (asset_queue_pop(&loader->results, &asset))
+        decoded_asset_free(&asset);
+
+    loader->in_flight = loader->imports_in_flight = 0;
+}
+
+// a reload decodes a sheet already in the palette again, an import brings in a new one
+bool asset_loader_request(AssetLoader* loader, const char* path, const float sprite_size, const bool reload)
+{
+    if (!loader || !valid_string(path))
+        return false;
+
+    // every in flight item must fit the results queue too, the worker then never waits on the main thread
+    if (loader->in_flight >= ASSET_LOADER_QUEUE_SIZE) {
+        fprintf(stderr, "asset_loader_request: too many imports pending\n");
+        return false;
+    }
+
+    DecodedAsset request = {
+        .path = strdup(path),
+        .sprite_size = sprite_size,
+        .reload = reload,
+        .image = (Image){0},
+        .sheet = (PaletteSheet){0},
+        .staging = (AtlasStaging){0},
+        .rules = NULL,
+    };
+
+    if (!request.path) {
+        fprintf(stderr, "asset_loader_request: strdup returned null\n");
+        return false;
+    }
+
+    if (!asset_queue_push(&loader->requests, &request)) {
+        fprintf(stderr, "asset_loader_request: too many imports pending\n");
+        free(request.path); request.path = NULL;
+        return false;
+    }
+
+    loader->pending_ids[loader->in_flight] = hash_string(path);
+    loader->pending_reloads[loader->in_flight++] = reload;
+    loader->imports_in_flight += !reload;
+
+    sem_post(&loader->pending);
+
+    return true;
+}
+
+// hands over the next decoded sheet, the caller owns everything it holds afterwards, see decoded_asset_free
+bool asset_loader_poll(AssetLoader* loader, DecodedAsset* out)
+{
+    if (!loader || !out || !asset_queue_pop(&loader->results, out))
+        return false;
+
+    const unsigned long int id = hash_string(out->path);
+
+    for (size_t i = 0; i < loader->in_flight; i++) {
+        if (loader->pending_ids[i] == id) {
+            loader->imports_in_flight -= !loader->pending_reloads[i];
+
+            loader->in_flight--;
+            loader->pending_ids[i] = loader->pending_ids[loader->in_flight];
+            loader->pending_reloads[i] = loader->pending_reloads[loader->in_flight];
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool asset_loader_is_pending(const AssetLoader* loader, const unsigned long int id)
+{
+    if (!loader)
+        return false;
+
+    for (size_t i = 0; i < loader->in_flight; i++) {
+        if (loader->pending_ids[i] == id)
+            return true;
+    }
+
+    return false;
+}
\ No newline at end of file
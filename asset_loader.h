@@ -0,0 +1,57 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#include "raylib.h"
+#include "tile_palette.h"
+#include "sprite_atlas.h"
+#include "autotile.h"
+
+#define ASSET_LOADER_QUEUE_SIZE 256 // must be a power of two, a map being opened queues every sheet it uses at once
+
+// everything a sheet needs that only touches memory, prepared on the loader thread so the main thread is left with the uploads
+typedef struct
+{
+    char* path;            // allocated, ownership moves with the item
+    float sprite_size;     // cell size the sheet is split with
+    bool reload;           // decoded again after its file changed, not a new sheet
+    Image image;           // R8G8B8A8 once decoded, empty if decoding failed
+    PaletteSheet sheet;    // the image's cells classified and averaged, no asset id or texture yet
+    AtlasStaging staging;  // the listed sprites laid out for the atlas
+    AutotileRules* rules;  // the rules file next to the sheet, null when it has none
+} DecodedAsset;
+
+// single producer, single consumer ring, safe without locks as long as each side stays on its own thread
+typedef struct
+{
+    DecodedAsset slots[ASSET_LOADER_QUEUE_SIZE];
+    atomic_size_t head; // next slot to pop, only written by the consumer
+    atomic_size_t tail; // next slot to push, only written by the producer
+} AssetQueue;
+
+typedef struct
+{
+    pthread_t thread;
+    sem_t pending;       // posted once per request and on shutdown
+    atomic_bool running;
+    AssetQueue requests; // main thread -> worker, only 'path', 'sprite_size' and 'reload' are set
+    AssetQueue results;  // worker -> main thread
+    size_t in_flight;    // requested but not yet polled, main thread only, never above ASSET_LOADER_QUEUE_SIZE
+    size_t imports_in_flight; // the in flight requests for sheets not in the palette yet, reloads are not counted
+    unsigned long int pending_ids[ASSET_LOADER_QUEUE_SIZE]; // hash of every in flight path, main thread only
+    bool pending_reloads[ASSET_LOADER_QUEUE_SIZE];          // whether each in flight path is a reload, parallel to pending_ids
+} AssetLoader;
+
+void decoded_asset_free(DecodedAsset* asset);
+
+bool asset_loader_init(AssetLoader* loader);
+void asset_loader_free(AssetLoader* loader);
+bool asset_loader_request(AssetLoader* loader, const char* path, const float sprite_size, const bool reload);
+bool asset_loader_poll(AssetLoader* loader, DecodedAsset* out);
+bool asset_loader_is_pending(const AssetLoader* loader, const unsigned long int id);
+
+#endif
\ No newline at end of file
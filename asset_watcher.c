@@ -0,0 +1,203 @@
+#include "asset_watcher.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#include "utils.h"
+
+#define ASSET_WATCHER_EVENTS (IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE)
+
+AssetWatcher asset_watcher_init()
+{
+    AssetWatcher watcher = {
+        .fd = -1,
+        .dirs = watched_directory_vector_init(),
+        .files = watched_file_vector_init(),
+    };
+
+#ifdef __linux__
+    watcher.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watcher.fd < 0)
+        fprintf(stderr, "asset_watcher_init: inotify_init1 failed, sheets will not reload\n");
+#endif
+
+    return watcher;
+}
+
+void asset_watcher_free(AssetWatcher* watcher)
+{
+    if (!watcher)
+        return;
+
+    if (watcher->fd >= 0) {
+        close(watcher->fd);
+        watcher->fd = -1;
+    }
+
+    for (size_t i = 0; i < watcher->dirs.count; i++)
+        free(watcher->dirs.items[i].dir);
+
+    for (size_t i = 0; i < watcher->files.count; i++)
+        free(watcher->files.items[i].name);
+
+    watched_directory_vector_free(&watcher->dirs);
+    watched_file_vector_free(&watcher->files);
+}
+
+// the watch of the directory, added on its first file
+static int asset_watcher_directory(AssetWatcher* watcher, const char* dir)
+{
+    for (size_t i = 0; i < watcher->dirs.count; i++) {
+        if (strcmp(watcher->dirs.items[i].dir, dir) == 0)
+            return watcher->dirs.items[i].wd;
+    }
+
+#ifdef __linux__
+    if (!watched_directory_vector_reserve(&watcher->dirs, watcher->dirs.count + 1)) {
+        fprintf(stderr, "asset_watcher_directory: realloc returned null\n");
+        return -1;
+    }
+
+    char* copy = strdup(dir);
+    if (!copy) {
+        fprintf(stderr, "asset_watcher_directory: strdup returned null\n");
+        return -1;
+    }
+
+    const int wd = inotify_add_watch(watcher->fd, dir, ASSET_WATCHER_EVENTS);
+    if (wd < 0) {
+        fprintf(stderr, "asset_watcher_directory: failed to watch \"%s\"\n", dir);
+        free(copy); copy = NULL;
+        return -1;
+    }
+
+    watched_directory_vector_push(&watcher->dirs, (WatchedDirectory) {
+        .wd = wd,
+        .dir = copy,
+    });
+
+    return wd;
+#else
+    return -1;
+#endif
+}
+
+// reports later changes of the file at 'path' under hash_string(path)
+bool asset_watcher_add(AssetWatcher* watcher, const char* path)
+{
+    if (!watcher || (watcher->fd < 0) || !valid_string(path))
+        return false;
+
+    const unsigned long int id = hash_string(path);
+
+    for (size_t i = 0; i < watcher->files.count; i++) {
+        if (watcher->files.items[i].id == id)
+            return true;
+    }
+
+    // split the path at its last separator, a bare file name lives in the working directory
+    const char* slash = strrchr(path, '/');
+    const char* name = (slash) ? (slash + 1) : path;
+
+    char dir[1024];
+    const size_t dir_len = (slash) ? (size_t)(slash - path) : 0;
+
+    if (dir_len >= sizeof(dir) || (name[0] == '\0'))
+        return false;
+
+    if (slash && (dir_len == 0))
+        strcpy(dir, "/");
+    else if (slash) {
+        memcpy(dir, path, dir_len);
+        dir[dir_len] = '\0';
+    }
+    else
+        strcpy(dir, ".");
+
+    const int wd = asset_watcher_directory(watcher, dir);
+    if (wd < 0)
+        return false;
+
+    if (!watched_file_vector_reserve(&watcher->files, watcher->files.count + 1)) {
+        fprintf(stderr, "asset_watcher_add: realloc returned null\n");
+        return false;
+    }
+
+    char* name_copy = strdup(name);
+    if (!name_copy) {
+        fprintf(stderr, "asset_watcher_add: strdup returned null\n");
+        return false;
+    }
+
+    watched_file_vector_push(&watcher->files, (WatchedFile) {
+        .wd = wd,
+        .name = name_copy,
+        .id = id,
+        .dirty = false,
+        .changed_at = 0,
+    });
+
+    return true;
+}
+
+// drains every pending event without blocking, each only stamps its file so a burst of writes collapses into one change
+static void asset_watcher_read(AssetWatcher* watcher, const double time)
+{
+#ifdef __linux__
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+    for (;;) {
+        const ssize_t length = read(watcher->fd, buffer, sizeof(buffer));
+        if (length <= 0)
+            return;
+
+        for (char* p = buffer; p < (buffer + length); ) {
+            const struct inotify_event* event = (const struct inotify_event*) p;
+            p += sizeof(struct inotify_event) + event->len;
+
+            if (event->len == 0)
+                continue;
+
+            for (size_t i = 0; i < watcher->files.count; i++) {
+                WatchedFile* file = &watcher->files.items[i];
+
+                if ((file->wd == event->wd) && (strcmp(file->name, event->name) == 0)) {
+                    file->dirty = true;
+                    file->changed_at = time;
+                    break;
+                }
+            }
+        }
+    }
+#else
+    (void) watcher;
+    (void) time;
+#endif
+}
+
+// call once per frame, returns true with the id of a file that changed and has been quiet since, until none is left
+bool asset_watcher_poll(AssetWatcher* watcher, const double time, unsigned long int* id)
+{
+    if (!watcher || (watcher->fd < 0) || !id)
+        return false;
+
+    asset_watcher_read(watcher, time);
+
+    for (size_t i = 0; i < watcher->files.count; i++) {
+        WatchedFile* file = &watcher->files.items[i];
+
+        if (file->dirty && ((time - file->changed_at) >= ASSET_WATCHER_SETTLE_SECONDS)) {
+            file->dirty = false;
+            (*id) = file->id;
+            return true;
+        }
+    }
+
+    return false;
+}
\ No newline at end of file
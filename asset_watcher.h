@@ -0,0 +1,42 @@
+#ifndef ASSET_WATCHER_H
+#define ASSET_WATCHER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "containers.h"
+
+#define ASSET_WATCHER_SETTLE_SECONDS 0.3 // quiet time after the last event before a change is reported, one save is often several writes
+
+// a directory holding watched files, inotify watches directories so files replaced through a rename are still seen
+typedef struct
+{
+    int wd;    // inotify watch descriptor
+    char* dir; // allocated
+} WatchedDirectory;
+
+typedef struct
+{
+    int wd;               // watch of the directory the file lives in
+    char* name;           // file name inside that directory, allocated
+    unsigned long int id; // hash_string of the path the file was added with
+    bool dirty;           // changed since it was last reported
+    double changed_at;    // time of the latest event
+} WatchedFile;
+
+VECTOR_DEFINE(WatchedDirectoryVector, watched_directory_vector, WatchedDirectory)
+VECTOR_DEFINE(WatchedFileVector, watched_file_vector, WatchedFile)
+
+typedef struct
+{
+    int fd;                  // non blocking inotify instance, -1 when unavailable
+    WatchedDirectoryVector dirs;
+    WatchedFileVector files;
+} AssetWatcher;
+
+AssetWatcher asset_watcher_init();
+void asset_watcher_free(AssetWatcher* watcher);
+bool asset_watcher_add(AssetWatcher* watcher, const char* path);
+bool asset_watcher_poll(AssetWatcher* watcher, const double time, unsigned long int* id);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,443 @@
+#include "autotile.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils.h"
+
+#define AUTOTILE_PAD (TILE_CHUNK_SIZE + 2) // a chunk plus the ring of neighbours its edge cells look at
+
+static const char* autotile_type_names[TILE_TYPE_N_ITEMS] = { "wall", "floor", "door", "buff", "interactable" };
+
+AutotileSet autotile_set_init()
+{
+    return (AutotileSet) {
+        .rules = NULL,
+        .count = 0,
+    };
+}
+
+void autotile_set_free(AutotileSet* set)
+{
+    if (!set)
+        return;
+
+    for (size_t i = 0; i < set->count; i++) {
+        if (set->rules[i]) {
+            free(set->rules[i]); set->rules[i] = NULL;
+        }
+    }
+
+    if (set->rules) {
+        free(set->rules); set->rules = NULL;
+    }
+
+    set->count = 0;
+}
+
+// with eight neighbours a corner only counts when both edges beside it are set, 256 masks fold into 47
+static unsigned char autotile_reduce(const unsigned char mask, const int neighbours)
+{
+    unsigned char reduced = mask & (AUTOTILE_N | AUTOTILE_E | AUTOTILE_S | AUTOTILE_W);
+
+    if (neighbours == 4)
+        return reduced;
+
+    if ((mask & AUTOTILE_NE) && (mask & AUTOTILE_N) && (mask & AUTOTILE_E))
+        reduced |= AUTOTILE_NE;
+    if ((mask & AUTOTILE_SE) && (mask & AUTOTILE_S) && (mask & AUTOTILE_E))
+        reduced |= AUTOTILE_SE;
+    if ((mask & AUTOTILE_SW) && (mask & AUTOTILE_S) && (mask & AUTOTILE_W))
+        reduced |= AUTOTILE_SW;
+    if ((mask & AUTOTILE_NW) && (mask & AUTOTILE_N) && (mask & AUTOTILE_W))
+        reduced |= AUTOTILE_NW;
+
+    return reduced;
+}
+
+static bool autotile_parse_line(char* line, AutotileRules* rules, unsigned short* listed, unsigned short* fallback, const int cell_count)
+{
+    char* comment = strchr(line, '#');
+    if (comment)
+        (*comment) = '\0';
+
+    char key[32], value[32];
+    const int fields = sscanf(line, "%31s %31s", key, value);
+
+    if (fields <= 0)
+        return true;
+
+    if (fields != 2)
+        return false;
+
+    if (strcmp(key, "neighbours") == 0) {
+        rules->neighbours = atoi(value);
+        return (rules->neighbours == 4) || (rules->neighbours == 8);
+    }
+
+    if (strcmp(key, "type") == 0) {
+        for (int t = 0; t < TILE_TYPE_N_ITEMS; t++) {
+            if (strcmp(value, autotile_type_names[t]) == 0) {
+                rules->type = t;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    char* end = NULL;
+    const long cell = strtol(value, &end, 0);
+    if ((*end != '\0') || (cell < 0) || (cell >= cell_count))
+        return false;
+
+    if (strcmp(key, "default") == 0) {
+        (*fallback) = cell;
+        return true;
+    }
+
+    // masks may be written in decimal or hex, the reduction happens once every line is read
+    const long mask = strtol(key, &end, 0);
+    if ((*end != '\0') || (mask < 0) || (mask >= AUTOTILE_MASKS))
+        return false;
+
+    listed[mask] = cell;
+
+    return true;
+}
+
+// reads the rules file beside the sheet at 'path', false when there is none or it is malformed
+// reads the rules next to the sheet at 'path', null when it has none or they do not parse
+// only touches memory and the rules file, so sheets being decoded off the main thread read theirs there too
+AutotileRules* autotile_rules_load(const char* path, const int cell_count)
+{
+    if (!valid_string(path))
+        return NULL;
+
+    char rules_path[4096];
+    const char* extension = strrchr(path, '.');
+    const int stem = (extension && !strchr(extension, '/')) ? (int)(extension - path) : (int)strlen(path);
+
+    if (snprintf(rules_path, sizeof(rules_path), "%.*s.rules", stem, path) >= (int)sizeof(rules_path))
+        return NULL;
+
+    // most sheets are painted as is
+    if (!file_exists(rules_path))
+        return NULL;
+
+    MappedFile content;
+    if (!mapped_file_open(&content, rules_path, FILE_ACCESS_SEQUENTIAL))
+        return NULL;
+
+    AutotileRules* rules = calloc(1, sizeof(AutotileRules));
+    if (!rules) {
+        fprintf(stderr, "autotile_rules_load: calloc returned null\n");
+        mapped_file_close(&content);
+        return NULL;
+    }
+
+    rules->neighbours = 8;
+    rules->type = TILE_TYPE_WALL;
+
+    unsigned short listed[AUTOTILE_MASKS];
+    unsigned short fallback = AUTOTILE_KEEP;
+
+    for (int m = 0; m < AUTOTILE_MASKS; m++)
+        listed[m] = AUTOTILE_KEEP;
+
+    TextTokenizer lines = text_tokenizer_init((const char*) content.data, content.size, "\n", '\0');
+    StringView line;
+    int line_number = 0;
+    bool valid = (content.size > 0);
+
+    while (valid && text_tokenizer_next(&lines, &line)) {
+        line_number++;
+
+        // comments may be longer than any rule, only what precedes them is copied out for parsing
+        const char* comment = memchr(line.data, '#', line.length);
+        const size_t length = (comment) ? (size_t)(comment - line.data) : line.length;
+
+        char text[256];
+        valid = (length < sizeof(text));
+
+        if (valid) {
+            memcpy(text, line.data, length);
+            text[length] = '\0';
+            valid = autotile_parse_line(text, rules, listed, &fallback, cell_count);
+        }
+
+        if (!valid)
+            fprintf(stderr, "autotile_rules_load: \"%s\" line %d is not a valid rule\n", rules_path, line_number);
+    }
+
+    mapped_file_close(&content);
+
+    if (!valid) {
+        free(rules); rules = NULL;
+        return NULL;
+    }
+
+    // a rule written for an unreduced mask stands for its reduced form unless that one has a rule of its own,
+    // then every raw mask gets its entry so lookups skip the reduction
+    unsigned short reduced[AUTOTILE_MASKS];
+
+    for (int m = 0; m < AUTOTILE_MASKS; m++)
+        reduced[m] = (autotile_reduce(m, rules->neighbours) == m) ? listed[m] : AUTOTILE_KEEP;
+
+    for (int m = 0; m < AUTOTILE_MASKS; m++) {
+        const unsigned char canonical = autotile_reduce(m, rules->neighbours);
+
+        if ((listed[m] != AUTOTILE_KEEP) && (reduced[canonical] == AUTOTILE_KEEP))
+            reduced[canonical] = listed[m];
+    }
+
+    for (int m = 0; m < AUTOTILE_MASKS; m++) {
+        const unsigned short sprite = reduced[autotile_reduce(m, rules->neighbours)];
+        rules->sprites[m] = (sprite != AUTOTILE_KEEP) ? sprite : fallback;
+    }
+
+    return rules;
+}
+
+// installs the rules of the sheet in 'slot', replacing any it had, the rules are freed when they cannot be installed
+bool autotile_set_put(AutotileSet* set, const unsigned short slot, AutotileRules* rules)
+{
+    if (!set || (slot == 0) || !rules) {
+        free(rules);
+        return false;
+    }
+
+    if (slot > set->count) {
+        AutotileRules** grown = realloc(set->rules, sizeof(AutotileRules*) * slot);
+        if (!grown) {
+            fprintf(stderr, "autotile_set_put: realloc returned null\n");
+            free(rules); rules = NULL;
+            return false;
+        }
+
+        memset(grown + set->count, 0, sizeof(AutotileRules*) * (slot - set->count));
+
+        set->rules = grown;
+        set->count = slot;
+    }
+
+    if (set->rules[slot - 1])
+        free(set->rules[slot - 1]);
+
+    set->rules[slot - 1] = rules;
+
+    return true;
+}
+
+const AutotileRules* autotile_set_get(const AutotileSet* set, const unsigned short slot)
+{
+    if (!set || (slot == 0) || (slot > set->count))
+        return NULL;
+
+    return set->rules[slot - 1];
+}
+
+// neighbour mask of the cell at 'at' in a padded row major array of sheets, 'stride' apart per row
+static unsigned char autotile_mask(const unsigned short* sheets, const int at, const int stride)
+{
+    const unsigned short sheet = sheets[at];
+
+    return ((sheets[at - stride] == sheet) ? AUTOTILE_N : 0)
+        | ((sheets[at + 1] == sheet) ? AUTOTILE_E : 0)
+        | ((sheets[at + stride] == sheet) ? AUTOTILE_S : 0)
+        | ((sheets[at - 1] == sheet) ? AUTOTILE_W : 0)
+        | ((sheets[at - stride + 1] == sheet) ? AUTOTILE_NE : 0)
+        | ((sheets[at + stride + 1] == sheet) ? AUTOTILE_SE : 0)
+        | ((sheets[at + stride - 1] == sheet) ? AUTOTILE_SW : 0)
+        | ((sheets[at - stride - 1] == sheet) ? AUTOTILE_NW : 0);
+}
+
+// the value the rules give a cell with the given mask, false when it already holds it or has no rules
+static bool autotile_resolve(const AutotileSet* set, const TileCell cell, const unsigned char mask, TileCell* out)
+{
+    const AutotileRules* rules = autotile_set_get(set, cell.sheet);
+    if (!rules || (rules->sprites[mask] == AUTOTILE_KEEP))
+        return false;
+
+    if ((cell.sprite == rules->sprites[mask]) && (cell.type == rules->type))
+        return false;
+
+    (*out) = cell;
+    out->sprite = rules->sprites[mask];
+    out->type = rules->type;
+
+    return true;
+}
+
+// a single write only changes the masks of the cell and its eight neighbours, those read a 5x5 window
+size_t autotile_update_cell(const AutotileSet* set, EditHistory* history, TileGrid* grid, const int x, const int y)
+{
+    if (!set || !history || !grid || (set->count == 0))
+        return 0;
+
+    TileCell window[5 * 5];
+    unsigned short sheets[5 * 5];
+
+    for (int wy = 0; wy < 5; wy++) {
+        for (int wx = 0; wx < 5; wx++) {
+            window[(wy * 5) + wx] = tile_grid_get(grid, x + wx - 2, y + wy - 2);
+            sheets[(wy * 5) + wx] = window[(wy * 5) + wx].sheet;
+        }
+    }
+
+    size_t changed = 0;
+
+    for (int wy = 1; wy <= 3; wy++) {
+        for (int wx = 1; wx <= 3; wx++) {
+            const int at = (wy * 5) + wx;
+
+            TileCell cell;
+            if (tile_cell_is_empty(window[at]) || !autotile_resolve(set, window[at], autotile_mask(sheets, at, 5), &cell))
+                continue;
+
+            if (edit_history_set(history, grid, x + wx - 2, y + wy - 2, cell))
+                changed++;
+        }
+    }
+
+    return changed;
+}
+
+typedef struct
+{
+    const AutotileSet* set;
+    EditHistory* history;
+    TileGrid* grid;
+    int x0, y0, x1, y1;    // cells to update, inclusive
+    size_t changed;
+} AutotileArea;
+
+// copies the chunk's sheets and the ring around it out of the 3x3 chunk neighbourhood
+static void autotile_gather(const TileGrid* grid, const TileChunk* chunk, unsigned short* sheets)
+{
+    const TileChunk* around[3 * 3];
+
+    for (int ny = 0; ny < 3; ny++) {
+        for (int nx = 0; nx < 3; nx++)
+            around[(ny * 3) + nx] = ((nx == 1) && (ny == 1)) ? chunk : tile_grid_find_chunk(grid, chunk->cx + nx - 1, chunk->cy + ny - 1);
+    }
+
+    for (int py = 0; py < AUTOTILE_PAD; py++) {
+        const int ly = py - 1;
+        const int ny = (ly < 0) ? 0 : ((ly < TILE_CHUNK_SIZE) ? 1 : 2);
+
+        for (int px = 0; px < AUTOTILE_PAD; px++) {
+            const int lx = px - 1;
+            const int nx = (lx < 0) ? 0 : ((lx < TILE_CHUNK_SIZE) ? 1 : 2);
+
+            const TileChunk* source = around[(ny * 3) + nx];
+            const int local = ((ly & (TILE_CHUNK_SIZE - 1)) * TILE_CHUNK_SIZE) + (lx & (TILE_CHUNK_SIZE - 1));
+
+            sheets[(py * AUTOTILE_PAD) + px] = (source) ? source->cells[local].sheet : 0;
+        }
+    }
+}
+
+// masks depend on sheets alone and the rules never change one, so writing a chunk leaves the masks of the next ones intact
+static void autotile_update_chunk(TileChunk* chunk, void* user)
+{
+    AutotileArea* area = (AutotileArea*) user;
+
+    const int chunk_x = chunk->cx * TILE_CHUNK_SIZE, chunk_y = chunk->cy * TILE_CHUNK_SIZE;
+    const int lx0 = (area->x0 > chunk_x) ? (area->x0 - chunk_x) : 0;
+    const int ly0 = (area->y0 > chunk_y) ? (area->y0 - chunk_y) : 0;
+    const int lx1 = (area->x1 < (chunk_x + TILE_CHUNK_SIZE - 1)) ? (area->x1 - chunk_x) : (TILE_CHUNK_SIZE - 1);
+    const int ly1 = (area->y1 < (chunk_y + TILE_CHUNK_SIZE - 1)) ? (area->y1 - chunk_y) : (TILE_CHUNK_SIZE - 1);
+
+    unsigned short sheets[AUTOTILE_PAD * AUTOTILE_PAD];
+    autotile_gather(area->grid, chunk, sheets);
+
+    unsigned long long mask[TILE_CHUNK_WORDS] = {0};
+    TileCell cells[TILE_CHUNK_CELLS];
+    int count = 0;
+
+    // row major, so the values come out in mask order
+    for (int ly = ly0; ly <= ly1; ly++) {
+        for (int lx = lx0; lx <= lx1; lx++) {
+            const int local = (ly * TILE_CHUNK_SIZE) + lx;
+
+            if (tile_cell_is_empty(chunk->cells[local]))
+                continue;
+
+            const int at = ((ly + 1) * AUTOTILE_PAD) + lx + 1;
+
+            if (!autotile_resolve(area->set, chunk->cells[local], autotile_mask(sheets, at, AUTOTILE_PAD), &cells[count]))
+                continue;
+
+            mask[local / 64] |= 1ULL << (local & 63);
+            count++;
+        }
+    }
+
+    if ((count > 0) && edit_history_write(area->history, area->grid, chunk->cx, chunk->cy, mask, cells))
+        area->changed += count;
+}
+
+// re-tiles the cells of [x0, x1] x [y0, y1] that rules apply to, the area must be ordered
+static size_t autotile_update_span(const AutotileSet* set, EditHistory* history, TileGrid* grid, const int x0, const int y0, const int x1, const int y1)
+{
+    AutotileArea area = {
+        .set = set,
+        .history = history,
+        .grid = grid,
+        .x0 = x0,
+        .y0 = y0,
+        .x1 = x1,
+        .y1 = y1,
+        .changed = 0,
+    };
+
+    tile_grid_query_chunks(grid, area.x0, area.y0, area.x1, area.y1, autotile_update_chunk, &area);
+
+    return area.changed;
+}
+
+// only the one cell ring around a rectangle, for a fill with a sheet that has no rules or an erase,
+// the rectangle's own cells then have nothing to re-tile and only the ring's masks changed
+size_t autotile_update_ring(const AutotileSet* set, EditHistory* history, TileGrid* grid, const int x0, const int y0, const int x1, const int y1)
+{
+    if (!set || !history || !grid || (set->count == 0))
+        return 0;
+
+    const int left = ((x0 < x1) ? x0 : x1) - 1, right = ((x0 < x1) ? x1 : x0) + 1;
+    const int top = ((y0 < y1) ? y0 : y1) - 1, bottom = ((y0 < y1) ? y1 : y0) + 1;
+
+    const bool implicit = !history->open;
+    if (implicit)
+        edit_history_begin(history, history->closed_at, false);
+
+    // four disjoint strips, the rows take the corners
+    size_t changed = autotile_update_span(set, history, grid, left, top, right, top);
+    changed += autotile_update_span(set, history, grid, left, bottom, right, bottom);
+    changed += autotile_update_span(set, history, grid, left, top + 1, left, bottom - 1);
+    changed += autotile_update_span(set, history, grid, right, top + 1, right, bottom - 1);
+
+    if (implicit)
+        edit_history_end(history, history->closed_at);
+
+    return changed;
+}
+
+// brings every cell of the area and the ring around it in line with the rules, one masked write per chunk
+size_t autotile_update_area(const AutotileSet* set, EditHistory* history, TileGrid* grid, const int x0, const int y0, const int x1, const int y1)
+{
+    if (!set || !history || !grid || (set->count == 0))
+        return 0;
+
+    const bool implicit = !history->open;
+    if (implicit)
+        edit_history_begin(history, history->closed_at, false);
+
+    const size_t changed = autotile_update_span(set, history, grid, ((x0 < x1) ? x0 : x1) - 1, ((y0 < y1) ? y0 : y1) - 1, ((x0 < x1) ? x1 : x0) + 1, ((y0 < y1) ? y1 : y0) + 1);
+
+    if (implicit)
+        edit_history_end(history, history->closed_at);
+
+    return changed;
+}
\ No newline at end of file
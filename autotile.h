@@ -0,0 +1,58 @@
+#ifndef AUTOTILE_H
+#define AUTOTILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "tile_grid.h"
+#include "edit_history.h"
+
+#define AUTOTILE_MASKS 256     // every combination of the eight neighbour bits
+#define AUTOTILE_KEEP 0xFFFF   // no rule for the mask, the painted sprite stays
+
+// a neighbour is set when it holds a sprite of the same sheet
+typedef enum
+{
+    AUTOTILE_N  = 1 << 0,
+    AUTOTILE_E  = 1 << 1,
+    AUTOTILE_S  = 1 << 2,
+    AUTOTILE_W  = 1 << 3,
+    AUTOTILE_NE = 1 << 4,
+    AUTOTILE_SE = 1 << 5,
+    AUTOTILE_SW = 1 << 6,
+    AUTOTILE_NW = 1 << 7,
+} AutotileBit;
+
+// rules of one sheet, read from a text file next to it ("walls.png" -> "walls.rules"):
+//   neighbours 4|8      edges only, or edges plus the corners lying between two set edges
+//   type wall|floor|... TileType written along with the sprite
+//   default <cell>      sprite for masks without a rule of their own
+//   <mask> <cell>       sprite cell for a neighbour mask, # starts a comment
+typedef struct
+{
+    int neighbours;
+    unsigned char type;
+    unsigned short sprites[AUTOTILE_MASKS]; // indexed by the raw mask, reduced masks are folded in at load time
+} AutotileRules;
+
+typedef struct
+{
+    AutotileRules** rules; // indexed by palette slot - 1, null for sheets painted as is, allocated
+    size_t count;
+} AutotileSet;
+
+// rules operations
+AutotileRules* autotile_rules_load(const char* path, const int cell_count);
+
+// set operations
+AutotileSet autotile_set_init();
+void autotile_set_free(AutotileSet* set);
+bool autotile_set_put(AutotileSet* set, const unsigned short slot, AutotileRules* rules);
+const AutotileRules* autotile_set_get(const AutotileSet* set, const unsigned short slot);
+
+// update operations, all write through the history and return the number of cells changed
+size_t autotile_update_cell(const AutotileSet* set, EditHistory* history, TileGrid* grid, const int x, const int y);
+size_t autotile_update_area(const AutotileSet* set, EditHistory* history, TileGrid* grid, const int x0, const int y0, const int x1, const int y1);
+size_t autotile_update_ring(const AutotileSet* set, EditHistory* history, TileGrid* grid, const int x0, const int y0, const int x1, const int y1);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,226 @@
+#include "bench.h"
+#include "../asset_cache.h"
+#include "../uthash.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define RANDOM_LOOKUPS 10000000
+#define TRIM_ENTRIES 100000
+#define TEXTURE_SIDE 16 // 1KB textures, the budget below counts them
+
+// texture stand-ins, the cache's bookkeeping is measured without a GPU
+static unsigned int next_texture_id = 1;
+
+int GetPixelDataSize(int width, int height, int format) { (void)format; return width * height * 4; }
+bool IsImageReady(Image image) { return image.data != NULL; }
+bool IsTextureReady(Texture2D texture) { return texture.id != 0; }
+Image ImageCopy(Image image) { return image; }
+void ImageFormat(Image* image, int format) { (void)image; (void)format; }
+Image LoadImage(const char* path) { (void)path; return (Image){0}; }
+void UnloadImage(Image image) { (void)image; }
+void UnloadTexture(Texture2D texture) { (void)texture; }
+void UpdateTextureRec(Texture2D texture, Rectangle rec, const void* pixels) { (void)texture; (void)rec; (void)pixels; }
+Image ImageFromImage(Image image, Rectangle rec) { (void)rec; return image; }
+unsigned int rlLoadTexture(const void* data, int width, int height, int format, int mipmaps) { (void)data; (void)width; (void)height; (void)format; (void)mipmaps; return next_texture_id++; }
+
+Texture2D LoadTextureFromImage(Image image)
+{
+    return (Texture2D){ .id = next_texture_id++, .width = image.width, .height = image.height, .mipmaps = 1, .format = image.format };
+}
+
+Texture2D LoadTexture(const char* path)
+{
+    (void)path;
+    return (Texture2D){ .id = next_texture_id++, .width = TEXTURE_SIDE, .height = TEXTURE_SIDE, .mipmaps = 1, .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+}
+
+// the table the cache was built on before, keyed and looked up the way it was, as the baseline for find
+typedef struct
+{
+    unsigned long int id;
+    UT_hash_handle hh;
+} BaselineEntry;
+
+// RANDOM_LOOKUPS finds of random ids among the first 'count', the same sequence for both tables given the same seed
+static size_t baseline_finds(BaselineEntry* table, const unsigned long int* ids, const size_t count, unsigned long long* state)
+{
+    size_t found = 0;
+
+    for (size_t i = 0; i < RANDOM_LOOKUPS; i++) {
+        const unsigned long int id = ids[bench_random(state) % count];
+        BaselineEntry* entry = NULL;
+
+        HASH_FIND_INT(table, &id, entry);
+        found += entry != NULL;
+    }
+
+    return found;
+}
+
+static bool fill_cache(AssetCache* cache, const size_t count, unsigned long int* ids)
+{
+    unsigned char pixel = 0;
+    const Image image = { .data = &pixel, .width = TEXTURE_SIDE, .height = TEXTURE_SIDE, .mipmaps = 1, .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+
+    for (size_t i = 0; i < count; i++) {
+        char path[64];
+        snprintf(path, sizeof(path), "Assets/sheet_%zu.png", i);
+
+        AssetEntry* entry = asset_entry_init_from_image(path, image);
+        if (!entry || !asset_cache_add(cache, entry)) {
+            asset_entry_free(entry);
+            return false;
+        }
+
+        ids[i] = entry->id;
+    }
+
+    return true;
+}
+
+int main()
+{
+    unsigned long int* ids = malloc(sizeof(unsigned long int) * TRIM_ENTRIES);
+    if (!ids) {
+        fprintf(stderr, "asset_cache_bench: malloc returned null\n");
+        return 1;
+    }
+
+    unsigned long long state = 0x853C49E6748FEA9Bull;
+
+    printf("asset_cache: random finds\n");
+
+    const size_t sizes[] = { 10, 1000, 100000 };
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        AssetCache cache = asset_cache_init(0);
+
+        if (!fill_cache(&cache, sizes[s], ids)) {
+            fprintf(stderr, "asset_cache_bench: failed to fill the cache\n");
+            return 1;
+        }
+
+        BaselineEntry* baseline_entries = malloc(sizeof(BaselineEntry) * sizes[s]);
+        BaselineEntry* baseline = NULL;
+        if (!baseline_entries) {
+            fprintf(stderr, "asset_cache_bench: malloc returned null\n");
+            return 1;
+        }
+
+        for (size_t i = 0; i < sizes[s]; i++) {
+            baseline_entries[i].id = ids[i];
+            HASH_ADD_INT(baseline, id, &baseline_entries[i]);
+        }
+
+        const unsigned long long seed = state;
+        size_t found = 0;
+        double start = bench_now();
+
+        for (size_t i = 0; i < RANDOM_LOOKUPS; i++)
+            found += asset_cache_find(&cache, ids[bench_random(&state) % sizes[s]]) != NULL;
+
+        char name[64];
+        snprintf(name, sizeof(name), "find, %zu entries", sizes[s]);
+        bench_report(name, bench_now() - start, RANDOM_LOOKUPS);
+
+        state = seed;
+        start = bench_now();
+        const size_t baseline_found = baseline_finds(baseline, ids, sizes[s], &state);
+
+        snprintf(name, sizeof(name), "uthash find, %zu entries", sizes[s]);
+        bench_report(name, bench_now() - start, RANDOM_LOOKUPS);
+
+        HASH_CLEAR(hh, baseline);
+        free(baseline_entries);
+        asset_cache_free(&cache);
+
+        if ((found != RANDOM_LOOKUPS) || (baseline_found != RANDOM_LOOKUPS)) {
+            fprintf(stderr, "asset_cache_bench: %zu finds missed\n", (2 * RANDOM_LOOKUPS) - found - baseline_found);
+            return 1;
+        }
+    }
+
+    // a budget of half the textures, every entry is used once then the first trim evicts the older half
+    AssetCache cache = asset_cache_init(0);
+
+    if (!fill_cache(&cache, TRIM_ENTRIES, ids)) {
+        fprintf(stderr, "asset_cache_bench: failed to fill the cache\n");
+        return 1;
+    }
+
+    asset_cache_trim(&cache);
+    cache.budget = cache.texture_bytes / 2;
+
+    double start = bench_now();
+    asset_cache_trim(&cache);
+
+    const AssetCacheStats stats = asset_cache_get_stats(&cache);
+    printf("asset_cache: trim of %zu entries down to half\n", (size_t)TRIM_ENTRIES);
+    bench_report("evict, per texture", bench_now() - start, stats.evictions);
+
+    // frames that each bring back a few evicted textures, so each trim evicts as many again
+    const int frames = 10000;
+    size_t evictions = stats.evictions;
+
+    start = bench_now();
+
+    for (int frame = 0; frame < frames; frame++) {
+        for (int i = 0; i < 8; i++)
+            asset_cache_use(&cache, asset_cache_find(&cache, ids[bench_random(&state) % TRIM_ENTRIES]));
+
+        asset_cache_trim(&cache);
+    }
+
+    evictions = asset_cache_get_stats(&cache).evictions - evictions;
+    bench_report("use 8 and trim, per frame", bench_now() - start, frames);
+    printf("  %zu evictions, %.1f MB resident of a %.1f MB budget\n", evictions, cache.texture_bytes / (1024.0 * 1024.0), cache.budget / (1024.0 * 1024.0));
+
+    bool ok = cache.texture_bytes <= cache.budget;
+
+    // renderer holds resolve texture ids, half of them atlas pages the cache never heard of
+    unsigned int* texture_ids = malloc(sizeof(unsigned int) * TRIM_ENTRIES);
+    if (!texture_ids) {
+        fprintf(stderr, "asset_cache_bench: malloc returned null\n");
+        return 1;
+    }
+
+    size_t resident = 0;
+
+    for (size_t i = 0; i < TRIM_ENTRIES; i++) {
+        AssetEntry* entry = asset_cache_find(&cache, ids[i]);
+
+        if (entry->texture.id != 0) {
+            ok = ok && (asset_cache_find_texture(&cache, entry->texture.id) == entry);
+            texture_ids[resident++] = entry->texture.id;
+        }
+    }
+
+    // ids handed out and evicted since must not resolve any more
+    for (unsigned int id = 1; id < next_texture_id; id++) {
+        const AssetEntry* entry = asset_cache_find_texture(&cache, id);
+        ok = ok && (!entry || (entry->texture.id == id));
+    }
+
+    size_t holds = 0;
+    start = bench_now();
+
+    for (size_t i = 0; i < RANDOM_LOOKUPS; i++) {
+        const unsigned int id = (i & 1) ? texture_ids[bench_random(&state) % resident] : (next_texture_id + (unsigned int)(bench_random(&state) % 1024));
+        holds += asset_cache_find_texture(&cache, id) != NULL;
+    }
+
+    printf("asset_cache: texture finds over %zu resident textures\n", resident);
+    bench_report("find texture, half misses", bench_now() - start, RANDOM_LOOKUPS);
+
+    ok = ok && (holds == RANDOM_LOOKUPS / 2);
+
+    free(texture_ids);
+    asset_cache_free(&cache);
+    free(ids);
+
+    if (!ok)
+        fprintf(stderr, "asset_cache_bench: the cache went over budget or lost track of a texture\n");
+
+    return ok ? 0 : 1;
+}
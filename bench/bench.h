@@ -0,0 +1,34 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <time.h>
+
+// seconds on a monotonic clock
+static inline double bench_now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + (ts.tv_nsec * 1e-9);
+}
+
+// xorshift64, runs are reproducible and the generator costs next to nothing
+static inline unsigned long long bench_random(unsigned long long* state)
+{
+    unsigned long long x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+
+    return (*state = x);
+}
+
+// total time and time per operation of one measured loop
+static inline void bench_report(const char* name, const double seconds, const size_t ops)
+{
+    printf("  %-36s %10.2f ms %10.2f ns/op\n", name, seconds * 1000.0, (ops) ? (seconds * 1e9 / ops) : 0.0);
+}
+
+#endif
@@ -0,0 +1,210 @@
+#include "bench.h"
+#include "../containers.h"
+#include "../list.h"
+
+#define ELEMENTS 1000000
+#define RANDOM_READS 10000000
+#define SMALL_LISTS 100000
+#define SMALL_LIST_LENGTH 4 // fits the inline storage below, the common case for per-cell lists
+
+VECTOR_DEFINE(LongVector, long_vector, long)
+RING_DEFINE(LongRing, long_ring, long)
+SMALL_VECTOR_DEFINE(SmallLongVector, small_long_vector, long, SMALL_LIST_LENGTH)
+
+static bool bench_vector(const long* values, const long expected, unsigned long long* state)
+{
+    LongVector vector = long_vector_init();
+
+    double start = bench_now();
+    for (size_t i = 0; i < ELEMENTS; i++) {
+        if (!long_vector_push(&vector, values[i]))
+            return false;
+    }
+    bench_report("vector, push", bench_now() - start, ELEMENTS);
+
+    long sum = 0;
+    start = bench_now();
+    for (size_t i = 0; i < vector.count; i++)
+        sum += *long_vector_at(&vector, i);
+    bench_report("vector, iterate", bench_now() - start, ELEMENTS);
+
+    long picked = 0;
+    start = bench_now();
+    for (size_t i = 0; i < RANDOM_READS; i++)
+        picked += *long_vector_at(&vector, bench_random(state) % vector.count);
+    bench_report("vector, random read", bench_now() - start, RANDOM_READS);
+
+    long_vector_free(&vector);
+
+    return (sum == expected) && (picked >= 0);
+}
+
+static bool bench_list(long* values, const long expected)
+{
+    List list = list_init();
+
+    double start = bench_now();
+    for (size_t i = 0; i < ELEMENTS; i++) {
+        if (!list_push(&list, &values[i], sizeof(long), NULL, NULL))
+            return false;
+    }
+    bench_report("list, append", bench_now() - start, ELEMENTS);
+
+    long sum = 0;
+    start = bench_now();
+    for (const Node* node = list.head; node; node = node->next)
+        sum += *(const long*)node->content;
+    bench_report("list, iterate", bench_now() - start, ELEMENTS);
+
+    list_free(&list);
+
+    return sum == expected;
+}
+
+// a queue that never holds more than 'depth' elements, pushed and popped in turn like a work queue
+static bool bench_queues(long* values, const size_t depth)
+{
+    LongRing ring = long_ring_init();
+    long sum = 0;
+    long popped = 0;
+
+    double start = bench_now();
+    for (size_t i = 0; i < ELEMENTS; i++) {
+        if (!long_ring_push(&ring, values[i]))
+            return false;
+
+        if ((ring.count > depth) && long_ring_pop(&ring, &popped))
+            sum += popped;
+    }
+    while (long_ring_pop(&ring, &popped))
+        sum += popped;
+    bench_report("ring, push and pop", bench_now() - start, ELEMENTS);
+
+    long_ring_free(&ring);
+
+    List list = list_init();
+    long list_sum = 0;
+
+    start = bench_now();
+    for (size_t i = 0; i < ELEMENTS; i++) {
+        if (!list_push(&list, &values[i], sizeof(long), NULL, NULL))
+            return false;
+
+        if (list.count > depth) {
+            Node* node = list_dequeue(&list);
+            list_sum += *(const long*)node->content;
+            node_free(node);
+        }
+    }
+    while (list.head) {
+        Node* node = list_dequeue(&list);
+        list_sum += *(const long*)node->content;
+        node_free(node);
+    }
+    bench_report("list, append and dequeue", bench_now() - start, ELEMENTS);
+
+    return sum == list_sum;
+}
+
+// many short lists, the small vector never leaves its inline storage
+static bool bench_small_lists(long* values)
+{
+    SmallLongVector* small = malloc(sizeof(SmallLongVector) * SMALL_LISTS);
+    List* lists = malloc(sizeof(List) * SMALL_LISTS);
+    if (!small || !lists) {
+        fprintf(stderr, "containers_bench: malloc returned null\n");
+        free(small);
+        free(lists);
+        return false;
+    }
+
+    bool ok = true;
+    long sum = 0;
+    long list_sum = 0;
+
+    double start = bench_now();
+    for (size_t i = 0; i < SMALL_LISTS; i++) {
+        small[i] = small_long_vector_init();
+        for (size_t j = 0; j < SMALL_LIST_LENGTH; j++)
+            ok = small_long_vector_push(&small[i], values[i * SMALL_LIST_LENGTH + j]) && ok;
+    }
+    for (size_t i = 0; i < SMALL_LISTS; i++) {
+        for (size_t j = 0; j < small[i].count; j++)
+            sum += *small_long_vector_at(&small[i], j);
+        small_long_vector_free(&small[i]);
+    }
+    bench_report("small vector, build walk free", bench_now() - start, SMALL_LISTS * SMALL_LIST_LENGTH);
+
+    start = bench_now();
+    for (size_t i = 0; i < SMALL_LISTS; i++) {
+        lists[i] = list_init();
+        for (size_t j = 0; j < SMALL_LIST_LENGTH; j++)
+            ok = list_push(&lists[i], &values[i * SMALL_LIST_LENGTH + j], sizeof(long), NULL, NULL) && ok;
+    }
+    for (size_t i = 0; i < SMALL_LISTS; i++) {
+        for (const Node* node = lists[i].head; node; node = node->next)
+            list_sum += *(const long*)node->content;
+        list_free(&lists[i]);
+    }
+    bench_report("list, build walk free", bench_now() - start, SMALL_LISTS * SMALL_LIST_LENGTH);
+
+    free(small);
+    free(lists);
+
+    return ok && (sum == list_sum);
+}
+
+int main()
+{
+    long* values = malloc(sizeof(long) * ELEMENTS);
+    if (!values) {
+        fprintf(stderr, "containers_bench: malloc returned null\n");
+        return 1;
+    }
+
+    long expected = 0;
+    for (size_t i = 0; i < ELEMENTS; i++) {
+        values[i] = (long)i;
+        expected += (long)i;
+    }
+
+    unsigned long long state = 0x853C49E6748FEA9Bull;
+
+    printf("containers: %d elements\n", ELEMENTS);
+    bool ok = bench_vector(values, expected, &state);
+    ok = bench_list(values, expected) && ok;
+
+    printf("containers: queues at most 64 deep\n");
+    ok = bench_queues(values, 64) && ok;
+
+    printf("containers: %d lists of %d\n", SMALL_LISTS, SMALL_LIST_LENGTH);
+    ok = bench_small_lists(values) && ok;
+
+    // a ring that wrapped before growing has to keep its order
+    LongRing ring = long_ring_init();
+    for (long i = 0; i < CONTAINER_MIN_CAPACITY; i++)
+        ok = long_ring_push(&ring, i) && ok;
+    for (long i = 0; i < CONTAINER_MIN_CAPACITY / 2; i++)
+        ok = long_ring_pop(&ring, NULL) && ok;
+    for (long i = CONTAINER_MIN_CAPACITY; i < CONTAINER_MIN_CAPACITY * 3; i++)
+        ok = long_ring_push(&ring, i) && ok;
+    for (size_t i = 0; i < ring.count; i++)
+        ok = ok && (*long_ring_at(&ring, i) == (long)(CONTAINER_MIN_CAPACITY / 2 + i));
+    long_ring_free(&ring);
+
+    // a small vector that spilled keeps what it held inline
+    SmallLongVector small = small_long_vector_init();
+    for (long i = 0; i < SMALL_LIST_LENGTH * 4; i++)
+        ok = small_long_vector_push(&small, i) && ok;
+    for (size_t i = 0; i < small.count; i++)
+        ok = ok && (*small_long_vector_at(&small, i) == (long)i);
+    ok = ok && (small.items != NULL);
+    small_long_vector_free(&small);
+
+    free(values);
+
+    if (!ok)
+        fprintf(stderr, "containers_bench: a container did not hold what was pushed to it\n");
+
+    return ok ? 0 : 1;
+}
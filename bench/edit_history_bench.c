@@ -0,0 +1,122 @@
+#include "bench.h"
+#include "../edit_history.h"
+#include "../tile_fill.h"
+
+#define FILL_SIDE 1000       // cells per side of the filled square, 1M cells
+#define BACKGROUND_SIDE 1024 // the fill lands on a patch of mixed sprites, so its before values are not uniform
+#define HISTORY_BUDGET (256u * 1024 * 1024)
+
+// every cell of the fill square holds the fill value, or the background it covered
+static size_t count_filled(const TileGrid* grid, const TileCell cell)
+{
+    size_t count = 0;
+
+    for (int y = 0; y < FILL_SIDE; y++)
+        for (int x = 0; x < FILL_SIDE; x++) {
+            const TileCell found = tile_grid_get(grid, x, y);
+
+            count += (found.sheet == cell.sheet) && (found.sprite == cell.sprite);
+        }
+
+    return count;
+}
+
+static bool background_intact(const TileGrid* grid)
+{
+    unsigned long long state = 0x2545F4914F6CDD1Dull;
+
+    for (int y = 0; y < BACKGROUND_SIDE; y++)
+        for (int x = 0; x < BACKGROUND_SIDE; x++) {
+            const unsigned short sprite = bench_random(&state) % 8;
+
+            if (tile_grid_get(grid, x, y).sprite != sprite)
+                return false;
+        }
+
+    return true;
+}
+
+int main()
+{
+    TileGrid grid = tile_grid_init();
+    EditHistory history = edit_history_init(HISTORY_BUDGET);
+
+    unsigned long long state = 0x2545F4914F6CDD1Dull;
+
+    for (int y = 0; y < BACKGROUND_SIDE; y++)
+        for (int x = 0; x < BACKGROUND_SIDE; x++)
+            tile_grid_set(&grid, x, y, (TileCell){ .sheet = 1, .sprite = bench_random(&state) % 8, .type = TILE_TYPE_FLOOR });
+
+    const TileCell cell = { .sheet = 2, .sprite = 3, .type = TILE_TYPE_WALL };
+    int failures = 0;
+
+    printf("edit_history: %dx%d fill over mixed cells\n", FILL_SIDE, FILL_SIDE);
+
+    double start = bench_now();
+
+    edit_history_begin(&history, 0.0, false);
+    const size_t filled = tile_fill_rect(&history, &grid, 0, 0, FILL_SIDE - 1, FILL_SIDE - 1, cell);
+    edit_history_end(&history, 0.0);
+
+    bench_report("fill recorded", bench_now() - start, filled);
+
+    if ((filled != (size_t)FILL_SIDE * FILL_SIDE) || (count_filled(&grid, cell) != filled)) {
+        fprintf(stderr, "edit_history_bench: the fill wrote %zu cells\n", filled);
+        failures++;
+    }
+
+    const EditEntry* entry = &history.entries[0];
+
+    printf("  entry holds %zu cells in %zu deltas, %.2f MB raw\n", entry->cell_count, entry->delta_count, entry->raw_size / (1024.0 * 1024.0));
+
+    start = bench_now();
+    const bool undone = edit_history_undo(&history, &grid);
+    bench_report("undo", bench_now() - start, filled);
+
+    if (!undone || !background_intact(&grid)) {
+        fprintf(stderr, "edit_history_bench: undo did not bring the background back\n");
+        failures++;
+    }
+
+    start = bench_now();
+    const bool redone = edit_history_redo(&history, &grid);
+    bench_report("redo", bench_now() - start, filled);
+
+    if (!redone || (count_filled(&grid, cell) != filled)) {
+        fprintf(stderr, "edit_history_bench: redo did not bring the fill back\n");
+        failures++;
+    }
+
+    // single cell edits push the fill out of the hot window, which deflates it
+    for (int i = 0; i < EDIT_HISTORY_HOT_ENTRIES; i++) {
+        edit_history_begin(&history, 10.0 * (i + 1), false);
+        edit_history_set(&history, &grid, -1 - i, -1, cell);
+        edit_history_end(&history, 10.0 * (i + 1));
+    }
+
+    entry = &history.entries[0];
+
+    if (!entry->compressed) {
+        fprintf(stderr, "edit_history_bench: the fill was not compressed once it left the hot window\n");
+        failures++;
+    }
+
+    printf("  compressed to %.2f MB, %.1f%% of raw\n", entry->size / (1024.0 * 1024.0), 100.0 * entry->size / entry->raw_size);
+
+    for (int i = 0; i < EDIT_HISTORY_HOT_ENTRIES; i++)
+        edit_history_undo(&history, &grid);
+
+    start = bench_now();
+    const bool inflated = edit_history_undo(&history, &grid);
+    bench_report("compressed undo", bench_now() - start, filled);
+
+    if (!inflated || !background_intact(&grid) || (history.cursor != 0)) {
+        fprintf(stderr, "edit_history_bench: the compressed undo did not bring the background back\n");
+        failures++;
+    }
+
+    edit_history_free(&history);
+    tile_grid_free(&grid);
+
+    return (failures) ? 1 : 0;
+}
@@ -0,0 +1,174 @@
+#include "bench.h"
+#include "../utils.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define FILE_BYTES (1ull << 30)   // the size of the map save the writer has to keep up with
+#define PATTERN_BYTES (16u << 20) // parts are slices of it, so the file is never the same byte over and over
+#define BLOCKS_PER_CALL 8         // iovecs handed to one writev, half of them block headers
+#define RAW_BLOCK_BYTES (8u << 20)
+#define OUT_PATH "bench/bin/file_writer.bin"
+
+typedef enum
+{
+    PARTS_SMALL,  // 16 bytes to 8 KB, the writer gathers them in its buffer
+    PARTS_BLOCKS, // a 16 byte header then a 256 KB to 2 MB block, the way chunk blocks go out
+} PartMode;
+
+typedef struct
+{
+    unsigned long long state;
+    size_t offset; // into the pattern
+    size_t total;  // handed out so far
+} PartStream;
+
+// the next slice of the pattern, the same seed always gives the same run of parts
+static struct iovec next_part(PartStream* stream, const unsigned char* pattern, const PartMode mode, const bool header)
+{
+    size_t size = 16;
+
+    if (mode == PARTS_SMALL)
+        size = 16 + (bench_random(&stream->state) % 8177);
+    else if (!header)
+        size = (256u << 10) + (bench_random(&stream->state) % (1792u << 10));
+
+    if (size > (FILE_BYTES - stream->total))
+        size = FILE_BYTES - stream->total;
+
+    if ((stream->offset + size) > PATTERN_BYTES)
+        stream->offset = 0;
+
+    const struct iovec part = { .iov_base = (void*)(pattern + stream->offset), .iov_len = size };
+
+    stream->offset += size;
+    stream->total += size;
+
+    return part;
+}
+
+// replays the parts against what ended up on disk
+static bool verify(const char* path, const unsigned char* pattern, const PartMode mode, const unsigned long long seed)
+{
+    MappedFile file;
+    if (!mapped_file_open(&file, path, FILE_ACCESS_SEQUENTIAL))
+        return false;
+
+    bool same = (file.size == FILE_BYTES);
+    PartStream stream = { .state = seed };
+
+    for (size_t n = 0; same && (stream.total < FILE_BYTES); n++) {
+        const size_t at = stream.total;
+        const struct iovec part = next_part(&stream, pattern, mode, (n % 2) == 0);
+
+        same = (memcmp(file.data + at, part.iov_base, part.iov_len) == 0);
+    }
+
+    mapped_file_close(&file);
+
+    return same;
+}
+
+static bool bench_writer(const char* name, const unsigned char* pattern, const PartMode mode, const unsigned long long seed)
+{
+    FileWriter writer;
+    PartStream stream = { .state = seed };
+
+    const double start = bench_now();
+
+    if (!file_writer_open(&writer, OUT_PATH))
+        return false;
+
+    size_t calls = 0;
+    bool written = true;
+
+    for (size_t n = 0; written && (stream.total < FILE_BYTES); calls++) {
+        struct iovec parts[BLOCKS_PER_CALL];
+        int count = 0;
+
+        if (mode == PARTS_SMALL) {
+            parts[count++] = next_part(&stream, pattern, mode, false);
+            written = file_writer_write(&writer, parts[0].iov_base, parts[0].iov_len);
+            continue;
+        }
+
+        while ((count < BLOCKS_PER_CALL) && (stream.total < FILE_BYTES))
+            parts[count++] = next_part(&stream, pattern, mode, (n++ % 2) == 0);
+
+        written = file_writer_writev(&writer, parts, count);
+    }
+
+    if (!written) {
+        file_writer_abort(&writer);
+        return false;
+    }
+
+    if (!file_writer_commit(&writer))
+        return false;
+
+    const double seconds = bench_now() - start;
+
+    printf("  %-36s %10.2f ms %10.1f MB/s, %zu calls\n", name, seconds * 1000.0, FILE_BYTES / (1024.0 * 1024.0) / seconds, calls);
+
+    if (!verify(OUT_PATH, pattern, mode, seed)) {
+        fprintf(stderr, "file_writer_bench: \"%s\" does not hold what %s wrote\n", OUT_PATH, name);
+        return false;
+    }
+
+    return true;
+}
+
+// what the disk takes from plain large writes, the figure the writer is measured against
+static bool bench_raw(const unsigned char* pattern)
+{
+    const double start = bench_now();
+
+    const int fd = open(OUT_PATH, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (fd < 0)
+        return false;
+
+    bool written = true;
+
+    for (size_t total = 0; written && (total < FILE_BYTES); total += RAW_BLOCK_BYTES)
+        written = write(fd, pattern, RAW_BLOCK_BYTES) == RAW_BLOCK_BYTES;
+
+    written = (fsync(fd) == 0) && written;
+    close(fd);
+
+    const double seconds = bench_now() - start;
+
+    printf("  %-36s %10.2f ms %10.1f MB/s\n", "write 8 MB blocks, no writer", seconds * 1000.0, FILE_BYTES / (1024.0 * 1024.0) / seconds);
+
+    return written;
+}
+
+int main()
+{
+    unsigned char* pattern = malloc(PATTERN_BYTES);
+    if (!pattern) {
+        fprintf(stderr, "file_writer_bench: malloc returned null\n");
+        return 1;
+    }
+
+    unsigned long long state = 0x9E3779B97F4A7C15ull;
+
+    for (size_t i = 0; i < PATTERN_BYTES; i += sizeof(unsigned long long)) {
+        const unsigned long long value = bench_random(&state);
+        memcpy(pattern + i, &value, sizeof(value));
+    }
+
+    printf("file_writer: %.0f MB per save, fsync and rename included\n", FILE_BYTES / (1024.0 * 1024.0));
+
+    int failures = 0;
+
+    failures += !bench_raw(pattern);
+    failures += !bench_writer("buffered parts, 16 B to 8 KB", pattern, PARTS_SMALL, 0x2545F4914F6CDD1Dull);
+    failures += !bench_writer("writev headers, 256 KB-2 MB blocks", pattern, PARTS_BLOCKS, 0x94D049BB133111EBull);
+
+    unlink(OUT_PATH);
+    free(pattern); pattern = NULL;
+
+    return (failures) ? 1 : 0;
+}
@@ -0,0 +1,78 @@
+#include "bench.h"
+#include "../grid_renderer.h"
+
+#include "rlgl.h"
+
+#define DRAWS 10000
+
+// rlgl stand-ins, the harness counts what the renderer submits instead of drawing it
+static size_t submitted_vertices = 0;
+static int reserved_vertices = 0;
+
+void rlBegin(int mode) { (void)mode; }
+void rlEnd(void) {}
+void rlVertex2f(float x, float y) { (void)x; (void)y; submitted_vertices++; }
+void rlColor4ub(unsigned char r, unsigned char g, unsigned char b, unsigned char a) { (void)r; (void)g; (void)b; (void)a; }
+bool rlCheckRenderBatchLimit(int vCount) { reserved_vertices = vCount; return false; }
+
+// what draw_world passes for a view of width x height screen pixels, centered away from the origin
+static Rectangle view_bounds(const int width, const int height, const float zoom)
+{
+    return (Rectangle) {
+        .x = 100000.0f,
+        .y = -50000.0f,
+        .width = width / zoom,
+        .height = height / zoom,
+    };
+}
+
+static size_t draw_once(GridRenderer* renderer, const Rectangle bounds, const float tile_size, const float zoom)
+{
+    submitted_vertices = 0;
+    grid_renderer_draw(renderer, bounds, tile_size, zoom);
+
+    if (submitted_vertices > (size_t)reserved_vertices)
+        fprintf(stderr, "grid_renderer_bench: %zu vertices submitted, %d reserved\n", submitted_vertices, reserved_vertices);
+
+    return submitted_vertices;
+}
+
+int main()
+{
+    GridRenderer renderer = grid_renderer_init(BLACK, BLACK);
+
+    const struct { const char* name; int width, height; } screens[] = {
+        { "1080p", 1920, 1080 },
+        { "4K", 3840, 2160 },
+    };
+
+    bool over_reserved = false;
+
+    for (size_t s = 0; s < sizeof(screens) / sizeof(screens[0]); s++) {
+        printf("grid_renderer: %s, vertices by tile size at zoom 1\n ", screens[s].name);
+
+        for (int tile_size = 8; tile_size <= 128; tile_size *= 2)
+            printf(" %d: %zu", tile_size, draw_once(&renderer, view_bounds(screens[s].width, screens[s].height, 1.0f), tile_size, 1.0f));
+
+        printf("\n");
+
+        size_t most = 0;
+        for (float zoom = 0.01f; zoom <= 2.56f; zoom *= 1.05f) {
+            const size_t vertices = draw_once(&renderer, view_bounds(screens[s].width, screens[s].height, zoom), 8, zoom);
+            most = (vertices > most) ? vertices : most;
+            over_reserved |= vertices > (size_t)reserved_vertices;
+        }
+
+        printf("  most vertices over zoom 0.01 to 2.56 at tile size 8: %zu\n", most);
+    }
+
+    const Rectangle bounds = view_bounds(1920, 1080, 1.0f);
+
+    const double start = bench_now();
+    for (int i = 0; i < DRAWS; i++)
+        draw_once(&renderer, bounds, 8, 1.0f);
+
+    bench_report("draw, 1080p at tile size 8", bench_now() - start, DRAWS);
+
+    return over_reserved ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+#include "bench.h"
+#include "../list.h"
+
+#include <stdlib.h>
+
+#define ELEMENTS 1000000
+
+typedef struct
+{
+    long value;
+    ListLink link;
+} Element;
+
+// sums what 'list' holds, the walk every variant is timed on
+static long sum_list(const List* list)
+{
+    long sum = 0;
+
+    for (const Node* node = list->head; node; node = node->next)
+        sum += *(const long*)node->content;
+
+    return sum;
+}
+
+// appends, walks and frees ELEMENTS nodes, false when the walk saw the wrong values
+static bool bench_node_list(const char* name, List list, long* values, const long expected)
+{
+    char label[64];
+
+    double start = bench_now();
+    for (size_t i = 0; i < ELEMENTS; i++) {
+        if (!list_push(&list, &values[i], sizeof(long), NULL, NULL)) {
+            fprintf(stderr, "list_bench: push failed\n");
+            return false;
+        }
+    }
+    snprintf(label, sizeof(label), "%s, append", name);
+    bench_report(label, bench_now() - start, ELEMENTS);
+
+    start = bench_now();
+    const long sum = sum_list(&list);
+    snprintf(label, sizeof(label), "%s, iterate", name);
+    bench_report(label, bench_now() - start, ELEMENTS);
+
+    start = bench_now();
+    list_free(&list);
+    snprintf(label, sizeof(label), "%s, free", name);
+    bench_report(label, bench_now() - start, ELEMENTS);
+
+    return sum == expected;
+}
+
+int main()
+{
+    long* values = malloc(sizeof(long) * ELEMENTS);
+    Element* elements = malloc(sizeof(Element) * ELEMENTS);
+    if (!values || !elements) {
+        fprintf(stderr, "list_bench: malloc returned null\n");
+        return 1;
+    }
+
+    long expected = 0;
+    for (size_t i = 0; i < ELEMENTS; i++) {
+        values[i] = elements[i].value = (long)i;
+        expected += (long)i;
+    }
+
+    printf("list: %d elements\n", ELEMENTS);
+
+    bool ok = bench_node_list("malloc per node", list_init(), values, expected);
+    ok = ok && bench_node_list("slab list", list_init_slab(0), values, expected);
+
+    // a shared pool hands freed nodes to the next list without going back to malloc
+    ListPool pool = list_pool_init(sizeof(Node), 0);
+    ok = ok && bench_node_list("shared pool, cold", list_init_pooled(&pool), values, expected);
+    ok = ok && bench_node_list("shared pool, warm", list_init_pooled(&pool), values, expected);
+    ok = ok && (pool.live == 0);
+    list_pool_free(&pool);
+
+    // the links live in the elements, nothing is allocated
+    IntrusiveList intrusive = intrusive_list_init();
+
+    double start = bench_now();
+    for (size_t i = 0; i < ELEMENTS; i++)
+        intrusive_list_append(&intrusive, &elements[i].link);
+    bench_report("intrusive, append", bench_now() - start, ELEMENTS);
+
+    long sum = 0;
+    start = bench_now();
+    for (const ListLink* link = intrusive.head; link; link = link->next)
+        sum += LIST_CONTAINER(link, Element, link)->value;
+    bench_report("intrusive, iterate", bench_now() - start, ELEMENTS);
+
+    start = bench_now();
+    while (intrusive_list_dequeue(&intrusive));
+    bench_report("intrusive, dequeue all", bench_now() - start, ELEMENTS);
+
+    ok = ok && (sum == expected) && (intrusive.count == 0);
+
+    // a slab list refuses nodes it could not free or that would outlive its slabs
+    List slab = list_init_slab(0);
+    List plain = list_init();
+    Node* foreign = node_init(&values[0], sizeof(long), NULL, NULL);
+    Node* owned = list_push(&slab, &values[1], sizeof(long), NULL, NULL);
+
+    ok = ok && foreign && owned && !list_append(&slab, foreign) && !list_append(&plain, list_dequeue(&slab));
+
+    node_free(foreign);
+    list_free(&slab);
+    list_free(&plain);
+
+    free(elements);
+    free(values);
+
+    if (!ok)
+        fprintf(stderr, "list_bench: a list did not hold what was appended to it\n");
+
+    return ok ? 0 : 1;
+}
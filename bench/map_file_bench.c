@@ -0,0 +1,168 @@
+#include "bench.h"
+#include "../map_file.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define FILL_SIDE 3163 // cells per side of the filled square, about 10M cells
+#define MAP_PATH "bench/bin/bench" MAP_FILE_EXTENSION
+
+// blocks handed out one at a time to every reader, the way the world stream's readers share requests
+typedef struct
+{
+    const MapFile* map;
+    atomic_size_t next;
+    atomic_size_t failed;
+    atomic_size_t cells;
+} ReadJob;
+
+static void* read_work(void* arg)
+{
+    ReadJob* job = (ReadJob*) arg;
+
+    TileChunk* chunk = malloc(sizeof(TileChunk));
+    size_t i;
+
+    while (chunk && ((i = atomic_fetch_add(&job->next, 1)) < job->map->chunk_count)) {
+        if (map_file_read_chunk(job->map, i, chunk))
+            atomic_fetch_add(&job->cells, chunk->count);
+        else
+            atomic_fetch_add(&job->failed, 1);
+    }
+
+    if (!chunk)
+        atomic_fetch_add(&job->failed, 1);
+
+    free(chunk);
+
+    return NULL;
+}
+
+int main()
+{
+    TileGrid grid = tile_grid_init();
+
+    // cells need a live slot to be saved with, the palette only reads the texture's size
+    TilePalette palette = tile_palette_init();
+    Texture texture = { .id = 0, .width = 256, .height = 256 };
+    AssetCache cache = asset_cache_init(0);
+
+    if (tile_palette_add_sheet(&palette, 1, &texture, NULL, 16.0f) == 0) {
+        fprintf(stderr, "map_file_bench: failed to add a sheet\n");
+        return 1;
+    }
+
+    // a few sprites laid out in patches, closer to a painted map than one repeated cell
+    for (int y = 0; y < FILL_SIDE; y++) {
+        for (int x = 0; x < FILL_SIDE; x++) {
+            const TileCell cell = { .sheet = 1, .sprite = ((x / 5) + (y / 3) * 7) % 48, .type = TILE_TYPE_FLOOR, .flags = 0 };
+            tile_grid_set(&grid, x - (FILL_SIDE / 2), y - (FILL_SIDE / 2), cell);
+        }
+    }
+
+    MapFileStats stats;
+    if (!map_file_save(MAP_PATH, &grid, &palette, &cache, (Vector2){0,0}, NULL, &stats)) {
+        fprintf(stderr, "map_file_bench: failed to save \"%s\"\n", MAP_PATH);
+        return 1;
+    }
+
+    printf("map_file: %zu cells in %zu chunks, %.1f MB raw, %.2f MB on disk, %d threads\n", stats.cell_count, stats.chunk_count, stats.raw_bytes / (1024.0 * 1024.0), stats.file_bytes / (1024.0 * 1024.0), stats.thread_count);
+    printf("  %-36s %10.2f ms %10.1f MB/s raw\n", "save", stats.seconds * 1000.0, stats.raw_bytes / (1024.0 * 1024.0) / stats.seconds);
+
+    // every chunk read the way the world stream reads them, one block at a time
+    MapFile map;
+    double start = bench_now();
+
+    if (!map_file_open(&map, MAP_PATH, NULL, NULL)) {
+        fprintf(stderr, "map_file_bench: failed to open \"%s\"\n", MAP_PATH);
+        return 1;
+    }
+
+    TileChunk* chunk = malloc(sizeof(TileChunk));
+    if (!chunk) {
+        fprintf(stderr, "map_file_bench: malloc returned null\n");
+        return 1;
+    }
+
+    size_t mismatches = 0;
+    size_t cells = 0;
+
+    for (size_t i = 0; i < map.chunk_count; i++) {
+        if (!map_file_read_chunk(&map, i, chunk)) {
+            mismatches++;
+            continue;
+        }
+
+        const TileChunk* saved = tile_grid_find_chunk(&grid, chunk->cx, chunk->cy);
+        if (!saved || (saved->count != chunk->count) || (memcmp(saved->cells, chunk->cells, sizeof(chunk->cells)) != 0))
+            mismatches++;
+
+        cells += chunk->count;
+    }
+
+    double seconds = bench_now() - start;
+    printf("  %-36s %10.2f ms %10.1f MB/s raw\n", "open and read every chunk", seconds * 1000.0, stats.raw_bytes / (1024.0 * 1024.0) / seconds);
+
+    // the same blocks spread over a reader per core
+    const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    const int readers = (cores < 1) ? 1 : ((cores > MAP_FILE_MAX_THREADS) ? MAP_FILE_MAX_THREADS : cores);
+
+    ReadJob job = { .map = &map };
+    atomic_init(&job.next, 0);
+    atomic_init(&job.failed, 0);
+    atomic_init(&job.cells, 0);
+
+    pthread_t threads[MAP_FILE_MAX_THREADS];
+    int started = 0;
+
+    start = bench_now();
+
+    for (int i = 0; i < readers; i++)
+        started += (pthread_create(&threads[started], NULL, read_work, &job) == 0);
+
+    // a reader that did not start leaves its share to the others
+    if (started == 0)
+        read_work(&job);
+
+    for (int i = 0; i < started; i++)
+        pthread_join(threads[i], NULL);
+
+    seconds = bench_now() - start;
+
+    char name[64];
+    snprintf(name, sizeof(name), "read every chunk on %d threads", (started) ? started : 1);
+    printf("  %-36s %10.2f ms %10.1f MB/s raw\n", name, seconds * 1000.0, stats.raw_bytes / (1024.0 * 1024.0) / seconds);
+
+    if ((atomic_load(&job.failed) > 0) || (atomic_load(&job.cells) != stats.cell_count))
+        mismatches++;
+
+    // one flipped byte in a block has to be caught before it is inflated
+    const unsigned long long damaged_offset = map.chunks[map.chunk_count / 2].offset + (map.chunks[map.chunk_count / 2].size / 2);
+    const size_t damaged_index = map.chunk_count / 2;
+    map_file_close(&map);
+
+    FILE* file = fopen(MAP_PATH, "r+b");
+    int byte = EOF;
+
+    if (file && (fseek(file, damaged_offset, SEEK_SET) == 0) && ((byte = fgetc(file)) != EOF) && (fseek(file, damaged_offset, SEEK_SET) == 0))
+        fputc(byte ^ 0x40, file);
+
+    if (file)
+        fclose(file);
+
+    const bool rejected = map_file_open(&map, MAP_PATH, NULL, NULL) && !map_file_read_chunk(&map, damaged_index, chunk);
+    map_file_close(&map);
+
+    printf("  reloaded cells match: %s, corrupt block rejected: %s\n", (!mismatches && (cells == grid.cell_count)) ? "yes" : "no", rejected ? "yes" : "no");
+
+    remove(MAP_PATH);
+    free(chunk);
+    tile_grid_free(&grid);
+    tile_palette_free(&palette);
+    asset_cache_free(&cache);
+
+    return (!mismatches && (cells == stats.cell_count) && rejected) ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+#include "bench.h"
+#include "../tile_palette.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SHEET_COUNT 32
+#define SHEET_SIDE 1024   // pixels, 4096 cells per sheet at SPRITE_SIZE, about 100K sprites once a quarter is left empty
+#define SPRITE_SIZE 16.0f
+#define VISIBLE_SPRITES 100 // ten rows of ten, what the side bar shows at once
+#define FRAMES 100000
+
+// steps from (slot, cell) to the next listed sprite the way draw_tile_scroll_panel does, slot becomes 0 past the end
+static void palette_step(const TilePalette* palette, unsigned short* slot, int* cell)
+{
+    (*cell) = palette_sheet_next_cell(tile_palette_get_sheet(palette, *slot), *cell);
+    while (((*cell) < 0) && ((*slot) < palette->sheet_count))
+        (*cell) = palette_sheet_next_cell(tile_palette_get_sheet(palette, ++(*slot)), -1);
+
+    if ((*cell) < 0)
+        (*slot) = 0;
+}
+
+// an opaque sheet with about a quarter of its cells left transparent, so the walk has gaps to skip
+static Image make_sheet_image(unsigned long long* state)
+{
+    const int cells_per_side = SHEET_SIDE / SPRITE_SIZE;
+
+    Image image = {
+        .data = calloc((size_t)SHEET_SIDE * SHEET_SIDE, 4),
+        .width = SHEET_SIDE,
+        .height = SHEET_SIDE,
+        .mipmaps = 1,
+        .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8,
+    };
+
+    if (!image.data)
+        return image;
+
+    for (int cy = 0; cy < cells_per_side; cy++) {
+        for (int cx = 0; cx < cells_per_side; cx++) {
+            if ((bench_random(state) % 4) == 0)
+                continue;
+
+            for (int y = cy * SPRITE_SIZE; y < (cy + 1) * SPRITE_SIZE; y++)
+                memset((unsigned char*)image.data + ((((size_t)y * SHEET_SIDE) + (cx * (int)SPRITE_SIZE)) * 4), 0xFF, SPRITE_SIZE * 4);
+        }
+    }
+
+    return image;
+}
+
+int main()
+{
+    TilePalette palette = tile_palette_init();
+    Texture textures[SHEET_COUNT];
+
+    unsigned long long state = 0xD1B54A32D192ED03ull;
+
+    for (int i = 0; i < SHEET_COUNT; i++) {
+        Image image = make_sheet_image(&state);
+        if (!image.data) {
+            fprintf(stderr, "palette_walk_bench: calloc returned null\n");
+            return 1;
+        }
+
+        textures[i] = (Texture){ .id = 0, .width = SHEET_SIDE, .height = SHEET_SIDE };
+
+        const bool added = tile_palette_add_sheet(&palette, i + 1, &textures[i], &image, SPRITE_SIZE) != 0;
+        free(image.data);
+
+        if (!added) {
+            fprintf(stderr, "palette_walk_bench: failed to add sheet %d\n", i);
+            return 1;
+        }
+    }
+
+    printf("palette walk: %zu sprites over %zu sheets, %d visible per frame\n", palette.sprite_count, palette.sheet_count, VISIBLE_SPRITES);
+
+    // both ways of finding the visible sprites see the same scroll positions
+    size_t* firsts = malloc(sizeof(size_t) * FRAMES);
+    if (!firsts) {
+        fprintf(stderr, "palette_walk_bench: malloc returned null\n");
+        return 1;
+    }
+
+    for (size_t frame = 0; frame < FRAMES; frame++)
+        firsts[frame] = bench_random(&state) % (palette.sprite_count - VISIBLE_SPRITES);
+
+    size_t mismatches = 0;
+
+    // one search for the first visible sprite, then stepping through the occupied bits
+    double start = bench_now();
+    size_t checksum = 0;
+
+    for (size_t frame = 0; frame < FRAMES; frame++) {
+        unsigned short slot;
+        int cell;
+        tile_palette_locate(&palette, firsts[frame], &slot, &cell);
+
+        for (size_t i = 0; i < VISIBLE_SPRITES; i++) {
+            checksum += (slot * 65536) + cell;
+            palette_step(&palette, &slot, &cell);
+        }
+    }
+
+    bench_report("locate then step, per frame", bench_now() - start, FRAMES);
+
+    // a search for every visible sprite, what the walk is checked against
+    start = bench_now();
+    size_t reference = 0;
+
+    for (size_t frame = 0; frame < FRAMES; frame++) {
+        for (size_t i = firsts[frame]; i < firsts[frame] + VISIBLE_SPRITES; i++) {
+            unsigned short slot;
+            int cell;
+
+            if (!tile_palette_locate(&palette, i, &slot, &cell))
+                mismatches++;
+
+            reference += (slot * 65536) + cell;
+        }
+    }
+
+    bench_report("locate every sprite, per frame", bench_now() - start, FRAMES);
+
+    // walking the whole palette, what drawing every sheet and letting the scissor hide it cost
+    start = bench_now();
+    size_t walked = 0;
+
+    for (size_t frame = 0; frame < 100; frame++) {
+        unsigned short slot = 1;
+        int cell = palette_sheet_next_cell(tile_palette_get_sheet(&palette, slot), -1);
+
+        while (slot != 0) {
+            walked++;
+            palette_step(&palette, &slot, &cell);
+        }
+    }
+
+    bench_report("walk every sprite, per frame", bench_now() - start, 100);
+
+    if ((checksum != reference) || mismatches || (walked != palette.sprite_count * 100)) {
+        fprintf(stderr, "palette_walk_bench: the walk disagreed with tile_palette_locate\n");
+        return 1;
+    }
+
+    tile_palette_free(&palette);
+    free(firsts);
+
+    return 0;
+}
@@ -0,0 +1,190 @@
+#include "bench.h"
+#include "../sprite_atlas.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SHEET_SIDE 4096 // pixels, 65536 cells at SPRITE_SIZE
+#define SPRITE_SIZE 16.0f
+#define MAX_TEXTURES 32
+#define SLICE_BYTES (1024 * 1024) // what the editor uploads per call while a sheet goes up, UPLOAD_SLICE_BYTES
+
+// texture stand-ins that keep a CPU copy of every page, so what the atlas uploads can be checked against the sheet
+static unsigned char* texture_pixels[MAX_TEXTURES];
+static int texture_widths[MAX_TEXTURES];
+static unsigned int next_texture_id = 1;
+static size_t texture_updates = 0;
+static size_t texture_bytes = 0;
+
+bool IsImageReady(Image image) { return (image.data != NULL) && (image.width > 0) && (image.height > 0); }
+bool IsTextureReady(Texture2D texture) { return texture.id != 0; }
+Image ImageCopy(Image image) { return image; }
+void ImageFormat(Image* image, int format) { (void)image; (void)format; }
+void UnloadImage(Image image) { (void)image; }
+
+unsigned int rlLoadTexture(const void* data, int width, int height, int format, int mipmaps)
+{
+    (void)data; (void)format; (void)mipmaps;
+
+    if (next_texture_id >= MAX_TEXTURES)
+        return 0;
+
+    const unsigned int id = next_texture_id++;
+    texture_pixels[id] = calloc((size_t)width * height, 4);
+    texture_widths[id] = width;
+
+    return texture_pixels[id] ? id : 0;
+}
+
+void UnloadTexture(Texture2D texture)
+{
+    free(texture_pixels[texture.id]);
+    texture_pixels[texture.id] = NULL;
+}
+
+void UpdateTextureRec(Texture2D texture, Rectangle rec, const void* pixels)
+{
+    const size_t row = (size_t)rec.width * 4;
+
+    for (int y = 0; y < (int)rec.height; y++)
+        memcpy(texture_pixels[texture.id] + ((((size_t)(rec.y + y) * texture_widths[texture.id]) + (size_t)rec.x) * 4), (const unsigned char*)pixels + (y * row), row);
+
+    texture_updates++;
+    texture_bytes += row * (size_t)rec.height;
+}
+
+// every listed cell of the sheet has to be in its atlas rect, pixel for pixel
+static bool check_atlas(const SpriteAtlas* atlas, const unsigned short slot, const PaletteSheet* sheet, const Image* image)
+{
+    const int size = sheet->sprite_size;
+
+    for (int cell = palette_sheet_next_cell(sheet, -1); cell >= 0; cell = palette_sheet_next_cell(sheet, cell)) {
+        Texture page;
+        Rectangle source;
+
+        if (!sprite_atlas_lookup(atlas, slot, cell, &page, &source))
+            return false;
+
+        const Rectangle rect = palette_sheet_sprite_rect(sheet, cell);
+
+        for (int y = 0; y < size; y++) {
+            const unsigned char* expected = (const unsigned char*)image->data + ((((size_t)(rect.y + y) * image->width) + (size_t)rect.x) * 4);
+            const unsigned char* actual = texture_pixels[page.id] + ((((size_t)(source.y + y) * texture_widths[page.id]) + (size_t)source.x) * 4);
+
+            if (memcmp(expected, actual, (size_t)size * 4) != 0)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+static void fill_sheet(Image* image, const unsigned char seed)
+{
+    unsigned char* pixels = image->data;
+
+    for (size_t i = 0; i < (size_t)image->width * image->height; i++) {
+        pixels[(i * 4) + 0] = (unsigned char)(i * 7 + seed);
+        pixels[(i * 4) + 1] = (unsigned char)(i >> 5);
+        pixels[(i * 4) + 2] = (unsigned char)(i >> 13);
+        pixels[(i * 4) + 3] = 0xFF;
+    }
+}
+
+int main()
+{
+    Image image = {
+        .data = malloc((size_t)SHEET_SIDE * SHEET_SIDE * 4),
+        .width = SHEET_SIDE,
+        .height = SHEET_SIDE,
+        .mipmaps = 1,
+        .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8,
+    };
+
+    if (!image.data) {
+        fprintf(stderr, "sprite_atlas_bench: malloc returned null\n");
+        return 1;
+    }
+
+    fill_sheet(&image, 0);
+
+    TilePalette palette = tile_palette_init();
+    Texture texture = { .id = 0, .width = SHEET_SIDE, .height = SHEET_SIDE };
+
+    const unsigned short slot = tile_palette_add_sheet(&palette, 1, &texture, &image, SPRITE_SIZE);
+    const PaletteSheet* sheet = tile_palette_get_sheet(&palette, slot);
+    if (!sheet) {
+        fprintf(stderr, "sprite_atlas_bench: failed to add the sheet to the palette\n");
+        return 1;
+    }
+
+    SpriteAtlas atlas = sprite_atlas_init();
+
+    printf("sprite_atlas: %dx%d sheet, %d sprites\n", SHEET_SIDE, SHEET_SIDE, palette_sheet_sprite_count(sheet));
+
+    double start = bench_now();
+    bool ok = sprite_atlas_add_sheet(&atlas, slot, sheet, &image);
+    bench_report("add sheet, per sprite", bench_now() - start, palette_sheet_sprite_count(sheet));
+    printf("  %zu pages, %zu texture updates, %.1f MB uploaded\n", atlas.page_count, texture_updates, texture_bytes / (1024.0 * 1024.0));
+
+    ok = ok && check_atlas(&atlas, slot, sheet, &image);
+
+    fill_sheet(&image, 1);
+    texture_updates = texture_bytes = 0;
+
+    start = bench_now();
+    ok = ok && sprite_atlas_update_sheet(&atlas, slot, sheet, &image);
+    bench_report("update sheet, per sprite", bench_now() - start, palette_sheet_sprite_count(sheet));
+    printf("  %zu texture updates, %.1f MB uploaded\n", texture_updates, texture_bytes / (1024.0 * 1024.0));
+
+    ok = ok && check_atlas(&atlas, slot, sheet, &image);
+
+    // the editor's split, every pass over the pixels on the loader thread and the main thread left with slices of uploads
+    PaletteSheet analyzed;
+    AtlasStaging staging;
+    Texture second_texture = { .id = 0, .width = SHEET_SIDE, .height = SHEET_SIDE };
+
+    start = bench_now();
+    ok = ok && palette_sheet_init(&analyzed, SHEET_SIDE, SHEET_SIDE, &image, SPRITE_SIZE) && atlas_staging_init(&staging, &analyzed, &image);
+    bench_report("analyze and stage, per sprite", bench_now() - start, analyzed.sprite_count);
+
+    const unsigned short second = ok ? tile_palette_adopt_sheet(&palette, 2, &second_texture, &analyzed) : 0;
+    const PaletteSheet* second_sheet = tile_palette_get_sheet(&palette, second);
+    sheet = tile_palette_get_sheet(&palette, slot);
+
+    const size_t row_bytes = (size_t)staging.columns * staging.padded * staging.padded * 4;
+    const int slice = (SLICE_BYTES / row_bytes > 0) ? (int)(SLICE_BYTES / row_bytes) : 1;
+
+    double worst = 0;
+    size_t slices = 0;
+
+    start = bench_now();
+    ok = ok && second_sheet && sprite_atlas_place_sheet(&atlas, second, second_sheet, &staging);
+    worst = bench_now() - start;
+
+    for (int row = 0; ok && (row < staging.rows); row += slice) {
+        const double slice_start = bench_now();
+        ok = sprite_atlas_upload_rows(&atlas, second, &staging, row, ((staging.rows - row) < slice) ? (staging.rows - row) : slice);
+
+        const double seconds = bench_now() - slice_start;
+        worst = (seconds > worst) ? seconds : worst;
+        slices++;
+    }
+
+    sprite_atlas_map_sheet(&atlas, second, second_sheet);
+    printf("  main thread: %zu slices of at most %d KB, worst %.3f ms\n", slices, SLICE_BYTES / 1024, worst * 1000.0);
+
+    ok = ok && check_atlas(&atlas, second, second_sheet, &image) && check_atlas(&atlas, slot, sheet, &image);
+
+    atlas_staging_free(&staging);
+    palette_sheet_free(&analyzed);
+
+    sprite_atlas_free(&atlas);
+    tile_palette_free(&palette);
+    free(image.data);
+
+    if (!ok)
+        fprintf(stderr, "sprite_atlas_bench: the atlas does not hold the sheet's pixels\n");
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+#include "bench.h"
+#include "../utils.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define DUMP_BYTES (100u << 20) // a layer dumped as text, one row of sprite indices per line
+#define ROW_CELLS 2000
+
+typedef struct
+{
+    size_t fields;
+    size_t records;
+    size_t bytes; // held by the fields, separators left out
+} DumpCounts;
+
+// rows of comma separated indices, most cells are small numbers the way painted layers are
+static char* build_dump(size_t* length, DumpCounts* counts)
+{
+    char* dump = malloc(DUMP_BYTES + 16);
+    if (!dump) {
+        fprintf(stderr, "text_tokenizer_bench: malloc returned null\n");
+        return NULL;
+    }
+
+    unsigned long long state = 0x9E3779B97F4A7C15ull;
+    size_t used = 0;
+
+    (*counts) = (DumpCounts){0};
+
+    while ((used + (ROW_CELLS * 7)) < DUMP_BYTES) {
+        for (int c = 0; c < ROW_CELLS; c++) {
+            const unsigned long long r = bench_random(&state);
+            const unsigned int value = (r & 3) ? (unsigned int)((r >> 8) % 64) : (unsigned int)((r >> 8) % 65536);
+            const int written = snprintf(dump + used, 8, "%u", value);
+
+            used += written;
+            counts->bytes += written;
+            counts->fields++;
+
+            dump[used++] = (c == (ROW_CELLS - 1)) ? '\n' : ',';
+        }
+
+        counts->records++;
+    }
+
+    // the newline closing the last row is followed by one empty record
+    counts->fields++;
+    counts->records++;
+
+    (*length) = used;
+
+    return dump;
+}
+
+// reading every byte once, the pace a tokenizer would have to keep to run at memory bandwidth
+static unsigned long long bench_read(const char* dump, const size_t length)
+{
+    unsigned long long sum = 0;
+
+    for (size_t i = 0; (i + sizeof(sum)) <= length; i += sizeof(sum)) {
+        unsigned long long word;
+        memcpy(&word, dump + i, sizeof(word));
+        sum += word;
+    }
+
+    return sum;
+}
+
+static DumpCounts bench_nested(const char* dump, const size_t length)
+{
+    DumpCounts counts = {0};
+
+    TextTokenizer lines = text_tokenizer_init(dump, length, "\n", '\0');
+    StringView line;
+
+    while (text_tokenizer_next(&lines, &line)) {
+        counts.records++;
+
+        // an empty line still holds one empty field
+        if (line.length == 0) {
+            counts.fields++;
+            continue;
+        }
+
+        TextTokenizer fields = text_tokenizer_init(line.data, line.length, ",", '"');
+        StringView field;
+
+        while (text_tokenizer_next(&fields, &field)) {
+            counts.fields++;
+            counts.bytes += field.length;
+        }
+    }
+
+    return counts;
+}
+
+static DumpCounts bench_records(const char* dump, const size_t length)
+{
+    DumpCounts counts = {0};
+
+    TextTokenizer fields = text_tokenizer_init_records(dump, length, ",", '\n', '"');
+    StringView field;
+
+    while (text_tokenizer_next(&fields, &field)) {
+        counts.fields++;
+        counts.bytes += field.length;
+        counts.records += fields.record_end;
+    }
+
+    return counts;
+}
+
+static bool counts_match(const char* name, const DumpCounts found, const DumpCounts expected)
+{
+    if ((found.fields == expected.fields) && (found.records == expected.records) && (found.bytes == expected.bytes))
+        return true;
+
+    fprintf(stderr, "text_tokenizer_bench: %s saw %zu fields in %zu records, expected %zu in %zu\n", name, found.fields, found.records, expected.fields, expected.records);
+    return false;
+}
+
+// quotes and separators inside them, checked on a line small enough to spell out
+static bool check_quoted()
+{
+    const char* text = "a,\"b,\"\"c\"\"\"\nd::e";
+    const char* expected[] = { "a", "b,\"\"c\"\"", "d::e" };
+    const bool ends[] = { false, true, true };
+
+    TextTokenizer fields = text_tokenizer_init_records(text, strlen(text), ",", '\n', '"');
+    StringView field;
+    int n = 0;
+
+    for (; text_tokenizer_next(&fields, &field); n++) {
+        if ((n >= 3) || !((field.length == strlen(expected[n])) && (memcmp(field.data, expected[n], field.length) == 0)) || (fields.record_end != ends[n])) {
+            fprintf(stderr, "text_tokenizer_bench: quoted field %d came out as \"%.*s\"\n", n, (int)field.length, field.data);
+            return false;
+        }
+    }
+
+    return n == 3;
+}
+
+int main()
+{
+    size_t length = 0;
+    DumpCounts expected;
+
+    char* dump = build_dump(&length, &expected);
+    if (!dump)
+        return 1;
+
+    printf("text_tokenizer: %.1f MB dump, %zu fields in %zu rows\n", length / (1024.0 * 1024.0), expected.fields, expected.records);
+
+    double start = bench_now();
+    const unsigned long long sum = bench_read(dump, length);
+    double seconds = bench_now() - start;
+    printf("  %-36s %10.2f ms %10.2f GB/s (%llx)\n", "read every byte", seconds * 1000.0, length / seconds / 1e9, sum & 0xF);
+
+    start = bench_now();
+    const DumpCounts nested = bench_nested(dump, length);
+    seconds = bench_now() - start;
+    printf("  %-36s %10.2f ms %10.2f GB/s %6.2f ns/field\n", "lines, then fields of each", seconds * 1000.0, length / seconds / 1e9, seconds * 1e9 / nested.fields);
+
+    start = bench_now();
+    const DumpCounts records = bench_records(dump, length);
+    seconds = bench_now() - start;
+    printf("  %-36s %10.2f ms %10.2f GB/s %6.2f ns/field\n", "fields and records in one pass", seconds * 1000.0, length / seconds / 1e9, seconds * 1e9 / records.fields);
+
+    const bool valid = counts_match("the nested pass", nested, expected) & counts_match("the single pass", records, expected) & check_quoted();
+
+    free(dump); dump = NULL;
+
+    return (valid) ? 0 : 1;
+}
@@ -0,0 +1,101 @@
+#include "bench.h"
+#include "../tile_fill.h"
+
+#define FILL_SIDE 2000 // cells per side of every fill, 4M cells
+#define HISTORY_BUDGET (512u * 1024 * 1024)
+
+static size_t count_cells(const TileGrid* grid, const TileCell cell)
+{
+    size_t count = 0;
+
+    for (int y = 0; y < FILL_SIDE; y++)
+        for (int x = 0; x < FILL_SIDE; x++) {
+            const TileCell found = tile_grid_get(grid, x, y);
+
+            count += (found.sheet == cell.sheet) && (found.sprite == cell.sprite);
+        }
+
+    return count;
+}
+
+// times the undo of the newest entry and checks it left no cell of 'cell' behind
+static bool bench_undo(const char* name, EditHistory* history, TileGrid* grid, const TileCell cell, const size_t cells)
+{
+    const double start = bench_now();
+    const bool undone = edit_history_undo(history, grid);
+    bench_report(name, bench_now() - start, cells);
+
+    if (!undone || count_cells(grid, cell)) {
+        fprintf(stderr, "tile_fill_bench: %s left filled cells behind\n", name);
+        return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    TileGrid grid = tile_grid_init();
+    EditHistory history = edit_history_init(HISTORY_BUDGET);
+
+    const TileCell floor = { .sheet = 1, .sprite = 0, .type = TILE_TYPE_FLOOR };
+    const TileCell wall = { .sheet = 2, .sprite = 0, .type = TILE_TYPE_WALL };
+    const size_t cells = (size_t)FILL_SIDE * FILL_SIDE;
+    int failures = 0;
+
+    printf("tile_fill: %dx%d regions, one frame is 16.67 ms\n", FILL_SIDE, FILL_SIDE);
+
+    // every chunk is new to the grid
+    double start = bench_now();
+    size_t filled = tile_fill_rect(&history, &grid, 0, 0, FILL_SIDE - 1, FILL_SIDE - 1, floor);
+    bench_report("rect fill, empty grid", bench_now() - start, filled);
+
+    if ((filled != cells) || (count_cells(&grid, floor) != cells)) {
+        fprintf(stderr, "tile_fill_bench: the rect fill wrote %zu cells\n", filled);
+        failures++;
+    }
+
+    failures += !bench_undo("undo rect fill", &history, &grid, floor, cells);
+
+    // the undo above released every chunk, the grid takes them back from its pool
+    start = bench_now();
+    filled = tile_fill_rect(&history, &grid, 0, 0, FILL_SIDE - 1, FILL_SIDE - 1, floor);
+    bench_report("rect fill, pooled chunks", bench_now() - start, filled);
+
+    // painting over the floor just written, every chunk exists already
+    start = bench_now();
+    filled = tile_fill_rect(&history, &grid, 0, 0, FILL_SIDE - 1, FILL_SIDE - 1, wall);
+    bench_report("rect fill, over cells", bench_now() - start, filled);
+
+    if ((filled != cells) || (count_cells(&grid, wall) != cells)) {
+        fprintf(stderr, "tile_fill_bench: the repaint wrote %zu cells\n", filled);
+        failures++;
+    }
+
+    failures += !bench_undo("undo repaint", &history, &grid, wall, cells);
+
+    // a floor walled in on every side, the flood stops at the ring of walls around it
+    tile_fill_rect(&history, &grid, -1, -1, FILL_SIDE, -1, wall);
+    tile_fill_rect(&history, &grid, -1, FILL_SIDE, FILL_SIDE, FILL_SIDE, wall);
+    tile_fill_rect(&history, &grid, -1, 0, -1, FILL_SIDE - 1, wall);
+    tile_fill_rect(&history, &grid, FILL_SIDE, 0, FILL_SIDE, FILL_SIDE - 1, wall);
+
+    const TileCell door = { .sheet = 3, .sprite = 0, .type = TILE_TYPE_DOOR };
+    FillBounds bounds = {0};
+
+    start = bench_now();
+    filled = tile_fill_flood(&history, &grid, FILL_SIDE / 2, FILL_SIDE / 2, door, TILE_FILL_MAX_CELLS, &bounds);
+    bench_report("flood fill", bench_now() - start, filled);
+
+    if ((filled != cells) || (count_cells(&grid, door) != cells) || (bounds.x0 != 0) || (bounds.y1 != FILL_SIDE - 1)) {
+        fprintf(stderr, "tile_fill_bench: the flood fill wrote %zu cells\n", filled);
+        failures++;
+    }
+
+    failures += !bench_undo("undo flood fill", &history, &grid, door, cells);
+
+    edit_history_free(&history);
+    tile_grid_free(&grid);
+
+    return (failures) ? 1 : 0;
+}
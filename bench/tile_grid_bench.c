@@ -0,0 +1,65 @@
+#include "bench.h"
+#include "../tile_grid.h"
+
+#define FILL_SIDE 3163       // cells per side of the filled square, about 10M cells
+#define RANDOM_LOOKUPS 10000000
+
+int main()
+{
+    TileGrid grid = tile_grid_init();
+
+    const TileCell cell = { .sheet = 1, .sprite = 0, .type = TILE_TYPE_FLOOR, .flags = 0 };
+
+    double start = bench_now();
+
+    for (int y = 0; y < FILL_SIDE; y++)
+        for (int x = 0; x < FILL_SIDE; x++)
+            tile_grid_set(&grid, x - (FILL_SIDE / 2), y - (FILL_SIDE / 2), cell);
+
+    printf("tile_grid: %zu cells in %zu chunks, %.2f bytes per cell\n", grid.cell_count, tile_grid_chunk_count(&grid), (double)tile_grid_memory_usage(&grid) / grid.cell_count);
+    bench_report("fill", bench_now() - start, grid.cell_count);
+
+    unsigned long long state = 0x9E3779B97F4A7C15ull;
+    size_t found = 0;
+
+    start = bench_now();
+
+    for (size_t i = 0; i < RANDOM_LOOKUPS; i++) {
+        const int x = (int)(bench_random(&state) % FILL_SIDE) - (FILL_SIDE / 2);
+        const int y = (int)(bench_random(&state) % FILL_SIDE) - (FILL_SIDE / 2);
+
+        found += !tile_cell_is_empty(tile_grid_get(&grid, x, y));
+    }
+
+    bench_report("random get", bench_now() - start, RANDOM_LOOKUPS);
+
+    if (found != RANDOM_LOOKUPS)
+        fprintf(stderr, "tile_grid_bench: %zu of %d lookups missed a filled cell\n", RANDOM_LOOKUPS - found, RANDOM_LOOKUPS);
+
+    // neighbouring reads, the way autotiling and flood fill look around a cell, mostly land in the chunk of the last lookup
+    size_t walked = 0;
+
+    start = bench_now();
+
+    for (int y = 0; y < FILL_SIDE; y++)
+        for (int x = 0; x < FILL_SIDE; x++)
+            walked += !tile_cell_is_empty(tile_grid_get(&grid, x - (FILL_SIDE / 2), y - (FILL_SIDE / 2)));
+
+    bench_report("row major get", bench_now() - start, walked);
+
+    if (walked != grid.cell_count)
+        fprintf(stderr, "tile_grid_bench: the row major walk saw %zu of %zu cells\n", walked, grid.cell_count);
+
+    start = bench_now();
+    const size_t cells = grid.cell_count;
+
+    for (int y = 0; y < FILL_SIDE; y++)
+        for (int x = 0; x < FILL_SIDE; x++)
+            tile_grid_erase(&grid, x - (FILL_SIDE / 2), y - (FILL_SIDE / 2));
+
+    bench_report("erase", bench_now() - start, cells);
+
+    tile_grid_free(&grid);
+
+    return ((found == RANDOM_LOOKUPS) && (walked == cells)) ? 0 : 1;
+}
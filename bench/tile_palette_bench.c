@@ -0,0 +1,214 @@
+#include "bench.h"
+#include "../tile_palette.h"
+#include "../list.h"
+
+#include <dirent.h>
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define SHEET_COUNT 256
+#define SHEET_SIDE 1024   // pixels, 4096 sprites per sheet at SPRITE_SIZE
+#define SPRITE_SIZE 16.0f
+#define RANDOM_LOOKUPS 10000000
+#define ASSETS_DIR "Assets"
+#define MAX_SHEETS 64
+
+// what the palette held per sprite before it was described per sheet, one malloc for it and one for its list node
+typedef struct
+{
+    Vector2 position;
+    Texture* texture;
+    unsigned long int id;
+} LegacySprite;
+
+typedef struct
+{
+    Image images[MAX_SHEETS];
+    Texture textures[MAX_SHEETS];
+    int count;
+} SheetSet;
+
+// bytes held by malloc, chunk headers included
+static size_t heap_bytes()
+{
+    return mallinfo2().uordblks;
+}
+
+static void load_sheets(SheetSet* set, const char* dir)
+{
+    DIR* handle = opendir(dir);
+    if (!handle)
+        return;
+
+    struct dirent* item;
+    while ((item = readdir(handle)) && (set->count < MAX_SHEETS)) {
+        if (item->d_name[0] == '.')
+            continue;
+
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/%s", dir, item->d_name);
+
+        struct stat info;
+        if (stat(path, &info) != 0)
+            continue;
+
+        if (S_ISDIR(info.st_mode)) {
+            load_sheets(set, path);
+            continue;
+        }
+
+        const char* dot = strrchr(item->d_name, '.');
+        if (!dot || (strcmp(dot, ".png") != 0))
+            continue;
+
+        Image image = LoadImage(path);
+        if (!IsImageReady(image))
+            continue;
+
+        ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+        set->images[set->count] = image;
+        set->textures[set->count] = (Texture){ .id = 0, .width = image.width, .height = image.height };
+        set->count++;
+    }
+
+    closedir(handle);
+}
+
+// the old import, one LegacySprite and one Node for every sprite_size cell of every sheet
+static bool bench_legacy_import(SheetSet* set)
+{
+    List palette = list_init();
+    size_t sprites = 0;
+
+    const size_t heap_before = heap_bytes();
+    const double start = bench_now();
+
+    for (int i = 0; i < set->count; i++) {
+        const Texture* texture = &set->textures[i];
+
+        for (float y = 0; y < texture->height; y += SPRITE_SIZE) {
+            for (float x = 0; x < texture->width; x += SPRITE_SIZE) {
+                LegacySprite* sprite = malloc(sizeof(LegacySprite));
+                if (!sprite)
+                    return false;
+
+                sprite->id = i + 1;
+                sprite->texture = &set->textures[i];
+                sprite->position = (Vector2){ x, y };
+                list_append(&palette, node_init(sprite, sizeof(LegacySprite), NULL, free));
+                sprites++;
+            }
+        }
+    }
+
+    const double seconds = bench_now() - start;
+    const size_t bytes = heap_bytes() - heap_before;
+
+    printf("tile_palette: %d sheets from %s/, per sprite list\n", set->count, ASSETS_DIR);
+    bench_report("import", seconds, sprites);
+    printf("  %zu sprites, %zu heap bytes, %.1f per sprite\n", sprites, bytes, (double)bytes / sprites);
+
+    list_free(&palette);
+
+    return palette.count == 0;
+}
+
+// the per sheet import, every cell classified from the pixels and empty ones dropped, or every cell listed without pixels
+static bool bench_sheet_import(SheetSet* set, const bool classify)
+{
+    TilePalette palette = tile_palette_init();
+    size_t cells = 0;
+
+    const size_t heap_before = heap_bytes();
+    const double start = bench_now();
+
+    for (int i = 0; i < set->count; i++) {
+        if (tile_palette_add_sheet(&palette, i + 1, &set->textures[i], (classify) ? &set->images[i] : NULL, SPRITE_SIZE) == 0)
+            return false;
+
+        cells += palette_sheet_cell_count(tile_palette_get_sheet(&palette, palette.sheet_count));
+    }
+
+    const double seconds = bench_now() - start;
+    const size_t bytes = heap_bytes() - heap_before;
+
+    printf("tile_palette: %d sheets from %s/, per sheet%s\n", set->count, ASSETS_DIR, (classify) ? ", classifying pixels" : "");
+    bench_report("import", seconds, cells);
+    printf("  %zu cells, %zu listed sprites, %zu heap bytes, %.1f per cell\n", cells, palette.sprite_count, bytes, (double)bytes / cells);
+
+    tile_palette_free(&palette);
+
+    return true;
+}
+
+int main()
+{
+    SetTraceLogLevel(LOG_WARNING);
+
+    SheetSet* set = calloc(1, sizeof(SheetSet));
+    if (!set) {
+        fprintf(stderr, "tile_palette_bench: calloc returned null\n");
+        return 1;
+    }
+
+    load_sheets(set, ASSETS_DIR);
+
+    if ((set->count == 0) || !bench_legacy_import(set) || !bench_sheet_import(set, false) || !bench_sheet_import(set, true)) {
+        fprintf(stderr, "tile_palette_bench: failed to import the sheets in %s/\n", ASSETS_DIR);
+        return 1;
+    }
+
+    for (int i = 0; i < set->count; i++)
+        UnloadImage(set->images[i]);
+
+    free(set);
+
+    TilePalette palette = tile_palette_init();
+
+    // the palette only reads the size of a texture, no GPU is needed
+    Texture* textures = calloc(SHEET_COUNT, sizeof(Texture));
+    if (!textures) {
+        fprintf(stderr, "tile_palette_bench: calloc returned null\n");
+        return 1;
+    }
+
+    double start = bench_now();
+
+    for (int i = 0; i < SHEET_COUNT; i++) {
+        textures[i] = (Texture){ .id = 0, .width = SHEET_SIDE, .height = SHEET_SIDE };
+
+        // without an image every cell is listed, the per sheet cost is what is measured here
+        if (tile_palette_add_sheet(&palette, i + 1, &textures[i], NULL, SPRITE_SIZE) == 0) {
+            fprintf(stderr, "tile_palette_bench: failed to add sheet %d\n", i);
+            return 1;
+        }
+    }
+
+    const double add_seconds = bench_now() - start;
+
+    printf("tile_palette: %zu sheets, %zu sprites\n", palette.sheet_count, palette.sprite_count);
+    bench_report("add sheet", add_seconds, palette.sheet_count);
+    bench_report("add sheet, per sprite", add_seconds, palette.sprite_count);
+
+    unsigned long long state = 0x2545F4914F6CDD1Dull;
+    size_t located = 0;
+
+    start = bench_now();
+
+    for (size_t i = 0; i < RANDOM_LOOKUPS; i++) {
+        unsigned short slot;
+        int cell;
+
+        located += tile_palette_locate(&palette, bench_random(&state) % palette.sprite_count, &slot, &cell);
+    }
+
+    bench_report("locate", bench_now() - start, RANDOM_LOOKUPS);
+
+    tile_palette_free(&palette);
+    free(textures);
+
+    return (located == RANDOM_LOOKUPS) ? 0 : 1;
+}
@@ -0,0 +1,183 @@
+#include "bench.h"
+#include "../world_stream.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define WORLD_CHUNKS_X 400 // a long strip, panned along from one end to the other
+#define WORLD_CHUNKS_Y 32
+#define VIEW_CHUNKS_X 40   // about what a 1280x768 view at 1 px per cell shows
+#define VIEW_CHUNKS_Y 24
+#define FRAMES_PER_CHUNK 2 // the camera moves 16 cells a frame
+#define FRAME_SLEEP_US 4000 // what the rest of a frame would take, the readers run meanwhile
+#define STREAM_BUDGET (16u << 20)
+#define MAP_PATH "bench/bin/world_stream" MAP_FILE_EXTENSION
+
+static TileCell expected_cell(const int x, const int y)
+{
+    return (TileCell){ .sheet = 1, .sprite = ((x / 5) + (y / 3) * 7) % 48, .type = TILE_TYPE_FLOOR, .flags = 0 };
+}
+
+static bool build_map(MapFileStats* stats)
+{
+    TileGrid grid = tile_grid_init();
+
+    // cells need a live slot to be saved with, the palette only reads the texture's size
+    TilePalette palette = tile_palette_init();
+    Texture texture = { .id = 0, .width = 256, .height = 256 };
+    AssetCache cache = asset_cache_init(0);
+
+    bool built = tile_palette_add_sheet(&palette, 1, &texture, NULL, 16.0f) != 0;
+
+    unsigned long long mask[TILE_CHUNK_WORDS];
+    memset(mask, 0xFF, sizeof(mask));
+
+    TileCell cells[TILE_CHUNK_CELLS];
+
+    for (int cy = 0; built && (cy < WORLD_CHUNKS_Y); cy++) {
+        for (int cx = 0; built && (cx < WORLD_CHUNKS_X); cx++) {
+            for (int c = 0; c < TILE_CHUNK_CELLS; c++)
+                cells[c] = expected_cell((cx * TILE_CHUNK_SIZE) + (c % TILE_CHUNK_SIZE), (cy * TILE_CHUNK_SIZE) + (c / TILE_CHUNK_SIZE));
+
+            built = tile_grid_write_masked(&grid, cx, cy, mask, cells);
+        }
+    }
+
+    built = built && map_file_save(MAP_PATH, &grid, &palette, &cache, (Vector2){0,0}, NULL, stats);
+
+    tile_grid_free(&grid);
+    tile_palette_free(&palette);
+    asset_cache_free(&cache);
+
+    return built;
+}
+
+// every chunk the window covers is in the grid and holds what was saved
+static bool window_loaded(const TileGrid* grid, const int cx0, const int cy0, const int cx1, const int cy1)
+{
+    for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+            const TileChunk* chunk = tile_grid_find_chunk(grid, cx, cy);
+            if (!chunk || (chunk->count != TILE_CHUNK_CELLS))
+                return false;
+
+            for (int c = 0; c < TILE_CHUNK_CELLS; c += 97) {
+                const TileCell cell = expected_cell((cx * TILE_CHUNK_SIZE) + (c % TILE_CHUNK_SIZE), (cy * TILE_CHUNK_SIZE) + (c / TILE_CHUNK_SIZE));
+
+                if (memcmp(&chunk->cells[c], &cell, sizeof(cell)) != 0)
+                    return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// updates until nothing is in flight, a camera standing still ends up with its whole window loaded
+static void settle(WorldStream* stream, TileGrid* grid, const int cx0, const int cy0, const int cx1, const int cy1)
+{
+    do {
+        usleep(FRAME_SLEEP_US);
+        world_stream_update(stream, grid, cx0, cy0, cx1, cy1);
+    } while (stream->in_flight > 0);
+}
+
+int main()
+{
+    MapFileStats stats;
+    if (!build_map(&stats)) {
+        fprintf(stderr, "world_stream_bench: failed to save \"%s\"\n", MAP_PATH);
+        return 1;
+    }
+
+    printf("world_stream: %d chunks, %.1f MB raw, %.1f MB budget\n", WORLD_CHUNKS_X * WORLD_CHUNKS_Y, stats.raw_bytes / (1024.0 * 1024.0), STREAM_BUDGET / (1024.0 * 1024.0));
+
+    int failures = 0;
+
+    // every chunk at once with nothing evicted, the readers' throughput
+    TileGrid grid = tile_grid_init();
+    WorldStream* stream = world_stream_open(MAP_PATH, SIZE_MAX, NULL, NULL);
+    if (!stream) {
+        fprintf(stderr, "world_stream_bench: failed to open \"%s\"\n", MAP_PATH);
+        return 1;
+    }
+
+    double start = bench_now();
+
+    while (stream->loaded_chunks < stream->map.chunk_count)
+        world_stream_update(stream, &grid, 0, 0, WORLD_CHUNKS_X - 1, WORLD_CHUNKS_Y - 1);
+
+    double seconds = bench_now() - start;
+
+    char name[64];
+    snprintf(name, sizeof(name), "load every chunk on %d readers", stream->thread_count);
+    printf("  %-36s %10.2f ms %10.1f MB/s raw\n", name, seconds * 1000.0, stats.raw_bytes / (1024.0 * 1024.0) / seconds);
+
+    if (!window_loaded(&grid, 0, 0, WORLD_CHUNKS_X - 1, WORLD_CHUNKS_Y - 1)) {
+        fprintf(stderr, "world_stream_bench: the loaded map does not match the saved one\n");
+        failures++;
+    }
+
+    world_stream_close(stream);
+    tile_grid_free(&grid);
+
+    // a pan from one end of the strip to the other under the budget
+    grid = tile_grid_init();
+    stream = world_stream_open(MAP_PATH, STREAM_BUDGET, NULL, NULL);
+    if (!stream) {
+        fprintf(stderr, "world_stream_bench: failed to open \"%s\"\n", MAP_PATH);
+        return 1;
+    }
+
+    const int cy0 = (WORLD_CHUNKS_Y - VIEW_CHUNKS_Y) / 2, cy1 = cy0 + VIEW_CHUNKS_Y - 1;
+    const int frames = (WORLD_CHUNKS_X - VIEW_CHUNKS_X) * FRAMES_PER_CHUNK;
+
+    settle(stream, &grid, 0, cy0, VIEW_CHUNKS_X - 1, cy1);
+
+    double worst = 0.0, total = 0.0;
+    size_t peak = 0;
+    size_t quarters[4] = {0};
+
+    for (int frame = 0; frame < frames; frame++) {
+        const int cx0 = frame / FRAMES_PER_CHUNK;
+
+        start = bench_now();
+        world_stream_update(stream, &grid, cx0, cy0, cx0 + VIEW_CHUNKS_X - 1, cy1);
+        seconds = bench_now() - start;
+
+        total += seconds;
+        worst = (seconds > worst) ? seconds : worst;
+
+        const size_t usage = tile_grid_memory_usage(&grid);
+        peak = (usage > peak) ? usage : peak;
+        quarters[(frame * 4) / frames] = usage;
+
+        usleep(FRAME_SLEEP_US);
+    }
+
+    const int last = WORLD_CHUNKS_X - VIEW_CHUNKS_X;
+    settle(stream, &grid, last, cy0, last + VIEW_CHUNKS_X - 1, cy1);
+
+    printf("  %-36s %10.2f ms worst, %.3f ms average over %d frames\n", "update while panning", worst * 1000.0, total * 1000.0 / frames, frames);
+    printf("  resident at each quarter of the pan: %.1f, %.1f, %.1f, %.1f MB, peak %.1f MB\n", quarters[0] / (1024.0 * 1024.0), quarters[1] / (1024.0 * 1024.0), quarters[2] / (1024.0 * 1024.0), quarters[3] / (1024.0 * 1024.0), peak / (1024.0 * 1024.0));
+    printf("  %zu chunks loaded, %zu evicted\n", stream->loaded_chunks, stream->evicted_chunks);
+
+    // eviction runs after a frame's loads land, so one frame's worth of loads can sit above the budget
+    if (peak > (STREAM_BUDGET + (WORLD_STREAM_QUEUE_SIZE * sizeof(TileChunk)))) {
+        fprintf(stderr, "world_stream_bench: resident memory grew to %zu bytes\n", peak);
+        failures++;
+    }
+
+    if (!window_loaded(&grid, last, cy0, last + VIEW_CHUNKS_X - 1, cy1)) {
+        fprintf(stderr, "world_stream_bench: the window at the end of the pan is not loaded\n");
+        failures++;
+    }
+
+    world_stream_close(stream);
+    tile_grid_free(&grid);
+    remove(MAP_PATH);
+
+    return (failures) ? 1 : 0;
+}
@@ -0,0 +1,278 @@
+#ifndef CONTAINERS_H
+#define CONTAINERS_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+// type specialized contiguous containers, generated by macros in the header only style of uthash:
+//   VECTOR_DEFINE(IntVector, int_vector, int) declares IntVector and int_vector_init/push/at/...
+// element access is bounds checked through assert, so NDEBUG builds pay nothing for it
+// growth doubles, failed allocations leave the container as it was and return false or null
+
+#define CONTAINER_MIN_CAPACITY 8
+
+#define CONTAINER_CHECK(cond) assert(cond)
+
+// dynamic array
+#define VECTOR_DEFINE(type_name, prefix, type)                                                  \
+typedef struct                                                                                  \
+{                                                                                               \
+    type* items;     /* allocated */                                                            \
+    size_t count;                                                                               \
+    size_t capacity;                                                                            \
+} type_name;                                                                                    \
+                                                                                                \
+static inline type_name prefix##_init(void)                                                     \
+{                                                                                               \
+    return (type_name) { .items = NULL, .count = 0, .capacity = 0 };                            \
+}                                                                                               \
+                                                                                                \
+static inline void prefix##_free(type_name* vector)                                             \
+{                                                                                               \
+    if (!vector)                                                                                \
+        return;                                                                                 \
+                                                                                                \
+    if (vector->items) {                                                                        \
+        free(vector->items); vector->items = NULL;                                              \
+    }                                                                                           \
+                                                                                                \
+    vector->count = vector->capacity = 0;                                                       \
+}                                                                                               \
+                                                                                                \
+static inline bool prefix##_reserve(type_name* vector, const size_t capacity)                   \
+{                                                                                               \
+    if (capacity <= vector->capacity)                                                           \
+        return true;                                                                            \
+                                                                                                \
+    size_t grown = (vector->capacity) ? (vector->capacity * 2) : CONTAINER_MIN_CAPACITY;        \
+    while (grown < capacity)                                                                    \
+        grown *= 2;                                                                             \
+                                                                                                \
+    type* items = realloc(vector->items, sizeof(type) * grown);                                 \
+    if (!items)                                                                                 \
+        return false;                                                                           \
+                                                                                                \
+    vector->items = items;                                                                      \
+    vector->capacity = grown;                                                                   \
+    return true;                                                                                \
+}                                                                                               \
+                                                                                                \
+/* slot for a new last element, left uninitialized */                                           \
+static inline type* prefix##_emplace(type_name* vector)                                         \
+{                                                                                               \
+    if (!prefix##_reserve(vector, vector->count + 1))                                           \
+        return NULL;                                                                            \
+                                                                                                \
+    return &vector->items[vector->count++];                                                     \
+}                                                                                               \
+                                                                                                \
+static inline bool prefix##_push(type_name* vector, const type value)                           \
+{                                                                                               \
+    type* slot = prefix##_emplace(vector);                                                      \
+    if (!slot)                                                                                  \
+        return false;                                                                           \
+                                                                                                \
+    (*slot) = value;                                                                            \
+    return true;                                                                                \
+}                                                                                               \
+                                                                                                \
+static inline type prefix##_pop(type_name* vector)                                              \
+{                                                                                               \
+    CONTAINER_CHECK(vector->count > 0);                                                         \
+    return vector->items[--vector->count];                                                      \
+}                                                                                               \
+                                                                                                \
+static inline type* prefix##_at(const type_name* vector, const size_t index)                    \
+{                                                                                               \
+    CONTAINER_CHECK(index < vector->count);                                                     \
+    return &vector->items[index];                                                               \
+}                                                                                               \
+                                                                                                \
+/* order is not kept, the last element fills the hole */                                        \
+static inline void prefix##_remove_swap(type_name* vector, const size_t index)                  \
+{                                                                                               \
+    CONTAINER_CHECK(index < vector->count);                                                     \
+    vector->items[index] = vector->items[--vector->count];                                      \
+}                                                                                               \
+                                                                                                \
+static inline void prefix##_clear(type_name* vector)                                            \
+{                                                                                               \
+    vector->count = 0;                                                                          \
+}
+
+// growable ring buffer, pushed at the back and popped from the front, capacity stays a power of two
+#define RING_DEFINE(type_name, prefix, type)                                                    \
+typedef struct                                                                                  \
+{                                                                                               \
+    type* items;     /* allocated */                                                            \
+    size_t head;     /* index of the front element */                                           \
+    size_t count;                                                                               \
+    size_t capacity;                                                                            \
+} type_name;                                                                                    \
+                                                                                                \
+static inline type_name prefix##_init(void)                                                     \
+{                                                                                               \
+    return (type_name) { .items = NULL, .head = 0, .count = 0, .capacity = 0 };                 \
+}                                                                                               \
+                                                                                                \
+static inline void prefix##_free(type_name* ring)                                               \
+{                                                                                               \
+    if (!ring)                                                                                  \
+        return;                                                                                 \
+                                                                                                \
+    if (ring->items) {                                                                          \
+        free(ring->items); ring->items = NULL;                                                  \
+    }                                                                                           \
+                                                                                                \
+    ring->head = ring->count = ring->capacity = 0;                                              \
+}                                                                                               \
+                                                                                                \
+/* the wrapped part moves behind the old end, so the elements stay in order */                  \
+static inline bool prefix##_grow(type_name* ring)                                               \
+{                                                                                               \
+    const size_t capacity = (ring->capacity) ? (ring->capacity * 2) : CONTAINER_MIN_CAPACITY;   \
+                                                                                                \
+    type* items = realloc(ring->items, sizeof(type) * capacity);                                \
+    if (!items)                                                                                 \
+        return false;                                                                           \
+                                                                                                \
+    if ((ring->head + ring->count) > ring->capacity)                                            \
+        memcpy(&items[ring->capacity], items, sizeof(type) * ((ring->head + ring->count) - ring->capacity)); \
+                                                                                                \
+    ring->items = items;                                                                        \
+    ring->capacity = capacity;                                                                  \
+    return true;                                                                                \
+}                                                                                               \
+                                                                                                \
+static inline bool prefix##_push(type_name* ring, const type value)                             \
+{                                                                                               \
+    if ((ring->count == ring->capacity) && !prefix##_grow(ring))                                \
+        return false;                                                                           \
+                                                                                                \
+    ring->items[(ring->head + ring->count) & (ring->capacity - 1)] = value;                     \
+    ring->count++;                                                                              \
+    return true;                                                                                \
+}                                                                                               \
+                                                                                                \
+static inline bool prefix##_pop(type_name* ring, type* value)                                   \
+{                                                                                               \
+    if (ring->count == 0)                                                                       \
+        return false;                                                                           \
+                                                                                                \
+    if (value)                                                                                  \
+        (*value) = ring->items[ring->head];                                                     \
+                                                                                                \
+    ring->head = (ring->head + 1) & (ring->capacity - 1);                                       \
+    ring->count--;                                                                              \
+    return true;                                                                                \
+}                                                                                               \
+                                                                                                \
+/* index 0 is the front */                                                                      \
+static inline type* prefix##_at(const type_name* ring, const size_t index)                      \
+{                                                                                               \
+    CONTAINER_CHECK(index < ring->count);                                                       \
+    return &ring->items[(ring->head + index) & (ring->capacity - 1)];                           \
+}                                                                                               \
+                                                                                                \
+static inline void prefix##_clear(type_name* ring)                                              \
+{                                                                                               \
+    ring->head = ring->count = 0;                                                               \
+}
+
+// dynamic array holding its first 'inline_count' elements in the struct itself, the heap is only touched past that
+// items stays null until it spills, so the struct can still be returned and copied by value
+#define SMALL_VECTOR_DEFINE(type_name, prefix, type, inline_count)                              \
+typedef struct                                                                                  \
+{                                                                                               \
+    type* items;     /* allocated once spilled, null while the inline storage suffices */       \
+    size_t count;                                                                               \
+    size_t capacity;                                                                            \
+    type storage[inline_count];                                                                 \
+} type_name;                                                                                    \
+                                                                                                \
+/* growth doubles the capacity, it would never leave 0 */                                       \
+_Static_assert((inline_count) > 0, #type_name " needs at least one inline element");            \
+                                                                                                \
+static inline type_name prefix##_init(void)                                                     \
+{                                                                                               \
+    return (type_name) { .items = NULL, .count = 0, .capacity = (inline_count) };               \
+}                                                                                               \
+                                                                                                \
+static inline void prefix##_free(type_name* vector)                                             \
+{                                                                                               \
+    if (!vector)                                                                                \
+        return;                                                                                 \
+                                                                                                \
+    if (vector->items) {                                                                        \
+        free(vector->items); vector->items = NULL;                                              \
+    }                                                                                           \
+                                                                                                \
+    vector->count = 0;                                                                          \
+    vector->capacity = (inline_count);                                                          \
+}                                                                                               \
+                                                                                                \
+static inline type* prefix##_data(type_name* vector)                                            \
+{                                                                                               \
+    return (vector->items) ? vector->items : vector->storage;                                   \
+}                                                                                               \
+                                                                                                \
+static inline bool prefix##_reserve(type_name* vector, const size_t capacity)                   \
+{                                                                                               \
+    if (capacity <= vector->capacity)                                                           \
+        return true;                                                                            \
+                                                                                                \
+    size_t grown = vector->capacity * 2;                                                        \
+    while (grown < capacity)                                                                    \
+        grown *= 2;                                                                             \
+                                                                                                \
+    type* items = realloc(vector->items, sizeof(type) * grown);                                 \
+    if (!items)                                                                                 \
+        return false;                                                                           \
+                                                                                                \
+    if (!vector->items)                                                                         \
+        memcpy(items, vector->storage, sizeof(type) * vector->count);                           \
+                                                                                                \
+    vector->items = items;                                                                      \
+    vector->capacity = grown;                                                                   \
+    return true;                                                                                \
+}                                                                                               \
+                                                                                                \
+static inline type* prefix##_emplace(type_name* vector)                                         \
+{                                                                                               \
+    if (!prefix##_reserve(vector, vector->count + 1))                                           \
+        return NULL;                                                                            \
+                                                                                                \
+    return &prefix##_data(vector)[vector->count++];                                             \
+}                                                                                               \
+                                                                                                \
+static inline bool prefix##_push(type_name* vector, const type value)                           \
+{                                                                                               \
+    type* slot = prefix##_emplace(vector);                                                      \
+    if (!slot)                                                                                  \
+        return false;                                                                           \
+                                                                                                \
+    (*slot) = value;                                                                            \
+    return true;                                                                                \
+}                                                                                               \
+                                                                                                \
+static inline type prefix##_pop(type_name* vector)                                              \
+{                                                                                               \
+    CONTAINER_CHECK(vector->count > 0);                                                         \
+    return prefix##_data(vector)[--vector->count];                                              \
+}                                                                                               \
+                                                                                                \
+static inline type* prefix##_at(type_name* vector, const size_t index)                          \
+{                                                                                               \
+    CONTAINER_CHECK(index < vector->count);                                                     \
+    return &prefix##_data(vector)[index];                                                       \
+}                                                                                               \
+                                                                                                \
+static inline void prefix##_clear(type_name* vector)                                            \
+{                                                                                               \
+    vector->count = 0;                                                                          \
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,775 @@
+#include "edit_history.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// the implementations are compiled into raylib, only the declarations are needed here
+#include "external/sdefl.h"
+#include "external/sinfl.h"
+
+#define EDIT_HISTORY_COMPRESSION_LEVEL SDEFL_LVL_MIN // deltas are runs of the same few cells, the fastest level already does well
+
+typedef enum
+{
+    EDIT_DELTA_UNIFORM_BEFORE = 1 << 0, // a single before value shared by every cell
+    EDIT_DELTA_UNIFORM_AFTER = 1 << 1,  // a single after value shared by every cell
+} EditDeltaFlags;
+
+typedef struct
+{
+    int cx, cy;
+    unsigned int count;    // set bits in mask
+    unsigned int flags;    // EditDeltaFlags
+    unsigned long long mask[TILE_CHUNK_WORDS];
+} EditDeltaHeader;
+
+static size_t edit_delta_before_count(const unsigned int count, const unsigned int flags)
+{
+    return (flags & EDIT_DELTA_UNIFORM_BEFORE) ? 1 : count;
+}
+
+static size_t edit_delta_after_count(const unsigned int count, const unsigned int flags)
+{
+    return (flags & EDIT_DELTA_UNIFORM_AFTER) ? 1 : count;
+}
+
+// values of one delta are padded so the next header stays aligned
+static size_t edit_delta_size(const unsigned int count, const unsigned int flags)
+{
+    const size_t values = sizeof(TileCell) * (edit_delta_before_count(count, flags) + edit_delta_after_count(count, flags));
+
+    return sizeof(EditDeltaHeader) + ((values + 7) & ~(size_t)7);
+}
+
+static const TileCell* edit_delta_before(const EditDeltaHeader* header)
+{
+    return (const TileCell*)(header + 1);
+}
+
+static const TileCell* edit_delta_after(const EditDeltaHeader* header)
+{
+    return edit_delta_before(header) + edit_delta_before_count(header->count, header->flags);
+}
+
+_Static_assert(sizeof(TileCell) == 6, "edit_history: a cell is compared as a 4 and a 2 byte word");
+
+// two word compares rather than four field compares, capture loops run this once or twice per cell
+static bool edit_cell_equal(const TileCell a, const TileCell b)
+{
+    unsigned int a_low, b_low;
+    unsigned short a_high, b_high;
+
+    memcpy(&a_low, &a, 4); memcpy(&a_high, (const unsigned char*)&a + 4, 2);
+    memcpy(&b_low, &b, 4); memcpy(&b_high, (const unsigned char*)&b + 4, 2);
+
+    return (a_low == b_low) & (a_high == b_high);
+}
+
+static void edit_entry_free(EditEntry* entry)
+{
+    if (!entry)
+        return;
+
+    if (entry->data) {
+        free(entry->data); entry->data = NULL;
+    }
+
+    entry->size = 0;
+    entry->raw_size = 0;
+    entry->delta_count = 0;
+    entry->cell_count = 0;
+    entry->compressed = false;
+}
+
+// throws away whatever the open entry recorded so far
+static void edit_history_drop_open(EditHistory* history)
+{
+    EditStaging* current, *tmp;
+
+    HASH_ITER(hh, history->staging, current, tmp) {
+        HASH_DEL(history->staging, current);
+        free(current);
+    }
+
+    history->staging = NULL;
+    history->last = NULL;
+
+    if (history->pending) {
+        free(history->pending); history->pending = NULL;
+    }
+
+    history->pending_size = 0;
+    history->pending_capacity = 0;
+    history->pending_deltas = 0;
+    history->pending_cells = 0;
+}
+
+EditHistory edit_history_init(const size_t budget)
+{
+    return (EditHistory) {
+        .entries = NULL,
+        .count = 0,
+        .capacity = 0,
+        .cursor = 0,
+        .bytes = 0,
+        .budget = budget,
+        .staging = NULL,
+        .last = NULL,
+        .pending = NULL,
+        .pending_size = 0,
+        .pending_capacity = 0,
+        .pending_deltas = 0,
+        .pending_cells = 0,
+        .open = false,
+        .mergeable = false,
+        .closed_at = 0.0,
+        .deflate_state = NULL,
+    };
+}
+
+void edit_history_clear(EditHistory* history)
+{
+    if (!history)
+        return;
+
+    edit_history_drop_open(history);
+
+    for (size_t i = 0; i < history->count; i++)
+        edit_entry_free(&history->entries[i]);
+
+    history->count = 0;
+    history->cursor = 0;
+    history->bytes = 0;
+    history->open = false;
+    history->mergeable = false;
+}
+
+void edit_history_free(EditHistory* history)
+{
+    if (!history)
+        return;
+
+    edit_history_clear(history);
+
+    if (history->entries) {
+        free(history->entries); history->entries = NULL;
+    }
+
+    if (history->deflate_state) {
+        free(history->deflate_state); history->deflate_state = NULL;
+    }
+
+    history->capacity = 0;
+}
+
+static void edit_staging_record(EditStaging* staging, const int local, const TileCell before, const TileCell after)
+{
+    const unsigned long long bit = 1ULL << (local & 63);
+
+    if (!(staging->mask[local / 64] & bit)) {
+        staging->mask[local / 64] |= bit;
+        staging->before[local] = before;
+    }
+
+    staging->after[local] = after;
+}
+
+static EditStaging* edit_staging_get(EditHistory* history, const int cx, const int cy)
+{
+    if (history->last && (history->last->cx == cx) && (history->last->cy == cy))
+        return history->last;
+
+    EditStaging* staging = NULL;
+    const long long key = tile_chunk_key(cx, cy);
+
+    HASH_FIND(hh, history->staging, &key, sizeof(key), staging);
+
+    if (!staging) {
+        // malloc rather than calloc, only the mask has to start out clear
+        staging = malloc(sizeof(EditStaging));
+        if (!staging) {
+            fprintf(stderr, "edit_staging_get: malloc returned null\n");
+            return NULL;
+        }
+
+        staging->key = key;
+        staging->cx = cx;
+        staging->cy = cy;
+        memset(staging->mask, 0, sizeof(staging->mask));
+
+        HASH_ADD(hh, history->staging, key, sizeof(staging->key), staging);
+    }
+
+    history->last = staging;
+
+    return staging;
+}
+
+// the deflated form is only ever read back by undo, a failed compression just leaves the entry raw
+static void edit_entry_compress(EditHistory* history, EditEntry* entry)
+{
+    if (entry->compressed || (entry->raw_size > INT_MAX))
+        return;
+
+    // almost 1MB, kept for the next entry that ages out
+    if (!history->deflate_state) {
+        history->deflate_state = calloc(1, sizeof(struct sdefl));
+        if (!history->deflate_state) {
+            fprintf(stderr, "edit_entry_compress: calloc returned null\n");
+            return;
+        }
+    }
+
+    unsigned char* packed = malloc(sdefl_bound(entry->raw_size));
+    if (!packed) {
+        fprintf(stderr, "edit_entry_compress: malloc returned null\n");
+        return;
+    }
+
+    const int size = sdeflate(history->deflate_state, packed, entry->data, entry->raw_size, EDIT_HISTORY_COMPRESSION_LEVEL);
+
+    if ((size <= 0) || ((size_t)size >= entry->raw_size)) {
+        free(packed); packed = NULL;
+        return;
+    }
+
+    // shrinking can not fail in practice, keeping the larger block is harmless if it does
+    unsigned char* shrunk = realloc(packed, size);
+    if (shrunk)
+        packed = shrunk;
+
+    free(entry->data);
+
+    history->bytes -= entry->size;
+    history->bytes += size;
+
+    entry->data = packed;
+    entry->size = size;
+    entry->compressed = true;
+}
+
+static void edit_history_drop_oldest(EditHistory* history)
+{
+    history->bytes -= history->entries[0].size;
+    edit_entry_free(&history->entries[0]);
+
+    memmove(history->entries, history->entries + 1, sizeof(EditEntry) * (history->count - 1));
+
+    history->count--;
+
+    if (history->cursor > 0)
+        history->cursor--;
+}
+
+static bool edit_history_push(EditHistory* history, const EditEntry entry)
+{
+    // a new edit forks the timeline, whatever could be redone is gone
+    while (history->count > history->cursor) {
+        history->count--;
+        history->bytes -= history->entries[history->count].size;
+        edit_entry_free(&history->entries[history->count]);
+    }
+
+    if (history->count == history->capacity) {
+        const size_t capacity = (history->capacity) ? (history->capacity * 2) : 64;
+
+        EditEntry* entries = realloc(history->entries, sizeof(EditEntry) * capacity);
+        if (!entries) {
+            fprintf(stderr, "edit_history_push: realloc returned null\n");
+            return false;
+        }
+
+        history->entries = entries;
+        history->capacity = capacity;
+    }
+
+    history->entries[history->count++] = entry;
+    history->cursor = history->count;
+    history->bytes += entry.size;
+
+    if (history->count > EDIT_HISTORY_HOT_ENTRIES)
+        edit_entry_compress(history, &history->entries[history->count - 1 - EDIT_HISTORY_HOT_ENTRIES]);
+
+    // the newest entry stays even if it alone is over budget, the edit that was just made can always be undone
+    while ((history->bytes > history->budget) && (history->count > 1))
+        edit_history_drop_oldest(history);
+
+    return true;
+}
+
+// turns the newest entry back into staging so the stroke that follows it extends it
+static bool edit_history_reopen(EditHistory* history)
+{
+    EditEntry* entry = &history->entries[history->count - 1];
+    const unsigned char* cursor = entry->data;
+    const unsigned char* end = entry->data + entry->raw_size;
+
+    while (cursor < end) {
+        const EditDeltaHeader* header = (const EditDeltaHeader*) cursor;
+        const TileCell* before = edit_delta_before(header);
+        const TileCell* after = edit_delta_after(header);
+
+        EditStaging* staging = edit_staging_get(history, header->cx, header->cy);
+        if (!staging) {
+            edit_history_drop_open(history);
+            return false;
+        }
+
+        const bool uniform_before = header->flags & EDIT_DELTA_UNIFORM_BEFORE;
+        const bool uniform_after = header->flags & EDIT_DELTA_UNIFORM_AFTER;
+
+        size_t n = 0;
+
+        // a chunk can show up in more than one delta, the first one holds its oldest values
+        for (int w = 0; w < TILE_CHUNK_WORDS; w++) {
+            for (unsigned long long bits = header->mask[w]; bits; bits &= bits - 1, n++) {
+                const int local = (w * 64) + __builtin_ctzll(bits);
+
+                edit_staging_record(staging, local, before[(uniform_before) ? 0 : n], after[(uniform_after) ? 0 : n]);
+            }
+        }
+
+        cursor += edit_delta_size(header->count, header->flags);
+    }
+
+    history->bytes -= entry->size;
+    edit_entry_free(entry);
+
+    history->count--;
+    history->cursor = history->count;
+
+    return true;
+}
+
+void edit_history_begin(EditHistory* history, const double time, const bool merge)
+{
+    if (!history || history->open)
+        return;
+
+    const bool extend = merge && history->mergeable && (history->count > 0) && (history->cursor == history->count)
+        && !history->entries[history->count - 1].compressed && ((time - history->closed_at) <= EDIT_HISTORY_MERGE_SECONDS);
+
+    if (extend && !edit_history_reopen(history))
+        fprintf(stderr, "edit_history_begin: could not extend the last entry\n");
+
+    history->open = true;
+    history->mergeable = merge;
+}
+
+bool edit_history_set(EditHistory* history, TileGrid* grid, const int x, const int y, const TileCell cell)
+{
+    if (!history || !grid)
+        return false;
+
+    const TileCell before = tile_grid_get(grid, x, y);
+    if (edit_cell_equal(before, cell))
+        return true;
+
+    // a write outside begin and end is an entry of its own
+    const bool implicit = !history->open;
+    if (implicit)
+        edit_history_begin(history, history->closed_at, false);
+
+    EditStaging* staging = edit_staging_get(history, tile_chunk_coord(x), tile_chunk_coord(y));
+
+    bool written = false;
+
+    if (staging) {
+        if (tile_cell_is_empty(cell)) {
+            tile_grid_erase(grid, x, y);
+            written = true;
+        }
+        else
+            written = tile_grid_set(grid, x, y, cell);
+    }
+
+    if (written)
+        edit_staging_record(staging, ((y & (TILE_CHUNK_SIZE - 1)) * TILE_CHUNK_SIZE) + (x & (TILE_CHUNK_SIZE - 1)), before, cell);
+
+    if (implicit)
+        edit_history_end(history, history->closed_at);
+
+    return written;
+}
+
+static bool edit_history_reserve(EditHistory* history, const size_t extra)
+{
+    if ((history->pending_size + extra) <= history->pending_capacity)
+        return true;
+
+    size_t capacity = (history->pending_capacity) ? history->pending_capacity : 4096;
+    while (capacity < (history->pending_size + extra))
+        capacity *= 2;
+
+    unsigned char* pending = realloc(history->pending, capacity);
+    if (!pending) {
+        fprintf(stderr, "edit_history_reserve: realloc returned null\n");
+        return false;
+    }
+
+    history->pending = pending;
+    history->pending_capacity = capacity;
+
+    return true;
+}
+
+// a chunk the open entry has not staged is serialized straight away, without going through per cell staging
+// 'cells' holds one value per set bit of mask, or a single value for all of them when 'uniform'
+static bool edit_history_write_chunk(EditHistory* history, TileGrid* grid, const int cx, const int cy, const unsigned long long* mask, const TileCell* cells, const bool uniform)
+{
+    const TileChunk* chunk = tile_grid_find_chunk(grid, cx, cy);
+
+    EditStaging* staging = NULL;
+    const long long key = tile_chunk_key(cx, cy);
+
+    HASH_FIND(hh, history->staging, &key, sizeof(key), staging);
+
+    // once a chunk is staged every later write to it is staged too, its deltas then always come after the serialized ones
+    if (staging) {
+        size_t n = 0;
+
+        for (int w = 0; w < TILE_CHUNK_WORDS; w++) {
+            for (unsigned long long bits = mask[w]; bits; bits &= bits - 1, n++) {
+                const int local = (w * 64) + __builtin_ctzll(bits);
+                edit_staging_record(staging, local, (chunk) ? chunk->cells[local] : (TileCell){0}, cells[(uniform) ? 0 : n]);
+            }
+        }
+
+        return (uniform) ? tile_grid_fill_masked(grid, cx, cy, mask, cells[0]) : tile_grid_write_masked(grid, cx, cy, mask, cells);
+    }
+
+    unsigned int masked = 0;
+    for (int w = 0; w < TILE_CHUNK_WORDS; w++)
+        masked += __builtin_popcountll(mask[w]);
+
+    // room for the largest delta this can turn into, before values are copied out while the chunk is scanned
+    if (!edit_history_reserve(history, edit_delta_size(masked, (uniform) ? EDIT_DELTA_UNIFORM_AFTER : 0)))
+        return false;
+
+    EditDeltaHeader* header = (EditDeltaHeader*)(history->pending + history->pending_size);
+    TileCell* values = (TileCell*)(header + 1);
+
+    // after values of the changed cells, placed once the number of before values is known
+    TileCell after[TILE_CHUNK_CELLS];
+
+    const TileCell empty = {0};
+
+    unsigned int count = 0;
+    bool uniform_before = true;
+    size_t n = 0;
+
+    for (int w = 0; w < TILE_CHUNK_WORDS; w++) {
+        // nothing to compare against, every masked cell changes unless the fill is empty too
+        if (!chunk && uniform) {
+            header->mask[w] = (tile_cell_is_empty(cells[0])) ? 0 : mask[w];
+            count += __builtin_popcountll(header->mask[w]);
+            values[0] = empty;
+            continue;
+        }
+
+        header->mask[w] = 0;
+
+        // a fill over a whole word of an existing chunk is the common case, when it changes every cell the before values go out in one copy
+        if (chunk && uniform && (mask[w] == ~0ULL)) {
+            const TileCell* source = &chunk->cells[w * 64];
+            const TileCell first = source[0];
+            unsigned long long changed = 0, same = 0;
+
+            for (int c = 0; c < 64; c++) {
+                changed |= (unsigned long long)!edit_cell_equal(source[c], cells[0]) << c;
+                same |= (unsigned long long)edit_cell_equal(source[c], first) << c;
+            }
+
+            if (changed == ~0ULL) {
+                uniform_before &= (same == ~0ULL) && ((count == 0) || edit_cell_equal(first, values[0]));
+                memcpy(values + count, source, sizeof(TileCell) * 64);
+
+                header->mask[w] = changed;
+                count += 64;
+                continue;
+            }
+        }
+
+        for (unsigned long long bits = mask[w]; bits; bits &= bits - 1, n++) {
+            const int local = (w * 64) + __builtin_ctzll(bits);
+            const TileCell before = (chunk) ? chunk->cells[local] : empty;
+            const TileCell value = cells[(uniform) ? 0 : n];
+
+            if (edit_cell_equal(before, value))
+                continue;
+
+            header->mask[w] |= 1ULL << (local & 63);
+            uniform_before &= (count == 0) || edit_cell_equal(before, values[0]);
+            after[count] = value;
+            values[count++] = before;
+        }
+    }
+
+    if (count == 0)
+        return true;
+
+    header->cx = cx;
+    header->cy = cy;
+    header->count = count;
+    header->flags = ((uniform) ? EDIT_DELTA_UNIFORM_AFTER : 0) | ((uniform_before) ? EDIT_DELTA_UNIFORM_BEFORE : 0);
+
+    // overwriting an earlier fill or empty space keeps a single before value of the ones copied out
+    TileCell* after_values = values + edit_delta_before_count(count, header->flags);
+
+    if (uniform)
+        after_values[0] = cells[0];
+    else
+        memcpy(after_values, after, sizeof(TileCell) * count);
+
+    const bool written = (uniform) ? tile_grid_fill_masked(grid, cx, cy, header->mask, cells[0]) : tile_grid_write_masked(grid, cx, cy, header->mask, after_values);
+    if (!written)
+        return false;
+
+    history->pending_size += edit_delta_size(count, header->flags);
+    history->pending_deltas++;
+    history->pending_cells += count;
+
+    return true;
+}
+
+// writes 'cell' into every cell of the chunk whose bit is set in mask
+bool edit_history_fill(EditHistory* history, TileGrid* grid, const int cx, const int cy, const unsigned long long* mask, const TileCell cell)
+{
+    if (!history || !grid || !mask)
+        return false;
+
+    const bool implicit = !history->open;
+    if (implicit)
+        edit_history_begin(history, history->closed_at, false);
+
+    const bool filled = edit_history_write_chunk(history, grid, cx, cy, mask, &cell, true);
+
+    if (implicit)
+        edit_history_end(history, history->closed_at);
+
+    return filled;
+}
+
+// writes one value per set bit of mask, in cell order
+bool edit_history_write(EditHistory* history, TileGrid* grid, const int cx, const int cy, const unsigned long long* mask, const TileCell* cells)
+{
+    if (!history || !grid || !mask || !cells)
+        return false;
+
+    const bool implicit = !history->open;
+    if (implicit)
+        edit_history_begin(history, history->closed_at, false);
+
+    const bool written = edit_history_write_chunk(history, grid, cx, cy, mask, cells, false);
+
+    if (implicit)
+        edit_history_end(history, history->closed_at);
+
+    return written;
+}
+
+void edit_history_end(EditHistory* history, const double time)
+{
+    if (!history || !history->open)
+        return;
+
+    history->open = false;
+    history->closed_at = time;
+
+    // staged cells written back to what they were are not part of the entry
+    size_t staged_size = 0;
+    size_t staged_deltas = 0;
+    size_t staged_cells = 0;
+
+    EditStaging* staging, *tmp;
+
+    HASH_ITER(hh, history->staging, staging, tmp) {
+        unsigned int count = 0;
+
+        for (int w = 0; w < TILE_CHUNK_WORDS; w++) {
+            for (unsigned long long bits = staging->mask[w]; bits; bits &= bits - 1) {
+                const int local = (w * 64) + __builtin_ctzll(bits);
+
+                if (edit_cell_equal(staging->before[local], staging->after[local]))
+                    staging->mask[w] &= ~(1ULL << (local & 63));
+                else
+                    count++;
+            }
+        }
+
+        if (count > 0) {
+            staged_size += edit_delta_size(count, 0);
+            staged_deltas++;
+        }
+
+        staged_cells += count;
+    }
+
+    if ((staged_cells + history->pending_cells) == 0) {
+        edit_history_drop_open(history);
+        history->mergeable = false;
+        return;
+    }
+
+    // staged deltas go after the ones serialized by fills, the pending buffer becomes the entry
+    if (!edit_history_reserve(history, staged_size)) {
+        edit_history_drop_open(history);
+        return;
+    }
+
+    HASH_ITER(hh, history->staging, staging, tmp) {
+        unsigned int count = 0;
+
+        for (int w = 0; w < TILE_CHUNK_WORDS; w++)
+            count += __builtin_popcountll(staging->mask[w]);
+
+        if (count == 0)
+            continue;
+
+        EditDeltaHeader* header = (EditDeltaHeader*)(history->pending + history->pending_size);
+        TileCell* before = (TileCell*)(header + 1);
+        TileCell* after = before + count;
+
+        header->cx = staging->cx;
+        header->cy = staging->cy;
+        header->count = count;
+        header->flags = 0;
+        memcpy(header->mask, staging->mask, sizeof(header->mask));
+
+        size_t n = 0;
+
+        for (int w = 0; w < TILE_CHUNK_WORDS; w++) {
+            for (unsigned long long bits = staging->mask[w]; bits; bits &= bits - 1, n++) {
+                const int local = (w * 64) + __builtin_ctzll(bits);
+
+                before[n] = staging->before[local];
+                after[n] = staging->after[local];
+            }
+        }
+
+        history->pending_size += edit_delta_size(count, 0);
+    }
+
+    EditEntry entry = {
+        .data = history->pending,
+        .size = history->pending_size,
+        .raw_size = history->pending_size,
+        .delta_count = history->pending_deltas + staged_deltas,
+        .cell_count = history->pending_cells + staged_cells,
+        .compressed = false,
+    };
+
+    // give back the growth slack, a failed shrink keeps the larger block
+    unsigned char* shrunk = realloc(entry.data, entry.size);
+    if (shrunk)
+        entry.data = shrunk;
+
+    history->pending = NULL;
+    edit_history_drop_open(history);
+
+    if (!edit_history_push(history, entry))
+        edit_entry_free(&entry);
+}
+
+static bool edit_delta_apply(const EditDeltaHeader* header, TileGrid* grid, const bool undo)
+{
+    const TileCell* values = (undo) ? edit_delta_before(header) : edit_delta_after(header);
+    const bool uniform = header->flags & ((undo) ? EDIT_DELTA_UNIFORM_BEFORE : EDIT_DELTA_UNIFORM_AFTER);
+
+    if (uniform)
+        return tile_grid_fill_masked(grid, header->cx, header->cy, header->mask, values[0]);
+
+    return tile_grid_write_masked(grid, header->cx, header->cy, header->mask, values);
+}
+
+// whole chunks are written at once, a million cell fill costs a few thousand masked chunk writes
+static bool edit_entry_apply(const EditEntry* entry, TileGrid* grid, const bool undo)
+{
+    unsigned char* raw = entry->data;
+
+    if (entry->compressed) {
+        raw = malloc(entry->raw_size);
+        if (!raw) {
+            fprintf(stderr, "edit_entry_apply: malloc returned null\n");
+            return false;
+        }
+
+        if (sinflate(raw, entry->raw_size, entry->data, entry->size) != (int)entry->raw_size) {
+            fprintf(stderr, "edit_entry_apply: entry failed to inflate\n");
+            free(raw); raw = NULL;
+            return false;
+        }
+    }
+
+    // a chunk can appear in several deltas, so undo has to walk them back to front
+    const EditDeltaHeader** headers = malloc(sizeof(EditDeltaHeader*) * entry->delta_count);
+    if (!headers) {
+        fprintf(stderr, "edit_entry_apply: malloc returned null\n");
+
+        if (raw != entry->data) {
+            free(raw); raw = NULL;
+        }
+
+        return false;
+    }
+
+    const unsigned char* cursor = raw;
+
+    for (size_t i = 0; i < entry->delta_count; i++) {
+        headers[i] = (const EditDeltaHeader*) cursor;
+        cursor += edit_delta_size(headers[i]->count, headers[i]->flags);
+    }
+
+    bool applied = true;
+
+    for (size_t i = 0; i < entry->delta_count; i++)
+        applied &= edit_delta_apply(headers[(undo) ? (entry->delta_count - 1 - i) : i], grid, undo);
+
+    free(headers); headers = NULL;
+
+    if (raw != entry->data) {
+        free(raw); raw = NULL;
+    }
+
+    return applied;
+}
+
+bool edit_history_undo(EditHistory* history, TileGrid* grid)
+{
+    if (!history || !grid)
+        return false;
+
+    edit_history_end(history, history->closed_at);
+
+    if (history->cursor == 0)
+        return false;
+
+    if (!edit_entry_apply(&history->entries[history->cursor - 1], grid, true))
+        return false;
+
+    history->cursor--;
+    history->mergeable = false;
+
+    return true;
+}
+
+bool edit_history_redo(EditHistory* history, TileGrid* grid)
+{
+    if (!history || !grid)
+        return false;
+
+    edit_history_end(history, history->closed_at);
+
+    if (history->cursor == history->count)
+        return false;
+
+    if (!edit_entry_apply(&history->entries[history->cursor], grid, false))
+        return false;
+
+    history->cursor++;
+    history->mergeable = false;
+
+    return true;
+}
\ No newline at end of file
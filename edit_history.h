@@ -0,0 +1,76 @@
+#ifndef EDIT_HISTORY_H
+#define EDIT_HISTORY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "uthash.h"
+#include "tile_grid.h"
+
+#define EDIT_HISTORY_HOT_ENTRIES 4       // newest entries kept uncompressed, the ones undo reaches first
+#define EDIT_HISTORY_MERGE_SECONDS 0.5   // a stroke starting this soon after the last one ended joins its entry
+
+// cells touched in one chunk while an entry is open, indexed by local cell so repeated writes are a single store
+typedef struct
+{
+    UT_hash_handle hh;                     // for hashing operations, keyed by 'key'
+    long long key;                         // tile_chunk_key of the chunk
+    int cx, cy;
+    unsigned long long mask[TILE_CHUNK_WORDS];
+    TileCell before[TILE_CHUNK_CELLS];     // value the cell had when the entry first touched it
+    TileCell after[TILE_CHUNK_CELLS];      // value it has now
+} EditStaging;
+
+// one undo step, stored as a run of chunk deltas applied in order (undone in reverse):
+//   EditDeltaHeader, then 'count' before values and 'count' after values in mask order
+//   a bulk fill stores a single after value, and a single before value when every cell it covered held the same one
+typedef struct
+{
+    unsigned char* data;      // serialized deltas, deflated once the entry leaves the hot window, allocated
+    size_t size;              // bytes held by data
+    size_t raw_size;          // bytes of the serialized deltas
+    size_t delta_count;
+    size_t cell_count;
+    bool compressed;
+} EditEntry;
+
+typedef struct
+{
+    EditEntry* entries;    // oldest first, allocated
+    size_t count;
+    size_t capacity;
+    size_t cursor;         // entries below the cursor are applied, the ones above it can be redone
+    size_t bytes;          // held by every entry, kept under 'budget' by dropping the oldest
+    size_t budget;
+
+    EditStaging* staging;  // uthash head of the open entry's chunks
+    EditStaging* last;     // chunk the previous write hit, strokes rarely leave it
+    unsigned char* pending; // deltas of bulk fills in the open entry, serialized as they happen, allocated
+    size_t pending_size;
+    size_t pending_capacity;
+    size_t pending_deltas;
+    size_t pending_cells;
+    bool open;
+    bool mergeable;        // the newest entry was a stroke that may still be extended
+    double closed_at;
+
+    void* deflate_state;   // struct sdefl, allocated on the first compression
+} EditHistory;
+
+// history operations
+EditHistory edit_history_init(const size_t budget);
+void edit_history_free(EditHistory* history);
+void edit_history_clear(EditHistory* history);
+
+// recording operations, every write between begin and end becomes one entry
+void edit_history_begin(EditHistory* history, const double time, const bool merge);
+bool edit_history_set(EditHistory* history, TileGrid* grid, const int x, const int y, const TileCell cell);
+bool edit_history_fill(EditHistory* history, TileGrid* grid, const int cx, const int cy, const unsigned long long* mask, const TileCell cell);
+bool edit_history_write(EditHistory* history, TileGrid* grid, const int cx, const int cy, const unsigned long long* mask, const TileCell* cells);
+void edit_history_end(EditHistory* history, const double time);
+
+// replay operations
+bool edit_history_undo(EditHistory* history, TileGrid* grid);
+bool edit_history_redo(EditHistory* history, TileGrid* grid);
+
+#endif
\ No newline at end of file
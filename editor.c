@@ -4,27 +4,41 @@
 #define GUI_WINDOW_FILE_DIALOG_IMPLEMENTATION
 #include "gui_window_file_dialog.h"
 
-#include "list.h"
 #include "utils.h"
+#include "tile_grid.h"
 #include "asset_cache.h"
+#include "asset_loader.h"
+#include "asset_watcher.h"
+#include "tile_palette.h"
+#include "sprite_atlas.h"
+#include "tile_renderer.h"
+#include "grid_renderer.h"
+#include "map_file.h"
+#include "world_stream.h"
+#include "edit_history.h"
+#include "tile_fill.h"
+#include "autotile.h"
+#include "minimap.h"
 
 #define FPS 60
 #define INITIAL_TILE_SIZE 32
 
 #define VALID_ASSET_EXTENSION ".png"
+#define MAP_FILE_PATH "world" MAP_FILE_EXTENSION // written to the working directory by SAVE
+#define WORLD_STREAM_BUDGET (64 * 1024 * 1024)    // bytes of chunks kept in memory once a map streams from disk
+#define EDIT_HISTORY_BUDGET (32 * 1024 * 1024)    // bytes of undo history kept before the oldest entries are dropped
+#define UPLOAD_BUDGET_SECONDS 0.004 // main thread time per frame spent turning decoded sheets into textures
+#define UPLOAD_SLICE_BYTES (1024 * 1024) // pixels handed to the GPU per call while a sheet uploads, the budget is checked between calls
+#define TILE_CACHE_BUDGET (256 * 1024 * 1024)  // VRAM for chunk textures while the chunk cache is on
+#define TILE_CACHE_TOGGLE_KEY KEY_F2
+#define STATS_OVERLAY_TOGGLE_KEY KEY_F3
+#define ASSET_TEXTURE_BUDGET (128 * 1024 * 1024) // VRAM for sheet textures, the atlas holds copies of most sprites so unused sheets reload on demand
 
 #define SCROLLBAR_WIDTH 13
 #define TILE_PALETTE_TILES_PER_ROW 10
 
 // basic utils/misc
 
-int nearest_multiple(const float value, const int multiple)
-{
-    const int quotient = roundf(value / multiple);
-    const int nearest = quotient * multiple;
-    return nearest;
-}
-
 int bound_value_to_interval(const int min, const int max, const int value)
 {
     if (value > max)
@@ -64,45 +78,27 @@ void move_camera(Camera2D* camera)
 
 typedef enum
 {
-	TILE_TYPE_WALL,
-	TILE_TYPE_FLOOR,
-	TILE_TYPE_DOOR,
-	TILE_TYPE_BUFF,
-	TILE_TYPE_INTERACTABLE,
-    TILE_TYPE_N_ITEMS,
-} TileType;
-
-typedef struct
-{
-    Vector2 position;
-    Texture* texture;
-    unsigned long int id;
-} AssetData;
-
-void asset_data_print(void* data)
-{
-    if (data) {
-        AssetData* asset_data = (AssetData*) data;
-        printf("POSITION: (%f,%f), ID: %ld\n", asset_data->position.x, asset_data->position.y, asset_data->id);
-    } 
-}
-
-typedef struct
-{
-    AssetData asset_data;
-    Vector2 world_position; 
-} Tile;
+    EDIT_TOOL_BRUSH, // paints the hovered cell while the button is held
+    EDIT_TOOL_RECT,  // fills the rectangle dragged out between press and release
+    EDIT_TOOL_FILL,  // flood fills the region of matching cells under the cursor
+} EditTool;
 
 typedef struct
 {
     Camera2D camera;
     int tile_size;
+    int tool;           // EditTool, an int since that is what GuiToggleGroup writes
+    bool dragging;      // a rectangle is being dragged out from 'drag_start'
+    Vector2 drag_start; // cell
 } WorldSettings;
 
 WorldSettings world_settings_init()
 {
     return (WorldSettings) {
         .tile_size = INITIAL_TILE_SIZE,
+        .tool = EDIT_TOOL_BRUSH,
+        .dragging = false,
+        .drag_start = (Vector2){0,0},
         .camera = (Camera2D) {
             .offset = (Vector2){0,0},
             .target = (Vector2){0,0},
@@ -125,13 +121,119 @@ void adjust_tile_size(const float mouse_wheel_move, int* tile_size)
     (*tile_size) = bound_value_to_interval(min_tile_size, max_tile_size, (*tile_size) + (delta * mouse_wheel_move));
 }
 
-void handle_world_input(WorldSettings* settings)
+typedef struct
+{
+    TileGrid tiles;       // every resident tile, a cell's 'sheet' is a TilePalette slot
+    WorldStream* stream;  // map the rest of the tiles are read from on demand, null until a map is opened
+    EditHistory history;  // every edit of 'tiles' goes through it
+    Vector2 spawn_point;
+} World;
+
+World world_init()
+{
+    return (World) {
+        .tiles = tile_grid_init(),
+        .stream = NULL,
+        .history = edit_history_init(EDIT_HISTORY_BUDGET),
+        .spawn_point = (Vector2){0},
+    };
+}
+
+void world_free(World* world)
+{
+    if (!world)
+        return;
+
+    world_stream_close(world->stream);
+    world->stream = NULL;
+
+    edit_history_free(&world->history);
+
+    tile_grid_free(&world->tiles);
+}
+
+Vector2 get_hovered_cell(const Camera2D camera, const int tile_size)
+{
+    const Vector2 world_position = GetScreenToWorld2D(GetMousePosition(), camera);
+
+    return (Vector2) {
+        .x = floorf(world_position.x / tile_size),
+        .y = floorf(world_position.y / tile_size),
+    };
+}
+
+// the value a left click writes: the selected sprite, or an empty cell while shift is held
+bool get_paint_cell(const TilePalette* tile_palette, const long int selected, TileCell* out)
+{
+    if (!out)
+        return false;
+
+    if (IsKeyDown(KEY_LEFT_SHIFT)) {
+        (*out) = (TileCell){0};
+        return true;
+    }
+
+    if (!tile_palette || (selected < 0))
+        return false;
+
+    unsigned short sheet = 0;
+    int sprite = 0;
+    if (!tile_palette_locate(tile_palette, selected, &sheet, &sprite))
+        return false;
+
+    (*out) = (TileCell) {
+        .sheet = sheet,
+        .sprite = sprite,
+        .type = TILE_TYPE_FLOOR,
+    };
+
+    return true;
+}
+
+void handle_world_input(WorldSettings* settings, World* world, const TilePalette* tile_palette, const AutotileSet* autotiles, const long int selected)
 {
-    if (!settings)
+    if (!settings || !world)
         return;
 
     if (IsMouseButtonDown(MOUSE_BUTTON_RIGHT))
         move_camera(&settings->camera);
+
+    const Vector2 cell = get_hovered_cell(settings->camera, settings->tile_size);
+    TileCell paint;
+
+    if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+        switch (settings->tool) {
+            // a stroke lasts while the button is held, quick successive strokes fold into the same undo step
+            case EDIT_TOOL_BRUSH:
+                edit_history_begin(&world->history, GetTime(), true);
+                break;
+
+            case EDIT_TOOL_RECT:
+                settings->dragging = true;
+                settings->drag_start = cell;
+                break;
+
+            case EDIT_TOOL_FILL:
+                if (get_paint_cell(tile_palette, selected, &paint)) {
+                    FillBounds bounds;
+
+                    edit_history_begin(&world->history, GetTime(), false);
+                    if (tile_fill_flood(&world->history, &world->tiles, cell.x, cell.y, paint, TILE_FILL_MAX_CELLS, &bounds))
+                        autotile_update_area(autotiles, &world->history, &world->tiles, bounds.x0, bounds.y0, bounds.x1, bounds.y1);
+                    edit_history_end(&world->history, GetTime());
+                }
+                break;
+        }
+    }
+
+    // the painted sprite is only a stand in for sheets with rules, the cell and its neighbours are re-tiled around it
+    if ((settings->tool == EDIT_TOOL_BRUSH) && IsMouseButtonDown(MOUSE_BUTTON_LEFT) && get_paint_cell(tile_palette, selected, &paint)) {
+        // holding the button over a cell of the same rule driven sheet would undo its tiling every frame
+        const bool tiled = autotile_set_get(autotiles, paint.sheet) && (tile_grid_get(&world->tiles, cell.x, cell.y).sheet == paint.sheet);
+
+        if (!tiled && edit_history_set(&world->history, &world->tiles, cell.x, cell.y, paint))
+            autotile_update_cell(autotiles, &world->history, &world->tiles, cell.x, cell.y);
+    }
     
     const float mouse_wheel_move = GetMouseWheelMove();
 
@@ -139,28 +241,175 @@ void handle_world_input(WorldSettings* settings)
         adjust_tile_size(mouse_wheel_move, &settings->tile_size);    
 }
 
+// a rectangle is filled wherever the button is released, even outside of the world view
+void handle_tool_release(WorldSettings* settings, World* world, const TilePalette* tile_palette, const AutotileSet* autotiles, const long int selected)
+{
+    if (!settings || !world || !settings->dragging || !IsMouseButtonReleased(MOUSE_BUTTON_LEFT))
+        return;
+
+    settings->dragging = false;
+
+    TileCell paint;
+    if (!get_paint_cell(tile_palette, selected, &paint))
+        return;
+
+    const Vector2 cell = get_hovered_cell(settings->camera, settings->tile_size);
+
+    // every cell of the rectangle now holds the painted sheet, without rules for it only the ring around needs re-tiling
+    const bool ruled = (paint.sheet != 0) && autotile_set_get(autotiles, paint.sheet);
+
+    edit_history_begin(&world->history, GetTime(), false);
+    if (tile_fill_rect(&world->history, &world->tiles, settings->drag_start.x, settings->drag_start.y, cell.x, cell.y, paint)) {
+        if (ruled)
+            autotile_update_area(autotiles, &world->history, &world->tiles, settings->drag_start.x, settings->drag_start.y, cell.x, cell.y);
+        else
+            autotile_update_ring(autotiles, &world->history, &world->tiles, settings->drag_start.x, settings->drag_start.y, cell.x, cell.y);
+    }
+    edit_history_end(&world->history, GetTime());
+}
+
+// switches between drawing chunk meshes every frame and blitting chunks cached in textures
+void handle_render_input(TileRenderer* renderer, const bool shortcuts_enabled)
+{
+    if (renderer && shortcuts_enabled && IsKeyPressed(TILE_CACHE_TOGGLE_KEY))
+        tile_renderer_set_cache(renderer, !renderer->cached, TILE_CACHE_BUDGET);
+}
+
+// shows or hides the frame and memory counters drawn over the world view
+void handle_overlay_input(bool* show_stats, const bool shortcuts_enabled)
+{
+    if (show_stats && shortcuts_enabled && IsKeyPressed(STATS_OVERLAY_TOGGLE_KEY))
+        (*show_stats) = !(*show_stats);
+}
+
+void handle_history_input(World* world, const bool shortcuts_enabled)
+{
+    if (!world)
+        return;
+
+    // ends the stroke wherever the button is released, even outside of the world view
+    if (IsMouseButtonReleased(MOUSE_BUTTON_LEFT))
+        edit_history_end(&world->history, GetTime());
+
+    if (!shortcuts_enabled || !(IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL)))
+        return;
+
+    const bool shift_down = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
+
+    if (IsKeyPressed(KEY_Z) && !shift_down)
+        edit_history_undo(&world->history, &world->tiles);
+
+    else if (IsKeyPressed(KEY_Y) || (IsKeyPressed(KEY_Z) && shift_down))
+        edit_history_redo(&world->history, &world->tiles);
+}
+
 typedef struct
 {
-    List tiles[TILE_TYPE_N_ITEMS];
-    Vector2 spawn_point;
-} World;
+    const TilePalette* palette;
+    const SpriteAtlas* atlas;
+    AssetCache* cache;
+} SpriteSource;
 
-World world_init()
+// prefers the sprite's atlas rect, falling back to the sheet texture it was imported from
+bool get_sprite(const SpriteSource* sprites, const unsigned short slot, const int cell, Texture* texture, Rectangle* source)
 {
-    World world;
+    if (!sprites)
+        return false;
+
+    const PaletteSheet* sheet = tile_palette_get_sheet(sprites->palette, slot);
+    if (!sheet || !sheet->texture || (palette_sheet_cell_class(sheet, cell) == SPRITE_CLASS_EMPTY))
+        return false;
+
+    if (sprite_atlas_lookup(sprites->atlas, slot, cell, texture, source))
+        return true;
 
-    world.spawn_point = (Vector2){0};
+    // the sheet texture may have been evicted, asking the cache brings it back
+    const Texture* sheet_texture = asset_cache_use(sprites->cache, asset_cache_find(sprites->cache, sheet->asset_id));
+    if (!sheet_texture)
+        return false;
 
-    for (int i = 0; i < TILE_TYPE_N_ITEMS; i++)
-        world.tiles[i] = list_init();
+    (*texture) = (*sheet_texture);
+    (*source) = palette_sheet_sprite_rect(sheet, cell);
 
-    return world;
+    return true;
 }
 
-void world_free(World* world)
+// tile_sprite_funct for the renderer, user is the SpriteSource the cells' sheet slots refer to
+bool resolve_tile_sprite(const TileCell cell, Texture* texture, Rectangle* source, void* user)
+{
+    return get_sprite((SpriteSource*) user, cell.sheet, cell.sprite, texture, source);
+}
+
+// tile_texture_funct for the renderer, sheet textures a mesh draws with are pinned in the cache, atlas pages are not cache entries
+void hold_tile_texture(const unsigned int texture_id, const int delta, void* user)
+{
+    AssetCache* cache = ((SpriteSource*) user)->cache;
+    AssetEntry* entry = asset_cache_find_texture(cache, texture_id);
+
+    if (delta > 0)
+        asset_cache_retain(cache, entry);
+    else
+        asset_cache_release(cache, entry);
+}
+
+// the color a cell shows on the minimap, averaged from its sprite's pixels when the sheet was imported
+Color resolve_tile_color(const TileCell cell, void* user)
 {
-    for (int i = 0; i < TILE_TYPE_N_ITEMS; i++)
-        list_free(&world->tiles[i]);
+    const SpriteSource* sprites = (const SpriteSource*) user;
+
+    return palette_sheet_cell_color(tile_palette_get_sheet(sprites->palette, cell.sheet), cell.sprite);
+}
+
+#define FRAME_TIME_HISTORY FPS
+
+typedef struct
+{
+    size_t texture_switches;   // draws this frame that used a different texture than the draw before
+    unsigned int last_texture;
+    size_t palette_sprites;    // palette cells submitted this frame, bounded by the visible rows
+} FrameStats;
+
+// rolling window of frame times, the worst one is what an import stall would show up in
+typedef struct
+{
+    float times[FRAME_TIME_HISTORY];
+    size_t next;
+} FrameTimes;
+
+void frame_times_push(FrameTimes* frame_times, const float frame_time)
+{
+    frame_times->times[frame_times->next] = frame_time;
+    frame_times->next = (frame_times->next + 1) % FRAME_TIME_HISTORY;
+}
+
+float frame_times_worst(const FrameTimes* frame_times)
+{
+    float worst = 0;
+
+    for (size_t i = 0; i < FRAME_TIME_HISTORY; i++) {
+        if (frame_times->times[i] > worst)
+            worst = frame_times->times[i];
+    }
+
+    return worst;
+}
+
+float frame_times_average(const FrameTimes* frame_times)
+{
+    float total = 0;
+
+    for (size_t i = 0; i < FRAME_TIME_HISTORY; i++)
+        total += frame_times->times[i];
+
+    return total / FRAME_TIME_HISTORY;
+}
+
+void frame_stats_use_texture(FrameStats* stats, const unsigned int texture_id)
+{
+    if (stats && (stats->last_texture != texture_id)) {
+        stats->last_texture = texture_id;
+        stats->texture_switches++;
+    }
 }
 
 void editor_init()
@@ -229,19 +478,6 @@ Rectangle get_world_bounds(const Rectangle screen_bounds, const Camera2D camera)
     };
 }
 
-void draw_infinite_grid(const Rectangle bounds, const float v_dist, const float h_dist)
-{
-    const float x0 = nearest_multiple(bounds.x, v_dist);
-
-    for (float x = x0; x <= bounds.x + bounds.width; x += v_dist)
-        DrawLine(x, bounds.y, x, bounds.y + bounds.height, BLACK);
-
-    const float y0 = nearest_multiple(bounds.y, h_dist);
-    
-    for (float y = y0; y <= bounds.y + bounds.height; y += h_dist)
-        DrawLine(bounds.x, y, bounds.x + bounds.width, y, BLACK);
-}
-
 void layout_dynamic_bar(const Rectangle container, const float padding, Rectangle* recs, const size_t nrecs)
 {
     const float bar_w = container.width - (padding * (nrecs + 1));
@@ -268,9 +504,9 @@ float get_tile_palette_size(const bool is_scrollbar_visible, const float contain
     return availible_width / (TILE_PALETTE_TILES_PER_ROW * 1.0f);
 }
 
-void draw_top_bar(const Rectangle container, const float padding, bool* load_window_active)
+void draw_top_bar(const Rectangle container, const float padding, bool* load_window_active, bool* save_pressed, int* tool)
 {
-    const size_t widget_count = 2;
+    const size_t widget_count = 3;
     Rectangle widget_bounds[widget_count];
     layout_dynamic_bar(container, padding, widget_bounds, widget_count);
     
@@ -282,15 +518,43 @@ void draw_top_bar(const Rectangle container, const float padding, bool* load_win
 
     GuiSetState(STATE_NORMAL);
 
-    if (GuiButton(widget_bounds[1], GuiIconText(ICON_FILE_SAVE, "SAVE")))
-        ;
+    if (GuiButton(widget_bounds[1], GuiIconText(ICON_FILE_SAVE, "SAVE")) && save_pressed)
+        (*save_pressed) = true;
+
+    if (!tool)
+        return;
+
+    // GuiToggleGroup takes the bounds of a single toggle
+    const int tool_count = 3;
+    const float group_padding = GuiGetStyle(TOGGLE, GROUP_PADDING);
+
+    Rectangle toggle_bounds = widget_bounds[2];
+    toggle_bounds.width = (widget_bounds[2].width - (group_padding * (tool_count - 1))) / tool_count;
+
+    GuiToggleGroup(toggle_bounds, TextFormat("#%i#BRUSH;#%i#RECT;#%i#FILL", ICON_BRUSH_CLASSIC, ICON_BOX, ICON_COLOR_BUCKET), tool);
 }
 
-void draw_tile_scroll_panel(ScrollPanel* scroll_panel, List* tile_palette, const float sprite_size)
+// maps a point inside the palette container to the palette index drawn under it, -1 if there is none
+long int get_palette_index_at(const Vector2 point, const Rectangle container, const float tile_palette_size, const float scroll_y, const size_t sprite_count)
 {
-    if (!scroll_panel || !tile_palette)
+    const float column = floorf((point.x - container.x) / tile_palette_size);
+    const float row = floorf((point.y - container.y - scroll_y) / tile_palette_size);
+
+    if ((column < 0) || (column >= TILE_PALETTE_TILES_PER_ROW) || (row < 0))
+        return -1;
+
+    const long int index = (row * TILE_PALETTE_TILES_PER_ROW) + column;
+
+    return (index < sprite_count) ? index : -1;
+}
+
+void draw_tile_scroll_panel(ScrollPanel* scroll_panel, const SpriteSource* sprites, const size_t pending, long int* selected, FrameStats* stats)
+{
+    if (!scroll_panel || !sprites || !selected)
         return;
 
+    const TilePalette* tile_palette = sprites->palette;
+
     const char* panel_text = "Tiles";
     const bool show_scrollbar = true;
     GuiScrollPanel(scroll_panel->bounds, panel_text, scroll_panel->content, &scroll_panel->scrollbar, NULL, show_scrollbar);
@@ -300,49 +564,195 @@ void draw_tile_scroll_panel(ScrollPanel* scroll_panel, List* tile_palette, const
 
     const Rectangle scissor_rect = get_padded_rectangle(1, tile_palette_container);
 
+    if (!GuiIsLocked() && IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && CheckCollisionPointRec(GetMousePosition(), scissor_rect)) {
+        const long int index = get_palette_index_at(GetMousePosition(), tile_palette_container, tile_palette_size, scroll_panel->scrollbar.y, tile_palette->sprite_count);
+        if (index >= 0)
+            (*selected) = index;
+    }
+
+    // only the rows overlapping the container are submitted, the scissor just trims the partial ones at the edges
+    const size_t cell_count = tile_palette->sprite_count + pending;
+    const float  first_row  = fmaxf(0, floorf(-scroll_panel->scrollbar.y / tile_palette_size));
+    const float  last_row   = fmaxf(0, ceilf((tile_palette_container.height - scroll_panel->scrollbar.y) / tile_palette_size));
+
+    const size_t first = fminf(cell_count, first_row * TILE_PALETTE_TILES_PER_ROW);
+    const size_t last  = fminf(cell_count, last_row * TILE_PALETTE_TILES_PER_ROW);
+
     BeginScissorMode(scissor_rect.x, scissor_rect.y, scissor_rect.width, scissor_rect.height);
-    
-        Vector2 tile_position = {tile_palette_container.x, tile_palette_container.y};
-
-        int i = 0;
-        for (Node* node = tile_palette->head; node; node = node->next, i++, tile_position.x += tile_palette_size) {
-            if ((i != 0) && ((i % TILE_PALETTE_TILES_PER_ROW) == 0)) {
-                tile_position = (Vector2) {
-                    .x = tile_palette_container.x,
-                    .y = (tile_position.y + tile_palette_size)
-                };
-            }  
-            
-            AssetData* metadata = (AssetData*) node->content;
 
-            const Rectangle src_rect = {
-                .x = metadata->position.x,
-                .y = metadata->position.y,
-                .width = sprite_size,
-                .height = sprite_size,
-            };
+        // one search finds the first visible sprite, the rest are reached by stepping through the occupied bits
+        unsigned short slot = 0;
+        int cell = -1;
 
+        if ((first < tile_palette->sprite_count) && !tile_palette_locate(tile_palette, first, &slot, &cell))
+            slot = 0;
+
+        for (size_t i = first; i < last; i++) {
             const Rectangle dest_rect = {
-                .x = tile_position.x,
-                .y = tile_position.y + scroll_panel->scrollbar.y,
+                .x = tile_palette_container.x + ((i % TILE_PALETTE_TILES_PER_ROW) * tile_palette_size),
+                .y = tile_palette_container.y + ((i / TILE_PALETTE_TILES_PER_ROW) * tile_palette_size) + scroll_panel->scrollbar.y,
                 .width = tile_palette_size,
                 .height = tile_palette_size
             };
 
-            DrawTexturePro((*metadata->texture), src_rect, dest_rect, (Vector2){0,0}, 0.0f, WHITE);
+            // sheets still decoding get a placeholder after the last sprite
+            if ((i >= tile_palette->sprite_count) || (slot == 0)) {
+                DrawRectangleRec(get_padded_rectangle(2, dest_rect), LIGHTGRAY);
+                GuiDrawIcon(ICON_CLOCK, dest_rect.x + ((dest_rect.width - 16) / 2), dest_rect.y + ((dest_rect.height - 16) / 2), 1, GRAY);
+                continue;
+            }
+
+            Texture texture;
+            Rectangle src_rect;
+            if (get_sprite(sprites, slot, cell, &texture, &src_rect)) {
+                frame_stats_use_texture(stats, texture.id);
+                DrawTexturePro(texture, src_rect, dest_rect, (Vector2){0,0}, 0.0f, WHITE);
+            }
+
+            if (stats)
+                stats->palette_sprites++;
+
+            if ((*selected) == i)
+                DrawRectangleLinesEx(dest_rect, 2, RED);
+
+            // empty sheets are skipped, the walk ends once it runs past the last sheet
+            cell = palette_sheet_next_cell(tile_palette_get_sheet(tile_palette, slot), cell);
+            while ((cell < 0) && (slot < tile_palette->sheet_count))
+                cell = palette_sheet_next_cell(tile_palette_get_sheet(tile_palette, ++slot), -1);
+
+            if (cell < 0)
+                slot = 0;
         }
 
     EndScissorMode();
 }
 
-void draw_side_bar(const Rectangle container, ScrollPanel* tile_scroll_panel, List* tile_palette, const float sprite_size)
+// the minimap takes a square at the bottom of the side bar, the palette keeps the rest
+void split_side_bar(const Rectangle side_bar, const float padding, Rectangle* palette_zone, Rectangle* minimap_zone)
 {
-    draw_tile_scroll_panel(tile_scroll_panel, tile_palette, sprite_size);
+    if (!palette_zone || !minimap_zone)
+        return;
+
+    const float side = fminf(side_bar.width, side_bar.height / 2);
+
+    (*palette_zone) = (Rectangle) {
+        .x = side_bar.x,
+        .y = side_bar.y,
+        .width = side_bar.width,
+        .height = side_bar.height - side,
+    };
+
+    (*minimap_zone) = get_padded_rectangle(padding, (Rectangle) {
+        .x = side_bar.x,
+        .y = side_bar.y + side_bar.height - side,
+        .width = side_bar.width,
+        .height = side,
+    });
 }
 
-void draw_world(const Rectangle container, const float padding, World* world, WorldSettings* settings)
+// the whole minimap texture scaled into a square with the world view outlined, clicking or dragging centers the view on that spot
+void draw_minimap(const Rectangle container, const Minimap* minimap, WorldSettings* settings, const Rectangle world_view)
 {
-    if (!world || !settings)
+    if (!minimap || !settings || (minimap->texture.id == 0))
+        return;
+
+    const float side = fminf(container.width, container.height);
+    if (side <= 0)
+        return;
+
+    const Rectangle bounds = {
+        .x = container.x + ((container.width - side) / 2),
+        .y = container.y + ((container.height - side) / 2),
+        .width = side,
+        .height = side,
+    };
+
+    const float scale = side / MINIMAP_SIZE; // screen pixels per texel
+
+    DrawRectangleRec(bounds, Fade(LIGHTGRAY, 0.5f));
+    DrawTexturePro(minimap->texture, (Rectangle){ 0, 0, MINIMAP_SIZE, MINIMAP_SIZE }, bounds, (Vector2){0,0}, 0.0f, WHITE);
+
+    const Vector2 view_start = GetScreenToWorld2D((Vector2){ world_view.x, world_view.y }, settings->camera);
+    const Vector2 view_end = GetScreenToWorld2D((Vector2){ world_view.x + world_view.width, world_view.y + world_view.height }, settings->camera);
+
+    const Vector2 texel_start = minimap_cell_to_texel(minimap, vector2_scale(view_start, 1.0f / settings->tile_size));
+    const Vector2 texel_end = minimap_cell_to_texel(minimap, vector2_scale(view_end, 1.0f / settings->tile_size));
+
+    const Rectangle outline = {
+        .x = bounds.x + (texel_start.x * scale),
+        .y = bounds.y + (texel_start.y * scale),
+        .width = fmaxf(1, (texel_end.x - texel_start.x) * scale),
+        .height = fmaxf(1, (texel_end.y - texel_start.y) * scale),
+    };
+
+    BeginScissorMode(bounds.x, bounds.y, bounds.width, bounds.height);
+        DrawRectangleLinesEx(outline, 1, RED);
+    EndScissorMode();
+
+    DrawRectangleLinesEx(bounds, 1, GRAY);
+
+    if (GuiIsLocked() || !IsMouseButtonDown(MOUSE_BUTTON_LEFT) || !CheckCollisionPointRec(GetMousePosition(), bounds))
+        return;
+
+    const Vector2 mouse = GetMousePosition();
+    const Vector2 cell = minimap_texel_to_cell(minimap, (Vector2){ (mouse.x - bounds.x) / scale, (mouse.y - bounds.y) / scale });
+
+    // the camera maps its target to its offset, so the clicked spot lands in the middle of the view when shifted by half of it
+    const Vector2 view_center = { world_view.x + (world_view.width / 2), world_view.y + (world_view.height / 2) };
+    const Vector2 half_view = vector2_scale(vector2_add(view_center, vector2_scale(settings->camera.offset, -1.0f)), 1.0f / settings->camera.zoom);
+
+    settings->camera.target = vector2_add(vector2_scale(cell, settings->tile_size), vector2_scale(half_view, -1.0f));
+}
+
+// the scroll panel's bounds already cover the palette's part of the side bar, see split_side_bar
+void draw_side_bar(const Rectangle minimap_zone, ScrollPanel* tile_scroll_panel, const SpriteSource* sprites, const size_t pending, long int* selected, FrameStats* stats, const Minimap* minimap, WorldSettings* settings, const Rectangle world_view)
+{
+    draw_tile_scroll_panel(tile_scroll_panel, sprites, pending, selected, stats);
+    draw_minimap(minimap_zone, minimap, settings, world_view);
+}
+
+void draw_hovered_cell(const Rectangle container, const WorldSettings* settings)
+{
+    if (!settings || !CheckCollisionPointRec(GetMousePosition(), container))
+        return;
+
+    const Vector2 cell = get_hovered_cell(settings->camera, settings->tile_size);
+
+    const Rectangle cell_rect = {
+        .x = cell.x * settings->tile_size,
+        .y = cell.y * settings->tile_size,
+        .width = settings->tile_size,
+        .height = settings->tile_size,
+    };
+
+    DrawRectangleLinesEx(cell_rect, 2, RED);
+}
+
+// outline of the rectangle being dragged out
+void draw_tool_preview(const WorldSettings* settings)
+{
+    if (!settings || !settings->dragging)
+        return;
+
+    const Vector2 cell = get_hovered_cell(settings->camera, settings->tile_size);
+
+    const float x0 = fminf(settings->drag_start.x, cell.x), x1 = fmaxf(settings->drag_start.x, cell.x);
+    const float y0 = fminf(settings->drag_start.y, cell.y), y1 = fmaxf(settings->drag_start.y, cell.y);
+
+    const Rectangle rect = {
+        .x = x0 * settings->tile_size,
+        .y = y0 * settings->tile_size,
+        .width = (x1 - x0 + 1) * settings->tile_size,
+        .height = (y1 - y0 + 1) * settings->tile_size,
+    };
+
+    DrawRectangleRec(rect, Fade(BLUE, 0.2f));
+    DrawRectangleLinesEx(rect, 2, BLUE);
+}
+
+void draw_world(const Rectangle container, const float padding, World* world, WorldSettings* settings, TileRenderer* renderer, GridRenderer* grid)
+{
+    if (!world || !settings || !renderer || !grid)
         return;
     
     const Rectangle padded_container = get_padded_rectangle(padding, container);
@@ -350,14 +760,54 @@ void draw_world(const Rectangle container, const float padding, World* world, Wo
     if ((padded_container.width > 0) && (padded_container.height > 0)) 
         DrawRectangleLinesEx(padded_container, 1, GRAY);
 
+    const Rectangle world_bounds = get_world_bounds(padded_container, settings->camera);
+
+    // chunk textures are rendered before the scissor and camera are set, they draw in their own space
+    tile_renderer_update(renderer, &world->tiles, world_bounds, settings->tile_size, settings->camera.zoom);
+
     BeginScissorMode(padded_container.x, padded_container.y, padded_container.width, padded_container.height);
         BeginMode2D(settings->camera);
-            const Rectangle world_bounds = get_world_bounds(padded_container, settings->camera);
-            draw_infinite_grid(world_bounds, settings->tile_size, settings->tile_size);
+            tile_renderer_draw(renderer, &world->tiles, world_bounds, settings->tile_size);
+            grid_renderer_draw(grid, world_bounds, settings->tile_size, settings->camera.zoom);
+            draw_hovered_cell(padded_container, settings);
+            draw_tool_preview(settings);
         EndMode2D();
     EndScissorMode();
 }
 
+// counters for profiling the editor, drawn in the top left corner of the world view while toggled on
+void draw_stats_overlay(const Rectangle container, const FrameStats* frame_stats, const FrameTimes* frame_times, const FrameTimes* world_draw_times, const TileRenderer* renderer, const GridRenderer* grid, const World* world, const AssetCache* cache)
+{
+    if (!frame_stats || !frame_times || !world_draw_times || !renderer || !grid || !world || !cache)
+        return;
+
+    const int font_size = 10;
+    const int x = container.x + 4;
+    int y = container.y + 4;
+
+    DrawText(TextFormat("%zu texture switches", frame_stats->texture_switches + renderer->texture_switches), x, y, font_size, DARKGREEN); y += font_size;
+    DrawText(TextFormat("%.1f ms worst frame", frame_times_worst(frame_times) * 1000.0f), x, y, font_size, DARKGREEN); y += font_size;
+    DrawText(TextFormat("%zu palette sprites drawn", frame_stats->palette_sprites), x, y, font_size, DARKGREEN); y += font_size;
+    DrawText(TextFormat("%zu grid vertices", grid->vertex_count), x, y, font_size, DARKGREEN); y += font_size;
+    DrawText(TextFormat("%zu chunks resident, %.1f MB", tile_grid_chunk_count(&world->tiles), tile_grid_memory_usage(&world->tiles) / (1024.0f * 1024.0f)), x, y, font_size, DARKGREEN); y += font_size;
+    DrawText(TextFormat("%zu/%zu undo steps, %.1f MB", world->history.cursor, world->history.count, world->history.bytes / (1024.0f * 1024.0f)), x, y, font_size, DARKGREEN); y += font_size;
+    DrawText(TextFormat("%.2f ms world draw, %zu draw calls", frame_times_average(world_draw_times) * 1000.0f, renderer->draw_calls), x, y, font_size, DARKGREEN); y += font_size;
+
+    if (renderer->cached) {
+        const size_t lookups = renderer->cache_hits + renderer->cache_renders + renderer->cache_fallbacks;
+        const float hit_rate = (lookups) ? (100.0f * renderer->cache_hits / lookups) : 100.0f;
+
+        DrawText(TextFormat("chunk cache (F2): %.0f%% hits, %zu renders, %zu fallbacks, %.1f MB", hit_rate, renderer->cache_renders, renderer->cache_fallbacks, renderer->target_bytes / (1024.0f * 1024.0f)), x, y, font_size, DARKGREEN);
+    }
+    else
+        DrawText("chunk cache (F2): off", x, y, font_size, DARKGREEN);
+
+    y += font_size;
+
+    const AssetCacheStats asset_stats = asset_cache_get_stats(cache);
+    DrawText(TextFormat("sheet textures: %.1f/%.0f MB, %zu hits, %zu misses, %zu evictions, %zu reloads", cache->texture_bytes / (1024.0f * 1024.0f), cache->budget / (1024.0f * 1024.0f), asset_stats.hits, asset_stats.misses, asset_stats.evictions, asset_stats.reloads), x, y, font_size, DARKGREEN);
+}
+
 // ui
 
 // GuiWindowFileDialogState stuff
@@ -383,32 +833,343 @@ void update_tile_scroll_panel(const float ntiles, ScrollPanel* scroll_panel)
     scroll_panel->content.height = (nrows) * tile_palette_size;
 }
 
-void parse_asset_entry(AssetEntry* entry, List* tile_palette, const float sprite_size)
+// a decoded sheet going up a slice at a time, its texture rows first, then its staged atlas rows
+typedef struct
 {
-    if (!asset_entry_is_ready(entry) || !tile_palette)
-        return;
+    DecodedAsset asset;  // path is null while nothing uploads
+    AssetEntry* entry;   // the sheet's cache entry, held until its texture is complete
+    unsigned short slot; // palette slot, known from the start for a reload, once the palette took the sheet for an import
+    bool installed;      // the palette holds the new cells
+    bool atlas_in_place; // a reload listing the same cells as before, its staging goes into the bands it already has
+    int texture_row;     // next image row to upload
+    int staging_row;     // next staging row to upload
+} SheetUpload;
+
+void sheet_upload_clear(SheetUpload* upload)
+{
+    decoded_asset_free(&upload->asset);
+
+    (*upload) = (SheetUpload){0};
+}
+
+// imports not in the palette yet, the panel keeps a placeholder for each
+size_t pending_imports(const AssetLoader* loader, const SheetUpload* upload)
+{
+    return loader->imports_in_flight + ((upload->asset.path && !upload->asset.reload && !upload->installed) ? 1 : 0);
+}
+
+// rows of 'row_bytes' each that fit one slice, at least one and at most what remains
+int slice_rows(const size_t row_bytes, const int remaining)
+{
+    const size_t fit = (row_bytes < UPLOAD_SLICE_BYTES) ? (UPLOAD_SLICE_BYTES / row_bytes) : 1;
+
+    return (fit < (size_t)remaining) ? (int)fit : remaining;
+}
+
+// checks a freshly decoded sheet against what the editor holds and readies its texture, the upload owns 'decoded' afterwards
+bool sheet_upload_start(SheetUpload* upload, DecodedAsset* decoded, AssetCache* cache, AssetWatcher* watcher, TilePalette* tile_palette)
+{
+    (*upload) = (SheetUpload) {
+        .asset = (*decoded),
+        .entry = NULL,
+        .slot = 0,
+        .installed = false,
+        .atlas_in_place = false,
+        .texture_row = 0,
+        .staging_row = 0,
+    };
+
+    (*decoded) = (DecodedAsset){0};
+
+    DecodedAsset* asset = &upload->asset;
+    AssetEntry* entry = asset_cache_find_path(cache, asset->path);
+    const bool analyzed = IsImageReady(asset->image) && (asset->sheet.occupied != NULL);
+
+    if (asset->reload) {
+        // a sheet still importing keeps the pixels it was first decoded with
+        const PaletteSheet* sheet = (entry) ? tile_palette_find_sheet(tile_palette, entry->id) : NULL;
+        if (!analyzed || !sheet || !sheet->texture) {
+            sheet_upload_clear(upload);
+            return false;
+        }
+
+        // checked against the palette's grid, the cache cannot tell for a texture it evicted
+        if (!palette_sheet_fits(sheet, &asset->image)) {
+            fprintf(stderr, "sheet_upload_start: \"%s\" changed size, restart the editor to pick it up\n", asset->path);
+            sheet_upload_clear(upload);
+            return false;
+        }
+
+        upload->slot = (sheet - tile_palette->sheets) + 1;
+        upload->atlas_in_place = palette_sheet_same_cells(sheet, &asset->sheet);
+    }
+
+    else {
+        if (entry && !entry->uploading) {
+            fprintf(stderr, "sheet_upload_start: the asset \"%s\" is already in the cache\n", asset->path);
+            sheet_upload_clear(upload);
+            return false;
+        }
+
+        // a sheet a map is waiting for stays out of the palette, its tiles with it
+        if (!analyzed) {
+            fprintf(stderr, "sheet_upload_start: failed to decode \"%s\"\n", asset->path);
+
+            if (entry) {
+                entry->missing = true;
+                asset_cache_end_upload(cache, entry);
+            }
+
+            sheet_upload_clear(upload);
+            return false;
+        }
+
+        // a map load may have added the entry already, to keep its path while the sheet was decoding
+        if (!entry) {
+            entry = asset_entry_init_pending(asset->path);
+
+            if (!entry || !asset_cache_add(cache, entry)) {
+                fprintf(stderr, "sheet_upload_start: failed to add \"%s\" to the cache\n", asset->path);
+                asset_entry_free(entry);
+                sheet_upload_clear(upload);
+                return false;
+            }
+
+            asset_watcher_add(watcher, entry->path);
+        }
+    }
+
+    if (!asset_cache_begin_upload(cache, entry, asset->image.width, asset->image.height)) {
+        fprintf(stderr, "sheet_upload_start: failed to update the texture of \"%s\"\n", asset->path);
+
+        if (!asset->reload) {
+            entry->missing = true;
+            asset_cache_end_upload(cache, entry);
+        }
+
+        sheet_upload_clear(upload);
+        return false;
+    }
+
+    upload->entry = entry;
+
+    return true;
+}
+
+// hands the analyzed cells to the palette once the texture is complete, along with the rules and the atlas bands of a new sheet
+void sheet_upload_install(SheetUpload* upload, TilePalette* tile_palette, SpriteAtlas* atlas, AutotileSet* autotiles, long int* selected)
+{
+    DecodedAsset* asset = &upload->asset;
+
+    upload->installed = true;
+    upload->staging_row = asset->staging.rows;
+
+    // occupied cells may come and go, shifting the flat index of every later sprite, the selection follows its sprite
+    unsigned short selected_slot = 0;
+    int selected_cell = -1;
+    const bool has_selection = selected && ((*selected) >= 0) && tile_palette_locate(tile_palette, *selected, &selected_slot, &selected_cell);
+
+    if (asset->reload) {
+        if (!tile_palette_refresh_sheet(tile_palette, upload->slot, &asset->sheet)) {
+            fprintf(stderr, "sheet_upload_install: failed to classify the new pixels of \"%s\"\n", asset->path);
+            return;
+        }
+    }
+
+    else {
+        upload->slot = tile_palette_adopt_sheet(tile_palette, upload->entry->id, &upload->entry->texture, &asset->sheet);
+
+        if (upload->slot == 0) {
+            fprintf(stderr, "sheet_upload_install: failed to add \"%s\" to the tile palette\n", asset->path);
+            return;
+        }
+
+        // a sheet without a rules file beside it is painted as is
+        if (asset->rules) {
+            autotile_set_put(autotiles, upload->slot, asset->rules);
+            asset->rules = NULL;
+        }
+    }
+
+    if (has_selection)
+        (*selected) = tile_palette_index(tile_palette, selected_slot, selected_cell);
+
+    const PaletteSheet* sheet = tile_palette_get_sheet(tile_palette, upload->slot);
+
+    // the rarer reload that lists other cells moves sprites between bands, it is rebuilt from the image in one go
+    if (asset->reload && !upload->atlas_in_place)
+        sprite_atlas_update_sheet(atlas, upload->slot, sheet, &asset->image);
+
+    else if (!asset->reload && !sprite_atlas_place_sheet(atlas, upload->slot, sheet, &asset->staging))
+        fprintf(stderr, "sheet_upload_install: the sprites of \"%s\" were left in their sheet texture\n", asset->path);
+
+    else
+        upload->staging_row = 0;
+}
+
+// uploads one slice of the current sheet, true once it is complete
+bool sheet_upload_step(SheetUpload* upload, AssetCache* cache, TilePalette* tile_palette, SpriteAtlas* atlas, AutotileSet* autotiles, long int* selected)
+{
+    DecodedAsset* asset = &upload->asset;
+    const Image* image = &asset->image;
+
+    if (upload->texture_row < image->height) {
+        const int rows = slice_rows((size_t)image->width * 4, image->height - upload->texture_row);
+
+        if (!asset_cache_upload_rows(cache, upload->entry, image, upload->texture_row, rows))
+            fprintf(stderr, "sheet_upload_step: failed to update the texture of \"%s\"\n", asset->path);
+
+        upload->texture_row += rows;
+
+        if (upload->texture_row < image->height)
+            return false;
+
+        asset_cache_end_upload(cache, upload->entry);
+        sheet_upload_install(upload, tile_palette, atlas, autotiles, selected);
+
+        return upload->staging_row >= asset->staging.rows;
+    }
+
+    const AtlasStaging* staging = &asset->staging;
+
+    if (upload->staging_row < staging->rows) {
+        const int rows = slice_rows((size_t)staging->columns * staging->padded * staging->padded * 4, staging->rows - upload->staging_row);
+
+        sprite_atlas_upload_rows(atlas, upload->slot, staging, upload->staging_row, rows);
+        upload->staging_row += rows;
+
+        if (upload->staging_row < staging->rows)
+            return false;
+    }
+
+    // lookups only move to the atlas once every row of a new sheet is up there
+    if (!asset->reload)
+        sprite_atlas_map_sheet(atlas, upload->slot, tile_palette_get_sheet(tile_palette, upload->slot));
+    else
+        TraceLog(LOG_INFO, "sheet_upload_step: reloaded \"%s\"", asset->path);
+
+    return true;
+}
+
+typedef struct
+{
+    AssetCache* cache;
+    TilePalette* palette;
+    AssetLoader* loader;
+    const SheetUpload* upload;
+    AssetWatcher* watcher;
+    float sprite_size; // cell size of sheets imported from the file dialog
+} MapImport;
+
+// finds the live slot of a sheet a map was saved with, a sheet not loaded yet gets a slot its tiles wait in while it decodes
+unsigned short import_map_asset(const MapAsset* asset, void* user)
+{
+    MapImport* import = (MapImport*) user;
 
-    const unsigned long int id = entry->id;
+    PaletteSheet* sheet = tile_palette_find_sheet(import->palette, asset->id);
 
-    Texture* texture = &entry->texture;
+    if (!sheet && valid_string(asset->path)) {
+        // the entry keeps the path for a map saved before the sheet is in
+        AssetEntry* entry = asset_cache_find_path(import->cache, asset->path);
 
-    for (float y = 0; y < texture->height; y += sprite_size) {
-        for (float x = 0; x < texture->width; x += sprite_size) {
-            AssetData* asset_data = malloc(sizeof(AssetData));
-            if (asset_data) {
-                asset_data->id = id;
-                asset_data->texture = texture;
-                asset_data->position = (Vector2){x,y};
-                list_append(tile_palette, node_init(asset_data, sizeof(AssetData), asset_data_print, free));
+        if (!entry) {
+            entry = asset_entry_init_pending(asset->path);
+            if (entry && !asset_cache_add(import->cache, entry)) {
+                asset_entry_free(entry);
+                entry = NULL;
             }
+
+            if (entry)
+                asset_watcher_add(import->watcher, entry->path);
         }
+
+        // an import from the file dialog may already be decoding or uploading it
+        const bool queued = entry && entry->uploading && ((import->upload->entry == entry) || asset_loader_is_pending(import->loader, entry->id) || asset_loader_request(import->loader, entry->path, asset->sprite_size, false));
+
+        if (queued)
+            sheet = tile_palette_get_sheet(import->palette, tile_palette_reserve_sheet(import->palette, entry->id, asset->sprite_size));
+
+        else if (entry && entry->uploading) {
+            entry->missing = true;
+            asset_cache_end_upload(import->cache, entry);
+        }
+    }
+
+    if (!sheet) {
+        fprintf(stderr, "import_map_asset: \"%s\" could not be loaded, its tiles are dropped\n", asset->path);
+        return 0;
+    }
+
+    return (sheet - import->palette->sheets) + 1;
+}
+
+void save_world(World* world, const TilePalette* tile_palette, AssetCache* cache)
+{
+    MapFileStats stats;
+
+    // chunks still on disk are carried over from the map being streamed
+    const MapFile* source = (world->stream) ? &world->stream->map : NULL;
+
+    if (!map_file_save(MAP_FILE_PATH, &world->tiles, tile_palette, cache, world->spawn_point, source, &stats)) {
+        fprintf(stderr, "save_world: failed to save \"%s\"\n", MAP_FILE_PATH);
+        return;
     }
+
+    TraceLog(LOG_INFO, "save_world: %zu tiles, %zu chunks, %zu bytes in %.3fs on %d threads", stats.cell_count, stats.chunk_count, stats.file_bytes, stats.seconds, stats.thread_count);
 }
 
-void handle_file_select(ScrollPanel* tile_scroll_panel, GuiWindowFileDialogState* file_dialog_state, AssetCache* cache, List* tile_palette, const float sprite_size)
+// only the table of contents is read here, chunks stream in around the camera from update_world_stream
+void load_world(const char* path, World* world, ScrollPanel* tile_scroll_panel, MapImport* import)
 {
-    if (!tile_scroll_panel || !file_dialog_state || !cache || !tile_palette) 
+    WorldStream* stream = world_stream_open(path, WORLD_STREAM_BUDGET, import_map_asset, import);
+    if (!stream) {
+        fprintf(stderr, "load_world: failed to open \"%s\"\n", path);
         return;
+    }
+
+    world_stream_close(world->stream);
+    world->stream = stream;
+
+    // revisions carry on from the old grid, so renderer caches never see a reused chunk version
+    const unsigned int revision = world->tiles.revision;
+    tile_grid_free(&world->tiles);
+
+    world->tiles = tile_grid_init();
+    world->tiles.revision = revision;
+    world->spawn_point = stream->map.spawn_point;
+
+    // the history describes the grid that was just dropped
+    edit_history_clear(&world->history);
+
+    update_tile_scroll_panel(import->palette->sprite_count + pending_imports(import->loader, import->upload), tile_scroll_panel);
+
+    TraceLog(LOG_INFO, "load_world: %zu tiles in %zu chunks, streaming with a %d MB budget", stream->map.cell_count, stream->map.chunk_count, WORLD_STREAM_BUDGET / (1024 * 1024));
+}
+
+void update_world_stream(const Rectangle container, const float padding, World* world, const WorldSettings* settings)
+{
+    if (!world || !world->stream || !settings)
+        return;
+
+    const Rectangle world_bounds = get_world_bounds(get_padded_rectangle(padding, container), settings->camera);
+
+    const int cx0 = tile_chunk_coord(floorf(world_bounds.x / settings->tile_size));
+    const int cy0 = tile_chunk_coord(floorf(world_bounds.y / settings->tile_size));
+    const int cx1 = tile_chunk_coord(floorf((world_bounds.x + world_bounds.width) / settings->tile_size));
+    const int cy1 = tile_chunk_coord(floorf((world_bounds.y + world_bounds.height) / settings->tile_size));
+
+    world_stream_update(world->stream, &world->tiles, cx0, cy0, cx1, cy1);
+}
+
+void handle_file_select(ScrollPanel* tile_scroll_panel, GuiWindowFileDialogState* file_dialog_state, World* world, MapImport* import)
+{
+    if (!tile_scroll_panel || !file_dialog_state || !world || !import) 
+        return;
+
+    AssetLoader* loader = import->loader;
+
+    AssetCache* cache = import->cache;
+    const TilePalette* tile_palette = import->palette;
 
     file_dialog_state->SelectFilePressed = false;
 
@@ -418,34 +1179,105 @@ void handle_file_select(ScrollPanel* tile_scroll_panel, GuiWindowFileDialogState
         return;
     }
 
+    if (is_file_extension(asset_path, MAP_FILE_EXTENSION)) {
+        load_world(asset_path, world, tile_scroll_panel, import);
+        return;
+    }
+
     if (!is_file_extension(asset_path, VALID_ASSET_EXTENSION)) {
-        fprintf(stderr, "handle_file_select: \"%s\" is not a %s\n", asset_path, VALID_ASSET_EXTENSION);
+        fprintf(stderr, "handle_file_select: \"%s\" is not a %s or %s\n", asset_path, VALID_ASSET_EXTENSION, MAP_FILE_EXTENSION);
         return;
     }
 
-    AssetEntry* existing = asset_cache_find(cache, hash_string(asset_path));
-    if (existing) {
+    AssetEntry* existing = asset_cache_find_path(cache, asset_path);
+    if (existing || asset_loader_is_pending(loader, hash_string(asset_path))) {
         fprintf(stderr, "handle_file_select: the asset \"%s\" is already in the cache\n", asset_path);
         return;
     }
 
-    AssetEntry* new_entry = asset_entry_init(asset_path);
-    if (!new_entry) {
-        fprintf(stderr, "handle_file_select: failed to create new AssetEntry object\n");
+    // decoding happens on the loader thread, process_decoded_assets picks the result up
+    if (!asset_loader_request(loader, asset_path, import->sprite_size, false)) {
+        fprintf(stderr, "handle_file_select: failed to queue \"%s\"\n", asset_path);
         return;
     }
 
-    asset_cache_add(cache, new_entry);
+    update_tile_scroll_panel(tile_palette->sprite_count + pending_imports(loader, import->upload), tile_scroll_panel);
+}
 
-    parse_asset_entry(new_entry, tile_palette, sprite_size);
-    
-    update_tile_scroll_panel(tile_palette->count, tile_scroll_panel);
+// asks the loader thread to decode every sheet whose file settled after a change
+void handle_asset_changes(AssetWatcher* watcher, AssetLoader* loader, AssetCache* cache, const TilePalette* tile_palette)
+{
+    if (!watcher || !loader || !cache || !tile_palette)
+        return;
+
+    unsigned long int id;
+
+    while (asset_watcher_poll(watcher, GetTime(), &id)) {
+        const AssetEntry* entry = asset_cache_find(cache, id);
+        const PaletteSheet* sheet = tile_palette_find_sheet(tile_palette, id);
+
+        // the sheet is split into the cells it was imported with
+        if (entry && sheet && !asset_loader_is_pending(loader, id) && !asset_loader_request(loader, entry->path, sheet->sprite_size, true))
+            fprintf(stderr, "handle_asset_changes: failed to queue \"%s\"\n", entry->path);
+    }
+}
+
+// uploads decoded sheets a slice at a time until the frame's budget runs out, the rest waits for the next frame
+// returns how many sheets were completed, their sprites now draw from the atlas
+size_t process_decoded_assets(ScrollPanel* tile_scroll_panel, SheetUpload* upload, AssetLoader* loader, AssetCache* cache, AssetWatcher* watcher, TilePalette* tile_palette, SpriteAtlas* atlas, AutotileSet* autotiles, long int* selected)
+{
+    if (!tile_scroll_panel || !upload || !loader || !cache || !tile_palette || !atlas)
+        return 0;
+
+    const double start = GetTime();
+    bool changed = false;
+    size_t completed = 0;
+
+    while ((GetTime() - start) < UPLOAD_BUDGET_SECONDS) {
+        if (!upload->asset.path) {
+            DecodedAsset decoded;
+            if (!asset_loader_poll(loader, &decoded))
+                break;
+
+            changed = true;
+
+            if (!sheet_upload_start(upload, &decoded, cache, watcher, tile_palette))
+                continue;
+        }
+
+        changed = true;
+
+        if (sheet_upload_step(upload, cache, tile_palette, atlas, autotiles, selected)) {
+            completed++;
+            sheet_upload_clear(upload);
+        }
+    }
+
+    if (changed)
+        update_tile_scroll_panel(tile_palette->sprite_count + pending_imports(loader, upload), tile_scroll_panel);
+
+    return completed;
 }
 
 // GuiWindowFileDialogState stuff
 
 // bounds update
 
+// keeps the minimap fitted around the map and the view, its texels in step with the chunks the grid lists dirty
+void update_minimap(const Rectangle container, const float padding, Minimap* minimap, World* world, const WorldSettings* settings)
+{
+    if (!minimap || !world || !settings)
+        return;
+
+    const Rectangle view = get_padded_rectangle(padding, container);
+    const Vector2 center = GetScreenToWorld2D((Vector2){ view.x + (view.width / 2), view.y + (view.height / 2) }, settings->camera);
+
+    const int cx = tile_chunk_coord(floorf(center.x / settings->tile_size));
+    const int cy = tile_chunk_coord(floorf(center.y / settings->tile_size));
+
+    minimap_update(minimap, &world->tiles, (world->stream) ? &world->stream->map : NULL, cx, cy);
+}
+
 void update_ui_zones(Rectangle* top_bar, Rectangle* side_bar, Rectangle* world_border)
 {
     if (!top_bar || !side_bar || !world_border)
@@ -459,7 +1291,7 @@ void update_ui_zones(Rectangle* top_bar, Rectangle* side_bar, Rectangle* world_b
 
 // bounds update
 
-// TODO: handle highlighting hovering nodes and the selected one 
+// TODO: handle highlighting hovering nodes
 // TODO: make PaletteManager struct to handle updates and input for the tile palette system?
 // TODO: make AssetManager to contain the cache and sprite size of the editing session?
 // TODO: better function to handle the updates in the scroll panels content rect and bound rect (scroll_panel_update)
@@ -475,15 +1307,60 @@ int main()
 
     editor_init();
 
-    List tile_palette = list_init();
+    TilePalette tile_palette = tile_palette_init();
+
+    AssetCache asset_cache = asset_cache_init(ASSET_TEXTURE_BUDGET);
 
-    AssetCache asset_cache = NULL;
+    AssetWatcher asset_watcher = asset_watcher_init();
+
+    AssetLoader asset_loader;
+    if (!asset_loader_init(&asset_loader)) {
+        asset_watcher_free(&asset_watcher);
+        editor_free();
+        return 1;
+    }
 
     GuiWindowFileDialogState file_dialog_state = InitGuiWindowFileDialog(GetWorkingDirectory());
 
     World world = world_init();
     WorldSettings world_settings = world_settings_init();
 
+    long int selected_tile = -1;
+
+    SpriteAtlas sprite_atlas = sprite_atlas_init();
+
+    AutotileSet autotiles = autotile_set_init();
+
+    SpriteSource sprite_source = {
+        .palette = &tile_palette,
+        .atlas = &sprite_atlas,
+        .cache = &asset_cache,
+    };
+
+    TileRenderer tile_renderer = tile_renderer_init(resolve_tile_sprite, &sprite_source);
+    tile_renderer_set_hold(&tile_renderer, hold_tile_texture);
+    GridRenderer grid_renderer = grid_renderer_init(Fade(BLACK, 0.4f), BLACK);
+
+    Minimap minimap = minimap_init(resolve_tile_color, &sprite_source);
+
+    FrameStats frame_stats = {0};
+    FrameTimes frame_times = {0};
+    FrameTimes world_draw_times = {0}; // main thread time spent submitting the world, what the chunk cache saves
+
+    SheetUpload sheet_upload = {0};
+
+    MapImport map_import = {
+        .cache = &asset_cache,
+        .palette = &tile_palette,
+        .loader = &asset_loader,
+        .upload = &sheet_upload,
+        .watcher = &asset_watcher,
+        .sprite_size = sprite_size,
+    };
+
+    bool save_pressed = false;
+    bool show_stats = false; // toggled with STATS_OVERLAY_TOGGLE_KEY
+
     Rectangle top_bar = {
         .x = 0,
         .y = 0,
@@ -515,13 +1392,42 @@ int main()
     {
         update_ui_zones(&top_bar, &side_bar, &world_border);
 
-        tile_scroll_panel.bounds = get_padded_rectangle(padding, side_bar);
+        Rectangle palette_zone, minimap_zone;
+        split_side_bar(side_bar, padding, &palette_zone, &minimap_zone);
+
+        tile_scroll_panel.bounds = get_padded_rectangle(padding, palette_zone);
 
         if (CheckCollisionPointRec(GetMousePosition(), world_border) && !file_dialog_state.windowActive) 
-            handle_world_input(&world_settings);
+            handle_world_input(&world_settings, &world, &tile_palette, &autotiles, selected_tile);
+
+        handle_tool_release(&world_settings, &world, &tile_palette, &autotiles, selected_tile);
+        handle_history_input(&world, !file_dialog_state.windowActive);
+        handle_render_input(&tile_renderer, !file_dialog_state.windowActive);
+        handle_overlay_input(&show_stats, !file_dialog_state.windowActive);
 
         if (file_dialog_state.SelectFilePressed) 
-            handle_file_select(&tile_scroll_panel, &file_dialog_state, &asset_cache, &tile_palette, sprite_size);
+            handle_file_select(&tile_scroll_panel, &file_dialog_state, &world, &map_import);
+
+        if (save_pressed) {
+            save_world(&world, &tile_palette, &asset_cache);
+            save_pressed = false;
+        }
+
+        handle_asset_changes(&asset_watcher, &asset_loader, &asset_cache, &tile_palette);
+
+        // new and reloaded pixels reach chunk textures and minimap texels only when those are drawn again,
+        // cells of a sheet that was still loading resolved to nothing the last time
+        if (process_decoded_assets(&tile_scroll_panel, &sheet_upload, &asset_loader, &asset_cache, &asset_watcher, &tile_palette, &sprite_atlas, &autotiles, &selected_tile) > 0) {
+            tile_renderer_invalidate(&tile_renderer);
+            minimap_invalidate(&minimap);
+        }
+
+        update_world_stream(world_border, padding, &world, &world_settings);
+
+        update_minimap(world_border, padding, &minimap, &world, &world_settings);
+
+        frame_stats = (FrameStats){0};
+        frame_times_push(&frame_times, GetFrameTime());
 
         BeginDrawing();
 
@@ -530,9 +1436,14 @@ int main()
             if (file_dialog_state.windowActive)
                 GuiLock();
             
-            draw_top_bar(top_bar, padding, &file_dialog_state.windowActive);
-            draw_world(world_border, padding, &world, &world_settings);
-            draw_side_bar(side_bar, &tile_scroll_panel, &tile_palette, sprite_size);
+            draw_top_bar(top_bar, padding, &file_dialog_state.windowActive, &save_pressed, &world_settings.tool);
+            const double world_draw_start = GetTime();
+            draw_world(world_border, padding, &world, &world_settings, &tile_renderer, &grid_renderer);
+            frame_times_push(&world_draw_times, GetTime() - world_draw_start);
+            draw_side_bar(minimap_zone, &tile_scroll_panel, &sprite_source, pending_imports(&asset_loader, &sheet_upload), &selected_tile, &frame_stats, &minimap, &world_settings, get_padded_rectangle(padding, world_border));
+
+            if (show_stats)
+                draw_stats_overlay(get_padded_rectangle(padding, world_border), &frame_stats, &frame_times, &world_draw_times, &tile_renderer, &grid_renderer, &world, &asset_cache);
             
             GuiUnlock();
 
@@ -541,9 +1452,26 @@ int main()
             DrawFPS(0, 0);
             
         EndDrawing();
+
+        // after the batch went out, nothing queued still samples an evicted texture
+        asset_cache_trim(&asset_cache);
     }
 
-    list_free(&tile_palette);
+    asset_loader_free(&asset_loader);
+
+    sheet_upload_clear(&sheet_upload);
+
+    asset_watcher_free(&asset_watcher);
+
+    tile_renderer_free(&tile_renderer);
+
+    minimap_free(&minimap);
+
+    sprite_atlas_free(&sprite_atlas);
+
+    autotile_set_free(&autotiles);
+
+    tile_palette_free(&tile_palette);
 
     asset_cache_free(&asset_cache);
 
@@ -0,0 +1,114 @@
+#include "grid_renderer.h"
+
+#include <math.h>
+
+#include "rlgl.h"
+
+GridRenderer grid_renderer_init(const Color minor_color, const Color major_color)
+{
+    return (GridRenderer) {
+        .minor_color = minor_color,
+        .major_color = major_color,
+        .level_count = 0,
+        .line_count = 0,
+        .vertex_count = 0,
+    };
+}
+
+// picks the line levels worth drawing, levels[0] is the densest, returns how many were written
+int grid_renderer_levels(const Rectangle world_bounds, const float cell_size, const float zoom, GridLevel* levels)
+{
+    if (!levels || (cell_size <= 0) || (zoom <= 0))
+        return 0;
+
+    // the larger of the two limits wins, keeping both the spacing readable and the line count fixed on big windows
+    const float extent = fmaxf(world_bounds.width, world_bounds.height) * zoom;
+    const float min_spacing = fmaxf(GRID_MIN_SPACING, extent / GRID_MAX_LINES);
+
+    // the minor level coarsens by whole major steps, so lines never shift as the view zooms out
+    float minor = cell_size;
+    while ((minor * zoom) < min_spacing)
+        minor *= GRID_MAJOR_EVERY;
+
+    const float fade = ((minor * zoom) - min_spacing) / (min_spacing * (GRID_FADE_RANGE - 1.0f));
+
+    levels[0] = (GridLevel) {
+        .spacing = minor,
+        .alpha = fminf(1.0f, fade),
+    };
+
+    levels[1] = (GridLevel) {
+        .spacing = minor * GRID_MAJOR_EVERY,
+        .alpha = 1.0f,
+    };
+
+    return GRID_MAX_LEVELS;
+}
+
+static size_t grid_emit_lines(const Rectangle bounds, const GridLevel level, const Color color, const bool skip_major)
+{
+    const float x1 = bounds.x + bounds.width;
+    const float y1 = bounds.y + bounds.height;
+
+    // integer line indices, accumulating the spacing would drift far from the origin
+    const long long i0 = ceilf(bounds.x / level.spacing), i1 = floorf(x1 / level.spacing);
+    const long long j0 = ceilf(bounds.y / level.spacing), j1 = floorf(y1 / level.spacing);
+
+    size_t lines = 0;
+
+    rlColor4ub(color.r, color.g, color.b, color.a * level.alpha);
+
+    for (long long i = i0; i <= i1; i++) {
+        if (skip_major && ((i % GRID_MAJOR_EVERY) == 0))
+            continue;
+
+        rlVertex2f(i * level.spacing, bounds.y);
+        rlVertex2f(i * level.spacing, y1);
+        lines++;
+    }
+
+    for (long long j = j0; j <= j1; j++) {
+        if (skip_major && ((j % GRID_MAJOR_EVERY) == 0))
+            continue;
+
+        rlVertex2f(bounds.x, j * level.spacing);
+        rlVertex2f(x1, j * level.spacing);
+        lines++;
+    }
+
+    return lines;
+}
+
+// submits every visible line as a single RL_LINES batch, drawn inside the caller's 2D mode
+void grid_renderer_draw(GridRenderer* renderer, const Rectangle world_bounds, const float cell_size, const float zoom)
+{
+    if (!renderer)
+        return;
+
+    renderer->level_count = 0;
+    renderer->line_count = 0;
+    renderer->vertex_count = 0;
+
+    GridLevel levels[GRID_MAX_LEVELS];
+    const int nlevels = grid_renderer_levels(world_bounds, cell_size, zoom, levels);
+    if (nlevels == 0)
+        return;
+
+    // upper bound for both levels, reserved up front so the batch is never split mid primitive
+    const float per_axis = (world_bounds.width + world_bounds.height) / levels[0].spacing + 4;
+    rlCheckRenderBatchLimit(per_axis * 2 * nlevels);
+
+    rlBegin(RL_LINES);
+        for (int l = 0; l < nlevels; l++) {
+            // the minor level skips the lines the major level draws on top
+            const bool is_minor = (l + 1) < nlevels;
+            if (levels[l].alpha <= 0)
+                continue;
+
+            renderer->line_count += grid_emit_lines(world_bounds, levels[l], is_minor ? renderer->minor_color : renderer->major_color, is_minor);
+            renderer->level_count++;
+        }
+    rlEnd();
+
+    renderer->vertex_count = renderer->line_count * 2;
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#ifndef GRID_RENDERER_H
+#define GRID_RENDERER_H
+
+#include <stddef.h>
+
+#include "raylib.h"
+
+#define GRID_MAJOR_EVERY 8    // minor lines between two major lines
+#define GRID_MIN_SPACING 4.0f // on screen pixels below which a line level is dropped
+#define GRID_FADE_RANGE 3.0f  // a level fades in between GRID_MIN_SPACING and this many times it
+#define GRID_MAX_LINES 512    // lines per axis and level, whatever the window size
+#define GRID_MAX_LEVELS 2     // minor and major
+
+typedef struct
+{
+    float spacing; // world units between two lines of the level
+    float alpha;   // 0 to 1, fades the level out as it gets denser
+} GridLevel;
+
+typedef struct
+{
+    Color minor_color;
+    Color major_color;
+
+    // per frame stats
+    int level_count;
+    size_t line_count;
+    size_t vertex_count;
+} GridRenderer;
+
+GridRenderer grid_renderer_init(const Color minor_color, const Color major_color);
+int grid_renderer_levels(const Rectangle world_bounds, const float cell_size, const float zoom, GridLevel* levels);
+void grid_renderer_draw(GridRenderer* renderer, const Rectangle world_bounds, const float cell_size, const float zoom);
+
+#endif
\ No newline at end of file
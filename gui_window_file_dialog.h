@@ -10,8 +10,6 @@
 *       DRAW: GuiWindowFileDialog(&state);
 *
 *   NOTE: This module depends on some raylib file system functions:
-*       - LoadDirectoryFiles()
-*       - UnloadDirectoryFiles()
 *       - GetWorkingDirectory()
 *       - DirectoryExists()
 *       - FileExists()
@@ -77,6 +75,8 @@ typedef struct {
 
     bool saveFileMode;
 
+    void *scanner;              // Background directory scan and thumbnail worker (FileDialogScanner), alive while the window is open
+
 } GuiWindowFileDialogState;
 
 #ifdef __cplusplus
@@ -118,12 +118,27 @@ void GuiWindowFileDialog(GuiWindowFileDialogState *state);
 #if defined(GUI_WINDOW_FILE_DIALOG_IMPLEMENTATION)
 
 #include <string.h>     // Required for: strcpy()
+#include <strings.h>    // Required for: strncasecmp()
+#include <stdio.h>      // Required for: snprintf(), fopen(), fread(), fwrite()
+#include <stdlib.h>     // Required for: getenv()
+#include <dirent.h>     // Required for: opendir(), readdir()
+#include <pthread.h>    // Required for: pthread_create(), pthread_mutex_lock(), pthread_cond_wait()
+#include <sys/stat.h>   // Required for: stat(), mkdir()
 
 //----------------------------------------------------------------------------------
 // Defines and Macros
 //----------------------------------------------------------------------------------
-#define MAX_DIRECTORY_FILES    2048
 #define MAX_ICON_PATH_LENGTH    512
+
+#define FILE_DIALOG_SCAN_BATCH          256     // Entries read before the worker looks at its queues again
+#define FILE_DIALOG_THUMB_SIZE           64     // Longest side of a thumbnail in pixels
+#define FILE_DIALOG_THUMB_QUEUE          64     // Thumbnail requests waiting for the worker, visible rows only
+#define FILE_DIALOG_MAX_THUMBS          512     // Thumbnail textures kept, the oldest is recycled past that
+#define FILE_DIALOG_PATH_BLOCK    (16*1024)     // First block of the path arena, later ones double
+#define FILE_DIALOG_PATH_BLOCK_MAX (1024*1024) // Largest block of the path arena
+#define FILE_DIALOG_MIN_SLIDER_SIZE     12     // Scroll bar slider never gets thinner on large listings
+#define FILE_DIALOG_THUMB_MAGIC  0x314d4854     // "THM1", first word of a cached thumbnail file
+#define FILE_DIALOG_IMAGE_EXTENSIONS    ".png;.bmp;.tga;.gif;.jpg;.jpeg;.psd;.hdr;.qoi;.dds;.pkm;.ktx;.pvr;.astc"
 #ifdef _WIN32
 #define PATH_SEPERATOR "\\"
 #else
@@ -147,10 +162,89 @@ typedef struct FileInfo {
 typedef char *FileInfo;             // Files are just a path string
 #endif
 
-//----------------------------------------------------------------------------------
-// Global Variables Definition
-//----------------------------------------------------------------------------------
-FileInfo *dirFilesIcon = NULL;      // Path string + icon (for fancy drawing)
+// What a listed entry is, picks its icon
+typedef enum {
+    FILE_KIND_DIRECTORY = 0,
+    FILE_KIND_IMAGE,
+    FILE_KIND_AUDIO,
+    FILE_KIND_TEXT,
+    FILE_KIND_BINARY,
+    FILE_KIND_OTHER
+} FileKind;
+
+// Thumbnail state of a listed file
+typedef enum {
+    THUMB_NONE = 0,                 // Not requested yet, not an image, or its texture was recycled
+    THUMB_REQUESTED,                // Queued for the worker
+    THUMB_READY,                    // Texture uploaded
+    THUMB_FAILED                    // Image could not be decoded
+} ThumbState;
+
+// Entry found by the worker, waiting for the main thread
+typedef struct ScannedFile {
+    size_t offset;                  // Start of the path in scannedText
+    unsigned char kind;             // FileKind
+} ScannedFile;
+
+// Listed entry, parallel to dirFiles.paths
+typedef struct ListedFile {
+    unsigned char kind;             // FileKind
+    unsigned char thumbState;       // ThumbState
+    int thumbSlot;                  // Texture in thumbs, -1 without one
+} ListedFile;
+
+// Block of the path arena, paths never move once stored
+typedef struct PathBlock {
+    struct PathBlock *next;         // Previous, smaller block
+    size_t used;
+    size_t capacity;
+    char data[];
+} PathBlock;
+
+// Thumbnail request or result, index is the row in dirFiles
+typedef struct ThumbJob {
+    unsigned int generation;        // Listing the row belongs to
+    int index;
+    char path[1024];
+    Image image;                    // Set on results, empty when decoding failed
+} ThumbJob;
+
+// Worker shared state, everything below the mutex is guarded by it
+typedef struct FileDialogScanner {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    bool running;
+    bool threaded;                  // False when the thread could not start, directories are then read on the main thread
+
+    unsigned int generation;        // Bumped by every reload, older results are dropped
+    bool scanRequested;
+    bool scanDone;
+    char scanPath[1024];
+    char scanFilter[256];
+
+    ScannedFile *scanned;           // Entries found since the main thread last looked, allocated
+    int scannedCount;
+    int scannedCapacity;
+    char *scannedText;              // Their paths, one after another, allocated
+    size_t scannedTextSize;
+    size_t scannedTextCapacity;
+
+    ThumbJob *requests;             // Pending thumbnail requests, FILE_DIALOG_THUMB_QUEUE entries
+    int requestCount;
+    ThumbJob *results;              // Decoded thumbnails, FILE_DIALOG_THUMB_QUEUE entries
+    int resultCount;
+
+    char cacheDir[1024];            // On-disk thumbnail cache, empty when it could not be created
+
+    // Main thread only
+    bool listed;                    // Copy of scanDone taken by UpdateDirectoryFiles()
+    PathBlock *paths;               // Arena holding every listed path, newest block first
+    ListedFile *files;              // One per listed path, dirFiles.capacity entries
+    Texture2D thumbs[FILE_DIALOG_MAX_THUMBS];   // Most recent thumbnail uploads
+    int thumbOwners[FILE_DIALOG_MAX_THUMBS];    // Listed file shown by each texture, -1 when unused
+    int nextThumb;                  // Slot the next upload replaces, the oldest one
+} FileDialogScanner;
 
 //----------------------------------------------------------------------------------
 // Internal Module Functions Definition
@@ -158,6 +252,15 @@ FileInfo *dirFilesIcon = NULL;      // Path string + icon (for fancy drawing)
 // Read files in new path
 static void ReloadDirectoryFiles(GuiWindowFileDialogState *state);
 
+// Background scan and thumbnails
+static FileDialogScanner *StartFileDialogScanner(void);
+static void StopFileDialogScanner(FileDialogScanner *scanner);
+static void UpdateDirectoryFiles(GuiWindowFileDialogState *state);
+static void DrawFileThumbnails(GuiWindowFileDialogState *state, Rectangle listBounds);
+
+// List View control for the listing, only the visible rows are formatted
+static void GuiListViewDirFiles(Rectangle bounds, GuiWindowFileDialogState *state);
+
 #if defined(USE_CUSTOM_LISTVIEW_FILEINFO)
 // List View control for files info with extended parameters
 static int GuiListViewFiles(Rectangle bounds, FileInfo *files, int count, int *focus, int *scrollIndex, int active);
@@ -255,22 +358,23 @@ void GuiWindowFileDialog(GuiWindowFileDialogState *state)
         }
         //----------------------------------------------------------------------------------------
 
-        // Load dirFilesIcon and state->dirFiles lazily on windows open
+        // Load state->dirFiles lazily on windows open
         // NOTE: They are automatically unloaded at fileDialog closing
         //----------------------------------------------------------------------------------------
-        if (dirFilesIcon == NULL)
-        {
-            dirFilesIcon = (FileInfo *)RL_CALLOC(MAX_DIRECTORY_FILES, sizeof(FileInfo));    // Max files to read
-            for (int i = 0; i < MAX_DIRECTORY_FILES; i++) dirFilesIcon[i] = (char *)RL_CALLOC(MAX_ICON_PATH_LENGTH, 1);    // Max file name length
-        }
+        if (state->scanner == NULL) state->scanner = StartFileDialogScanner();
 
         // Load current directory files
         if (state->dirFiles.paths == NULL) ReloadDirectoryFiles(state);
+
+        // Take the entries and thumbnails the worker produced since last frame
+        UpdateDirectoryFiles(state);
         //----------------------------------------------------------------------------------------
 
         // Draw window and controls
         //----------------------------------------------------------------------------------------
-        state->windowActive = !GuiWindowBox(state->windowBounds, "#198# Select File Dialog");
+        const FileDialogScanner *scanner = (const FileDialogScanner *)state->scanner;
+        const bool scanning = (scanner != NULL) && !scanner->listed;
+        state->windowActive = !GuiWindowBox(state->windowBounds, scanning? TextFormat("#198# Select File Dialog (scanning, %i files)", (int)state->dirFiles.count) : "#198# Select File Dialog");
 
         // Draw previous directory button + logic
         if (GuiButton((Rectangle){ state->windowBounds.x + state->windowBounds.width - 48, state->windowBounds.y + 24 + 12, 40, 24 }, "< .."))
@@ -313,8 +417,9 @@ void GuiWindowFileDialog(GuiWindowFileDialogState *state)
 # if defined(USE_CUSTOM_LISTVIEW_FILEINFO)
         state->filesListActive = GuiListViewFiles((Rectangle){ state->position.x + 8, state->position.y + 48 + 20, state->windowBounds.width - 16, state->windowBounds.height - 60 - 16 - 68 }, fileInfo, state->dirFiles.count, &state->itemFocused, &state->filesListScrollIndex, state->filesListActive);
 # else
-        GuiListViewEx((Rectangle){ state->windowBounds.x + 8, state->windowBounds.y + 48 + 20, state->windowBounds.width - 16, state->windowBounds.height - 60 - 16 - 68 }, 
-                      (const char**)dirFilesIcon, state->dirFiles.count, &state->filesListScrollIndex, &state->filesListActive, &state->itemFocused);
+        Rectangle listBounds = { state->windowBounds.x + 8, state->windowBounds.y + 48 + 20, state->windowBounds.width - 16, state->windowBounds.height - 60 - 16 - 68 };
+        GuiListViewDirFiles(listBounds, state);
+        DrawFileThumbnails(state, listBounds);
 # endif
         GuiSetStyle(LISTVIEW, TEXT_ALIGNMENT, prevTextAlignment);
         GuiSetStyle(LISTVIEW, LIST_ITEMS_HEIGHT, prevElementsHeight);
@@ -389,14 +494,12 @@ void GuiWindowFileDialog(GuiWindowFileDialogState *state)
         // File dialog has been closed, free all memory before exit
         if (!state->windowActive)
         {
-            // Free dirFilesIcon memory
-            for (int i = 0; i < MAX_DIRECTORY_FILES; i++) RL_FREE(dirFilesIcon[i]);
-
-            RL_FREE(dirFilesIcon);
-            dirFilesIcon = NULL;
+            // Stop the worker, unload the thumbnails and the path arena of the listing
+            StopFileDialogScanner((FileDialogScanner *)state->scanner);
+            state->scanner = NULL;
 
-            // Unload directory file paths
-            UnloadDirectoryFiles(state->dirFiles);
+            // Unload directory file paths, the strings went with the arena
+            RL_FREE(state->dirFiles.paths);
 
             // Reset state variables
             state->dirFiles.count = 0;
@@ -421,47 +524,846 @@ static inline int FileCompare(const char *d1, const char *d2, const char *dir)
     return strcmp(d1, d2);
 }
 
+// Worker side: IsFileExtension() formats into shared static buffers, this one is safe off the main thread
+static bool HasFileExtension(const char *path, const char *filter)
+{
+    const char *dot = strrchr(path, '.');
+    if ((dot == NULL) || (strchr(dot, '/') != NULL)) return false;
+
+    const size_t length = strlen(dot);
+
+    for (const char *ext = filter; *ext != '\0'; )
+    {
+        const char *end = strchr(ext, ';');
+        const size_t extLength = (end != NULL)? (size_t)(end - ext) : strlen(ext);
+
+        if ((extLength == length) && (strncasecmp(ext, dot, length) == 0)) return true;
+
+        if (end == NULL) break;
+        ext = end + 1;
+    }
+
+    return false;
+}
+
+// Worker side: kind of an entry, decided once while scanning
+static unsigned char GetFileKind(const char *path, bool isDir)
+{
+    if (isDir) return FILE_KIND_DIRECTORY;
+    if (HasFileExtension(path, FILE_DIALOG_IMAGE_EXTENSIONS)) return FILE_KIND_IMAGE;
+    if (HasFileExtension(path, ".wav;.mp3;.ogg;.flac;.xm;.mod;.it;.wma;.aiff")) return FILE_KIND_AUDIO;
+    if (HasFileExtension(path, ".txt;.info;.md;.nfo;.xml;.json;.c;.cpp;.cs;.lua;.py;.glsl;.vs;.fs")) return FILE_KIND_TEXT;
+    if (HasFileExtension(path, ".exe;.bin;.raw;.msi")) return FILE_KIND_BINARY;
+
+    return FILE_KIND_OTHER;
+}
+
+// Icon + file name shown in the list for a path
+static void FormatFileIcon(char *text, const char *path, unsigned char kind)
+{
+    static const int kindIcons[] = { 1, 12, 11, 10, 200, 218 };     // Directory, image, audio, text, binary, other
+
+    snprintf(text, MAX_ICON_PATH_LENGTH, "#%i#%s", kindIcons[(kind <= FILE_KIND_OTHER)? kind : FILE_KIND_OTHER], GetFileName(path));
+}
+
+// Forget the thumbnails of the previous listing, results still in flight are dropped by generation
+static void ClearFileThumbnails(FileDialogScanner *scanner)
+{
+    for (int i = 0; i < FILE_DIALOG_MAX_THUMBS; i++)
+    {
+        if (scanner->thumbOwners[i] >= 0) UnloadTexture(scanner->thumbs[i]);
+
+        scanner->thumbs[i] = (Texture2D){ 0 };
+        scanner->thumbOwners[i] = -1;
+    }
+
+    scanner->nextThumb = 0;
+}
+
+// Copies a path into the arena, blocks double up to FILE_DIALOG_PATH_BLOCK_MAX so a listing takes few of them
+static char *StoreFilePath(FileDialogScanner *scanner, const char *path, size_t length)
+{
+    PathBlock *block = scanner->paths;
+
+    if ((block == NULL) || ((block->used + length + 1) > block->capacity))
+    {
+        size_t capacity = (block != NULL)? block->capacity*2 : FILE_DIALOG_PATH_BLOCK;
+        if (capacity > FILE_DIALOG_PATH_BLOCK_MAX) capacity = FILE_DIALOG_PATH_BLOCK_MAX;
+        if (capacity < (length + 1)) capacity = length + 1;
+
+        PathBlock *next = (PathBlock *)RL_MALLOC(sizeof(PathBlock) + capacity);
+        if (next == NULL) return NULL;
+
+        next->next = block;
+        next->used = 0;
+        next->capacity = capacity;
+
+        scanner->paths = next;
+        block = next;
+    }
+
+    char *copy = block->data + block->used;
+    memcpy(copy, path, length + 1);
+    block->used += length + 1;
+
+    return copy;
+}
+
+// Releases the arena, every path of the listing goes with it
+static void FreeFilePaths(FileDialogScanner *scanner)
+{
+    while (scanner->paths != NULL)
+    {
+        PathBlock *next = scanner->paths->next;
+        RL_FREE(scanner->paths);
+        scanner->paths = next;
+    }
+}
+
+// Hands one entry to the main thread, false once the listing was replaced meanwhile
+static bool PushScannedFile(FileDialogScanner *scanner, unsigned int generation, const char *path, unsigned char kind)
+{
+    const size_t size = strlen(path) + 1;
+
+    pthread_mutex_lock(&scanner->lock);
+
+    const bool current = (generation == scanner->generation) && !scanner->scanRequested;
+
+    if (current)
+    {
+        if (scanner->scannedCount == scanner->scannedCapacity)
+        {
+            const int capacity = (scanner->scannedCapacity > 0)? scanner->scannedCapacity*2 : FILE_DIALOG_SCAN_BATCH*4;
+
+            ScannedFile *scanned = (ScannedFile *)RL_REALLOC(scanner->scanned, capacity*sizeof(ScannedFile));
+            if (scanned != NULL)
+            {
+                scanner->scanned = scanned;
+                scanner->scannedCapacity = capacity;
+            }
+        }
+
+        if ((scanner->scannedTextSize + size) > scanner->scannedTextCapacity)
+        {
+            size_t capacity = (scanner->scannedTextCapacity > 0)? scanner->scannedTextCapacity*2 : FILE_DIALOG_PATH_BLOCK;
+            while (capacity < (scanner->scannedTextSize + size)) capacity *= 2;
+
+            char *text = (char *)RL_REALLOC(scanner->scannedText, capacity);
+            if (text != NULL)
+            {
+                scanner->scannedText = text;
+                scanner->scannedTextCapacity = capacity;
+            }
+        }
+
+        if ((scanner->scannedCount < scanner->scannedCapacity) && ((scanner->scannedTextSize + size) <= scanner->scannedTextCapacity))
+        {
+            memcpy(scanner->scannedText + scanner->scannedTextSize, path, size);
+            scanner->scanned[scanner->scannedCount++] = (ScannedFile){ scanner->scannedTextSize, kind };
+            scanner->scannedTextSize += size;
+        }
+    }
+
+    pthread_mutex_unlock(&scanner->lock);
+
+    return current;
+}
+
+// Reads up to a batch of entries, true once the directory is exhausted or the listing was replaced
+static bool ReadDirectoryBatch(FileDialogScanner *scanner, DIR *dir, const char *dirPath, const char *filter, unsigned int generation)
+{
+    for (int i = 0; i < FILE_DIALOG_SCAN_BATCH; i++)
+    {
+        struct dirent *entry = readdir(dir);
+        if (entry == NULL) return true;
+
+        if ((strcmp(entry->d_name, ".") == 0) || (strcmp(entry->d_name, "..") == 0)) continue;
+
+        char path[1024] = { 0 };
+        snprintf(path, sizeof(path), "%s%s%s", dirPath, (strcmp(dirPath, PATH_SEPERATOR) == 0)? "" : PATH_SEPERATOR, entry->d_name);
+
+        // The entry type avoids a stat per file on file systems that report it
+        bool isDir = (entry->d_type == DT_DIR);
+        if (entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK)
+        {
+            struct stat info = { 0 };
+            isDir = (stat(path, &info) == 0) && S_ISDIR(info.st_mode);
+        }
+
+        if (!isDir && (filter[0] != '\0') && !HasFileExtension(path, filter)) continue;
+
+        if (!PushScannedFile(scanner, generation, path, GetFileKind(path, isDir))) return true;
+    }
+
+    return false;
+}
+
+// Without a worker the requested directory is read whole, on the calling thread
+static void ScanDirectoryFiles(FileDialogScanner *scanner)
+{
+    char dirPath[1024] = { 0 };
+    char filter[256] = { 0 };
+
+    pthread_mutex_lock(&scanner->lock);
+
+    scanner->scanRequested = false;
+    const unsigned int generation = scanner->generation;
+    strcpy(dirPath, scanner->scanPath);
+    strcpy(filter, scanner->scanFilter);
+
+    pthread_mutex_unlock(&scanner->lock);
+
+    DIR *dir = opendir(dirPath);
+
+    if (dir != NULL)
+    {
+        while (!ReadDirectoryBatch(scanner, dir, dirPath, filter, generation)) { }
+        closedir(dir);
+    }
+
+    pthread_mutex_lock(&scanner->lock);
+    scanner->scanDone = true;
+    pthread_mutex_unlock(&scanner->lock);
+}
+
 // Read files in new path
+// NOTE: The listing starts empty, entries stream in from the worker through UpdateDirectoryFiles()
 static void ReloadDirectoryFiles(GuiWindowFileDialogState *state)
 {
-    UnloadDirectoryFiles(state->dirFiles);
+    FileDialogScanner *scanner = (FileDialogScanner *)state->scanner;
 
-    state->dirFiles = LoadDirectoryFilesEx(state->dirPathText, (state->filterExt[0] == '\0')? NULL : state->filterExt, false);
+    // Paths point into the scanner arena, only the array holding them belongs to dirFiles
+    RL_FREE(state->dirFiles.paths);
+
+    state->dirFiles.capacity = FILE_DIALOG_SCAN_BATCH;
+    state->dirFiles.count = 0;
+    state->dirFiles.paths = (char **)RL_CALLOC(state->dirFiles.capacity, sizeof(char *));
     state->itemFocused = 0;
 
-    // Reset dirFilesIcon memory
-    for (int i = 0; i < MAX_DIRECTORY_FILES; i++) memset(dirFilesIcon[i], 0, MAX_ICON_PATH_LENGTH);
+    if (state->dirFiles.paths == NULL) state->dirFiles.capacity = 0;
+    if (scanner == NULL) return;
+
+    ClearFileThumbnails(scanner);
+    FreeFilePaths(scanner);
+
+    RL_FREE(scanner->files);
+    scanner->files = (ListedFile *)RL_CALLOC(state->dirFiles.capacity, sizeof(ListedFile));
+    if (scanner->files == NULL) state->dirFiles.capacity = 0;
+
+    pthread_mutex_lock(&scanner->lock);
+
+    scanner->generation++;
+    scanner->scanRequested = true;
+    scanner->scanDone = false;
+    strncpy(scanner->scanPath, state->dirPathText, sizeof(scanner->scanPath) - 1);
+    strncpy(scanner->scanFilter, state->filterExt, sizeof(scanner->scanFilter) - 1);
+
+    scanner->scannedCount = 0;
+    scanner->scannedTextSize = 0;
 
-    // Copy paths as icon + fileNames into dirFilesIcon
-    for (int i = 0; i < state->dirFiles.count; i++)
+    scanner->requestCount = 0;
+    for (int i = 0; i < scanner->resultCount; i++) UnloadImage(scanner->results[i].image);
+    scanner->resultCount = 0;
+
+    pthread_cond_signal(&scanner->wake);
+    pthread_mutex_unlock(&scanner->lock);
+
+    scanner->listed = false;
+
+    if (!scanner->threaded) ScanDirectoryFiles(scanner);
+}
+
+// 64-bit FNV-1a, continued from a previous hash
+static unsigned long long HashThumbnailKey(unsigned long long hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = (const unsigned char *)data;
+
+    for (size_t i = 0; i < size; i++)
     {
-        if (IsPathFile(state->dirFiles.paths[i]))
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+// Cached thumbnails are the raw R8G8B8A8 pixels behind a magic word and the size
+static Image ReadCachedThumbnail(const char *cachePath)
+{
+    Image thumb = { 0 };
+
+    FILE *file = fopen(cachePath, "rb");
+    if (file == NULL) return thumb;
+
+    unsigned int header[3] = { 0 };
+
+    if ((fread(header, sizeof(header), 1, file) == 1) && (header[0] == FILE_DIALOG_THUMB_MAGIC) &&
+        (header[1] > 0) && (header[1] <= FILE_DIALOG_THUMB_SIZE) && (header[2] > 0) && (header[2] <= FILE_DIALOG_THUMB_SIZE))
+    {
+        const size_t size = (size_t)header[1]*header[2]*4;
+        void *pixels = RL_MALLOC(size);
+
+        if ((pixels != NULL) && (fread(pixels, size, 1, file) == 1))
         {
-            // Path is a file, a file icon for convenience (for some recognized extensions)
-            if (IsFileExtension(state->dirFiles.paths[i], ".png;.bmp;.tga;.gif;.jpg;.jpeg;.psd;.hdr;.qoi;.dds;.pkm;.ktx;.pvr;.astc"))
-            {
-                strcpy(dirFilesIcon[i], TextFormat("#12#%s", GetFileName(state->dirFiles.paths[i])));
-            }
-            else if (IsFileExtension(state->dirFiles.paths[i], ".wav;.mp3;.ogg;.flac;.xm;.mod;.it;.wma;.aiff"))
+            thumb = (Image){ pixels, (int)header[1], (int)header[2], 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+        }
+        else RL_FREE(pixels);
+    }
+
+    fclose(file);
+
+    return thumb;
+}
+
+// Written to a temporary name first so a reader never sees half a file
+static void WriteCachedThumbnail(const char *cachePath, Image thumb)
+{
+    char tempPath[1100] = { 0 };
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", cachePath);
+
+    FILE *file = fopen(tempPath, "wb");
+    if (file == NULL) return;
+
+    const unsigned int header[3] = { FILE_DIALOG_THUMB_MAGIC, (unsigned int)thumb.width, (unsigned int)thumb.height };
+    const bool written = (fwrite(header, sizeof(header), 1, file) == 1) && (fwrite(thumb.data, (size_t)thumb.width*thumb.height*4, 1, file) == 1);
+
+    if ((fclose(file) == 0) && written) rename(tempPath, cachePath);
+    else remove(tempPath);
+}
+
+// Worker side: thumbnail of an image file, from the disk cache when path, modification time and size still match
+static Image LoadFileThumbnail(const FileDialogScanner *scanner, const char *path)
+{
+    struct stat info = { 0 };
+    if (stat(path, &info) != 0) return (Image){ 0 };
+
+    char cachePath[1100] = { 0 };
+
+    if (scanner->cacheDir[0] != '\0')
+    {
+        const long long modTime = (long long)info.st_mtime;
+        const long long fileSize = (long long)info.st_size;
+
+        unsigned long long key = HashThumbnailKey(14695981039346656037ULL, path, strlen(path));
+        key = HashThumbnailKey(key, &modTime, sizeof(modTime));
+        key = HashThumbnailKey(key, &fileSize, sizeof(fileSize));
+
+        snprintf(cachePath, sizeof(cachePath), "%s/%016llx.thumb", scanner->cacheDir, key);
+
+        Image cached = ReadCachedThumbnail(cachePath);
+        if (cached.data != NULL) return cached;
+    }
+
+    Image image = LoadImage(path);
+    if (image.data == NULL) return image;
+
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+    // Keep the aspect ratio, the longest side fits the thumbnail size
+    if ((image.width > FILE_DIALOG_THUMB_SIZE) || (image.height > FILE_DIALOG_THUMB_SIZE))
+    {
+        const float scale = (float)FILE_DIALOG_THUMB_SIZE/((image.width > image.height)? image.width : image.height);
+        int width = (int)(image.width*scale);
+        int height = (int)(image.height*scale);
+
+        ImageResize(&image, (width > 0)? width : 1, (height > 0)? height : 1);
+    }
+
+    if ((cachePath[0] != '\0') && (image.format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8)) WriteCachedThumbnail(cachePath, image);
+
+    return image;
+}
+
+// Worker thread: reads requested directories a batch at a time, decoding thumbnails in between
+static void *FileDialogWork(void *arg)
+{
+    FileDialogScanner *scanner = (FileDialogScanner *)arg;
+
+    DIR *dir = NULL;
+    unsigned int dirGeneration = 0;
+    char dirPath[1024] = { 0 };
+    char filter[256] = { 0 };
+
+    pthread_mutex_lock(&scanner->lock);
+
+    while (scanner->running)
+    {
+        if (!scanner->scanRequested && (dir == NULL) && (scanner->requestCount == 0))
+        {
+            pthread_cond_wait(&scanner->wake, &scanner->lock);
+            continue;
+        }
+
+        if (scanner->scanRequested)
+        {
+            // A new listing replaces whatever was being read
+            scanner->scanRequested = false;
+            dirGeneration = scanner->generation;
+            strcpy(dirPath, scanner->scanPath);
+            strcpy(filter, scanner->scanFilter);
+
+            pthread_mutex_unlock(&scanner->lock);
+
+            if (dir != NULL) closedir(dir);
+            dir = opendir(dirPath);
+
+            pthread_mutex_lock(&scanner->lock);
+
+            if ((dir == NULL) && (dirGeneration == scanner->generation)) scanner->scanDone = true;
+        }
+        else if (dir != NULL)
+        {
+            pthread_mutex_unlock(&scanner->lock);
+
+            const bool finished = ReadDirectoryBatch(scanner, dir, dirPath, filter, dirGeneration);
+
+            if (finished)
             {
-                strcpy(dirFilesIcon[i], TextFormat("#11#%s", GetFileName(state->dirFiles.paths[i])));
+                closedir(dir);
+                dir = NULL;
             }
-            else if (IsFileExtension(state->dirFiles.paths[i], ".txt;.info;.md;.nfo;.xml;.json;.c;.cpp;.cs;.lua;.py;.glsl;.vs;.fs"))
+
+            pthread_mutex_lock(&scanner->lock);
+
+            if (finished && (dirGeneration == scanner->generation) && !scanner->scanRequested) scanner->scanDone = true;
+        }
+        else
+        {
+            // Newest request first, the rows on screen right now
+            ThumbJob job = scanner->requests[--scanner->requestCount];
+
+            pthread_mutex_unlock(&scanner->lock);
+
+            job.image = LoadFileThumbnail(scanner, job.path);
+
+            pthread_mutex_lock(&scanner->lock);
+
+            if ((job.generation == scanner->generation) && (scanner->resultCount < FILE_DIALOG_THUMB_QUEUE)) scanner->results[scanner->resultCount++] = job;
+            else UnloadImage(job.image);
+        }
+    }
+
+    pthread_mutex_unlock(&scanner->lock);
+
+    if (dir != NULL) closedir(dir);
+
+    return NULL;
+}
+
+// Thumbnails live under $XDG_CACHE_HOME (or ~/.cache), created on first use
+static void InitThumbnailCacheDir(char *cacheDir, size_t size)
+{
+    const char *base = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+
+    cacheDir[0] = '\0';
+
+    // A path that does not fit leaves cacheDir empty, a truncated one would name some other directory
+    char root[1024] = { 0 };
+    int length = -1;
+    if ((base != NULL) && (base[0] != '\0')) length = snprintf(root, sizeof(root), "%s", base);
+    else if ((home != NULL) && (home[0] != '\0')) length = snprintf(root, sizeof(root), "%s/.cache", home);
+    if ((length < 0) || (length >= (int)sizeof(root))) return;
+
+    // Sized for the longest root, neither step below can truncate
+    char path[sizeof(root) + sizeof("/world_builder/thumbnails")] = { 0 };
+    length = snprintf(path, sizeof(path), "%s/world_builder", root);
+
+    mkdir(root, 0755);
+    mkdir(path, 0755);
+    snprintf(path + length, sizeof(path) - length, "/thumbnails");
+    mkdir(path, 0755);
+
+    length = strlen(path);
+    if (DirectoryExists(path) && (length < (int)size)) memcpy(cacheDir, path, length + 1);
+}
+
+static FileDialogScanner *StartFileDialogScanner(void)
+{
+    FileDialogScanner *scanner = (FileDialogScanner *)RL_CALLOC(1, sizeof(FileDialogScanner));
+    if (scanner == NULL) return NULL;
+
+    scanner->requests = (ThumbJob *)RL_CALLOC(FILE_DIALOG_THUMB_QUEUE, sizeof(ThumbJob));
+    scanner->results = (ThumbJob *)RL_CALLOC(FILE_DIALOG_THUMB_QUEUE, sizeof(ThumbJob));
+    scanner->running = true;
+    scanner->scanDone = true;
+    scanner->listed = true;
+
+    for (int i = 0; i < FILE_DIALOG_MAX_THUMBS; i++) scanner->thumbOwners[i] = -1;
+
+    if ((scanner->requests == NULL) || (scanner->results == NULL))
+    {
+        RL_FREE(scanner->requests);
+        RL_FREE(scanner->results);
+        RL_FREE(scanner);
+        return NULL;
+    }
+
+    InitThumbnailCacheDir(scanner->cacheDir, sizeof(scanner->cacheDir));
+
+    pthread_mutex_init(&scanner->lock, NULL);
+    pthread_cond_init(&scanner->wake, NULL);
+
+    // Without the thread listings are still read, only on the main thread and without thumbnails
+    scanner->threaded = (pthread_create(&scanner->thread, NULL, FileDialogWork, scanner) == 0);
+    if (!scanner->threaded) TraceLog(LOG_WARNING, "FILEDIALOG: Failed to start the directory worker");
+
+    return scanner;
+}
+
+static void StopFileDialogScanner(FileDialogScanner *scanner)
+{
+    if (scanner == NULL) return;
+
+    if (scanner->threaded)
+    {
+        pthread_mutex_lock(&scanner->lock);
+        scanner->running = false;
+        pthread_cond_signal(&scanner->wake);
+        pthread_mutex_unlock(&scanner->lock);
+
+        pthread_join(scanner->thread, NULL);
+    }
+
+    pthread_mutex_destroy(&scanner->lock);
+    pthread_cond_destroy(&scanner->wake);
+
+    ClearFileThumbnails(scanner);
+    FreeFilePaths(scanner);
+
+    for (int i = 0; i < scanner->resultCount; i++) UnloadImage(scanner->results[i].image);
+
+    RL_FREE(scanner->scanned);
+    RL_FREE(scanner->scannedText);
+    RL_FREE(scanner->requests);
+    RL_FREE(scanner->results);
+    RL_FREE(scanner->files);
+    RL_FREE(scanner);
+}
+
+// Grows the paths array and its per file state together, false when memory ran out
+static bool ReserveDirectoryFiles(GuiWindowFileDialogState *state, unsigned int count)
+{
+    FileDialogScanner *scanner = (FileDialogScanner *)state->scanner;
+    if (count <= state->dirFiles.capacity) return true;
+
+    unsigned int capacity = (state->dirFiles.capacity > 0)? state->dirFiles.capacity : FILE_DIALOG_SCAN_BATCH;
+    while (capacity < count) capacity *= 2;
+
+    char **paths = (char **)RL_REALLOC(state->dirFiles.paths, capacity*sizeof(char *));
+    if (paths == NULL) return false;
+    state->dirFiles.paths = paths;
+
+    ListedFile *files = (ListedFile *)RL_REALLOC(scanner->files, capacity*sizeof(ListedFile));
+    if (files == NULL) return false;
+    scanner->files = files;
+
+    state->dirFiles.capacity = capacity;
+
+    return true;
+}
+
+// Gives a decoded thumbnail a texture, recycling the oldest one once all slots are taken
+static void StoreFileThumbnail(FileDialogScanner *scanner, int index, Image image)
+{
+    ListedFile *file = &scanner->files[index];
+
+    const Texture2D texture = (image.data != NULL)? LoadTextureFromImage(image) : (Texture2D){ 0 };
+    if (texture.id == 0)
+    {
+        file->thumbState = THUMB_FAILED;
+        return;
+    }
+
+    const int slot = scanner->nextThumb;
+    scanner->nextThumb = (slot + 1)%FILE_DIALOG_MAX_THUMBS;
+
+    // The previous owner asks again if its row comes back into view
+    if (scanner->thumbOwners[slot] >= 0)
+    {
+        ListedFile *owner = &scanner->files[scanner->thumbOwners[slot]];
+        owner->thumbState = THUMB_NONE;
+        owner->thumbSlot = -1;
+
+        UnloadTexture(scanner->thumbs[slot]);
+    }
+
+    scanner->thumbs[slot] = texture;
+    scanner->thumbOwners[slot] = index;
+
+    file->thumbState = THUMB_READY;
+    file->thumbSlot = slot;
+}
+
+// Main thread side: appends the entries found since last frame and uploads finished thumbnails
+static void UpdateDirectoryFiles(GuiWindowFileDialogState *state)
+{
+    FileDialogScanner *scanner = (FileDialogScanner *)state->scanner;
+    if ((scanner == NULL) || (scanner->files == NULL) || (state->dirFiles.paths == NULL)) return;
+
+    pthread_mutex_lock(&scanner->lock);
+
+    // Paths move from the worker buffer into the arena, which only grows until the next reload
+    if (ReserveDirectoryFiles(state, state->dirFiles.count + scanner->scannedCount))
+    {
+        for (int i = 0; i < scanner->scannedCount; i++)
+        {
+            const ScannedFile file = scanner->scanned[i];
+            const char *text = scanner->scannedText + file.offset;
+
+            char *path = StoreFilePath(scanner, text, strlen(text));
+            if (path == NULL) break;
+
+            scanner->files[state->dirFiles.count] = (ListedFile){ file.kind, THUMB_NONE, -1 };
+            state->dirFiles.paths[state->dirFiles.count++] = path;
+        }
+    }
+
+    scanner->scannedCount = 0;
+    scanner->scannedTextSize = 0;
+    scanner->listed = scanner->scanDone;
+
+    ThumbJob results[FILE_DIALOG_THUMB_QUEUE];
+    const int resultCount = scanner->resultCount;
+    memcpy(results, scanner->results, resultCount*sizeof(ThumbJob));
+    scanner->resultCount = 0;
+
+    const unsigned int generation = scanner->generation;
+
+    pthread_mutex_unlock(&scanner->lock);
+
+    // Uploads happen outside the lock, the worker keeps going meanwhile
+    for (int i = 0; i < resultCount; i++)
+    {
+        const ThumbJob job = results[i];
+
+        if ((job.generation == generation) && (job.index >= 0) && (job.index < (int)state->dirFiles.count)) StoreFileThumbnail(scanner, job.index, job.image);
+
+        UnloadImage(job.image);
+    }
+}
+
+// Draws the thumbnails of the visible image rows over their icons and asks for the missing ones
+static void DrawFileThumbnails(GuiWindowFileDialogState *state, Rectangle listBounds)
+{
+    FileDialogScanner *scanner = (FileDialogScanner *)state->scanner;
+    const int count = (int)state->dirFiles.count;
+    if ((scanner == NULL) || (count == 0)) return;
+
+    // Same layout GuiListViewDirFiles() uses for its rows
+    const int itemHeight = GuiGetStyle(LISTVIEW, LIST_ITEMS_HEIGHT);
+    const int itemSpacing = GuiGetStyle(LISTVIEW, LIST_ITEMS_SPACING);
+    const bool useScrollBar = ((float)(itemHeight + itemSpacing)*count > listBounds.height);
+
+    int visibleItems = (int)listBounds.height/(itemHeight + itemSpacing);
+    if (visibleItems > count) visibleItems = count;
+
+    int startIndex = state->filesListScrollIndex;
+    if ((startIndex < 0) || (startIndex > (count - visibleItems))) startIndex = 0;
+
+    Rectangle itemBounds = { 0 };
+    itemBounds.x = listBounds.x + itemSpacing;
+    itemBounds.y = listBounds.y + itemSpacing + GuiGetStyle(DEFAULT, BORDER_WIDTH);
+    itemBounds.width = listBounds.width - 2*itemSpacing - GuiGetStyle(DEFAULT, BORDER_WIDTH);
+    itemBounds.height = (float)itemHeight;
+    if (useScrollBar) itemBounds.width -= GuiGetStyle(LISTVIEW, SCROLLBAR_WIDTH);
+
+    pthread_mutex_lock(&scanner->lock);
+
+    for (int i = startIndex; i < (startIndex + visibleItems); i++)
+    {
+        ListedFile *file = &scanner->files[i];
+
+        if (scanner->threaded && (file->kind == FILE_KIND_IMAGE) && (file->thumbState == THUMB_NONE) && (scanner->requestCount < FILE_DIALOG_THUMB_QUEUE))
+        {
+            ThumbJob *job = &scanner->requests[scanner->requestCount++];
+
+            job->generation = scanner->generation;
+            job->index = i;
+            job->image = (Image){ 0 };
+            snprintf(job->path, sizeof(job->path), "%s", state->dirFiles.paths[i]);
+
+            file->thumbState = THUMB_REQUESTED;
+            pthread_cond_signal(&scanner->wake);
+        }
+
+        if (file->thumbState == THUMB_READY)
+        {
+            // The icon sits at the left of the text bounds, the thumbnail covers it
+            const Rectangle textBounds = GetTextBounds(LISTVIEW, itemBounds);
+            const Texture2D thumb = scanner->thumbs[file->thumbSlot];
+            const float side = itemBounds.height - 4;
+            const float scale = side/((thumb.width > thumb.height)? thumb.width : thumb.height);
+            const Rectangle dest = { textBounds.x + (side - thumb.width*scale)/2, itemBounds.y + (itemBounds.height - thumb.height*scale)/2, thumb.width*scale, thumb.height*scale };
+
+            DrawRectangleRec((Rectangle){ textBounds.x, itemBounds.y + 2, side, side }, GetColor(GuiGetStyle(DEFAULT, BACKGROUND_COLOR)));
+            DrawTexturePro(thumb, (Rectangle){ 0, 0, (float)thumb.width, (float)thumb.height }, dest, (Vector2){ 0, 0 }, 0.0f, WHITE);
+        }
+
+        itemBounds.y += (itemHeight + itemSpacing);
+    }
+
+    pthread_mutex_unlock(&scanner->lock);
+
+    // A larger preview of the hovered image beside the window
+    const int focused = state->itemFocused;
+
+    if ((focused >= 0) && (focused < count) && (scanner->files[focused].thumbState == THUMB_READY))
+    {
+        const Texture2D thumb = scanner->thumbs[scanner->files[focused].thumbSlot];
+        const float scale = 2.0f*FILE_DIALOG_THUMB_SIZE/((thumb.width > thumb.height)? thumb.width : thumb.height);
+        const Rectangle frame = { state->windowBounds.x + state->windowBounds.width + 4, state->windowBounds.y, 2*FILE_DIALOG_THUMB_SIZE + 8, 2*FILE_DIALOG_THUMB_SIZE + 8 };
+
+        DrawRectangleRec(frame, GetColor(GuiGetStyle(DEFAULT, BACKGROUND_COLOR)));
+        DrawRectangleLinesEx(frame, 1, GetColor(GuiGetStyle(DEFAULT, LINE_COLOR)));
+        DrawTexturePro(thumb, (Rectangle){ 0, 0, (float)thumb.width, (float)thumb.height }, (Rectangle){ frame.x + 4, frame.y + 4, thumb.width*scale, thumb.height*scale }, (Vector2){ 0, 0 }, 0.0f, WHITE);
+    }
+}
+
+// List View control for the listing, GuiListViewEx() with the row text formatted on the fly
+// NOTE: Only visible rows are formatted, a listing of any size costs the same per frame
+static void GuiListViewDirFiles(Rectangle bounds, GuiWindowFileDialogState *state)
+{
+    GuiState guiControlState = guiState;
+
+    const FileDialogScanner *scanner = (const FileDialogScanner *)state->scanner;
+    const int count = ((scanner != NULL) && (scanner->files != NULL))? (int)state->dirFiles.count : 0;
+
+    int itemFocused = state->itemFocused;
+    int itemSelected = state->filesListActive;
+
+    const int itemHeight = GuiGetStyle(LISTVIEW, LIST_ITEMS_HEIGHT);
+    const int itemSpacing = GuiGetStyle(LISTVIEW, LIST_ITEMS_SPACING);
+
+    // Check if we need a scroll bar
+    const bool useScrollBar = ((float)(itemHeight + itemSpacing)*count > bounds.height);
+
+    // Define base item rectangle [0]
+    Rectangle itemBounds = { 0 };
+    itemBounds.x = bounds.x + itemSpacing;
+    itemBounds.y = bounds.y + itemSpacing + GuiGetStyle(DEFAULT, BORDER_WIDTH);
+    itemBounds.width = bounds.width - 2*itemSpacing - GuiGetStyle(DEFAULT, BORDER_WIDTH);
+    itemBounds.height = (float)itemHeight;
+    if (useScrollBar) itemBounds.width -= GuiGetStyle(LISTVIEW, SCROLLBAR_WIDTH);
+
+    // Get items on the list
+    int visibleItems = (int)bounds.height/(itemHeight + itemSpacing);
+    if (visibleItems > count) visibleItems = count;
+
+    int startIndex = state->filesListScrollIndex;
+    if ((startIndex < 0) || (startIndex > (count - visibleItems))) startIndex = 0;
+
+    // Update control
+    //--------------------------------------------------------------------
+    if ((guiControlState != STATE_DISABLED) && !guiLocked && !guiControlExclusiveMode)
+    {
+        Vector2 mousePoint = GetMousePosition();
+
+        // Check mouse inside list view
+        if (CheckCollisionPointRec(mousePoint, bounds))
+        {
+            guiControlState = STATE_FOCUSED;
+
+            // Check focused and selected item
+            for (int i = 0; i < visibleItems; i++)
             {
-                strcpy(dirFilesIcon[i], TextFormat("#10#%s", GetFileName(state->dirFiles.paths[i])));
+                if (CheckCollisionPointRec(mousePoint, itemBounds))
+                {
+                    itemFocused = startIndex + i;
+                    if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
+                    {
+                        if (itemSelected == (startIndex + i)) itemSelected = -1;
+                        else itemSelected = startIndex + i;
+                    }
+                    break;
+                }
+
+                // Update item rectangle y position for next item
+                itemBounds.y += (itemHeight + itemSpacing);
             }
-            else if (IsFileExtension(state->dirFiles.paths[i], ".exe;.bin;.raw;.msi"))
+
+            if (useScrollBar)
             {
-                strcpy(dirFilesIcon[i], TextFormat("#200#%s", GetFileName(state->dirFiles.paths[i])));
+                startIndex -= (int)GetMouseWheelMove();
+
+                if (startIndex < 0) startIndex = 0;
+                else if (startIndex > (count - visibleItems)) startIndex = count - visibleItems;
             }
-            else strcpy(dirFilesIcon[i], TextFormat("#218#%s", GetFileName(state->dirFiles.paths[i])));
+        }
+        else itemFocused = -1;
+
+        // Reset item rectangle y to [0]
+        itemBounds.y = bounds.y + itemSpacing + GuiGetStyle(DEFAULT, BORDER_WIDTH);
+    }
+    //--------------------------------------------------------------------
+
+    // Draw control
+    //--------------------------------------------------------------------
+    GuiDrawRectangle(bounds, GuiGetStyle(DEFAULT, BORDER_WIDTH), GetColor(GuiGetStyle(LISTVIEW, BORDER + guiControlState*3)), GetColor(GuiGetStyle(DEFAULT, BACKGROUND_COLOR)));     // Draw background
+
+    char text[MAX_ICON_PATH_LENGTH] = { 0 };
+
+    // Draw visible items
+    for (int i = 0; i < visibleItems; i++)
+    {
+        const int index = startIndex + i;
+        FormatFileIcon(text, state->dirFiles.paths[index], scanner->files[index].kind);
+
+        if (guiControlState == STATE_DISABLED)
+        {
+            if (index == itemSelected) GuiDrawRectangle(itemBounds, GuiGetStyle(LISTVIEW, BORDER_WIDTH), GetColor(GuiGetStyle(LISTVIEW, BORDER_COLOR_DISABLED)), GetColor(GuiGetStyle(LISTVIEW, BASE_COLOR_DISABLED)));
+
+            GuiDrawText(text, GetTextBounds(DEFAULT, itemBounds), GuiGetStyle(LISTVIEW, TEXT_ALIGNMENT), GetColor(GuiGetStyle(LISTVIEW, TEXT_COLOR_DISABLED)));
+        }
+        else if (index == itemSelected)
+        {
+            // Draw item selected
+            GuiDrawRectangle(itemBounds, GuiGetStyle(LISTVIEW, BORDER_WIDTH), GetColor(GuiGetStyle(LISTVIEW, BORDER_COLOR_PRESSED)), GetColor(GuiGetStyle(LISTVIEW, BASE_COLOR_PRESSED)));
+            GuiDrawText(text, GetTextBounds(DEFAULT, itemBounds), GuiGetStyle(LISTVIEW, TEXT_ALIGNMENT), GetColor(GuiGetStyle(LISTVIEW, TEXT_COLOR_PRESSED)));
+        }
+        else if (index == itemFocused)
+        {
+            // Draw item focused
+            GuiDrawRectangle(itemBounds, GuiGetStyle(LISTVIEW, BORDER_WIDTH), GetColor(GuiGetStyle(LISTVIEW, BORDER_COLOR_FOCUSED)), GetColor(GuiGetStyle(LISTVIEW, BASE_COLOR_FOCUSED)));
+            GuiDrawText(text, GetTextBounds(DEFAULT, itemBounds), GuiGetStyle(LISTVIEW, TEXT_ALIGNMENT), GetColor(GuiGetStyle(LISTVIEW, TEXT_COLOR_FOCUSED)));
         }
         else
         {
-            // Path is a directory, add a directory icon
-            strcpy(dirFilesIcon[i], TextFormat("#1#%s", GetFileName(state->dirFiles.paths[i])));
+            // Draw item normal
+            GuiDrawText(text, GetTextBounds(DEFAULT, itemBounds), GuiGetStyle(LISTVIEW, TEXT_ALIGNMENT), GetColor(GuiGetStyle(LISTVIEW, TEXT_COLOR_NORMAL)));
         }
+
+        // Update item rectangle y position for next item
+        itemBounds.y += (itemHeight + itemSpacing);
     }
+
+    if (useScrollBar)
+    {
+        Rectangle scrollBarBounds = {
+            bounds.x + bounds.width - GuiGetStyle(LISTVIEW, BORDER_WIDTH) - GuiGetStyle(LISTVIEW, SCROLLBAR_WIDTH),
+            bounds.y + GuiGetStyle(LISTVIEW, BORDER_WIDTH), (float)GuiGetStyle(LISTVIEW, SCROLLBAR_WIDTH),
+            bounds.height - 2*GuiGetStyle(DEFAULT, BORDER_WIDTH)
+        };
+
+        // Slider proportional to the visible share, but never too thin to grab on a large listing
+        float sliderSize = bounds.height*visibleItems/count;
+        if (sliderSize < FILE_DIALOG_MIN_SLIDER_SIZE) sliderSize = FILE_DIALOG_MIN_SLIDER_SIZE;
+
+        int prevSliderSize = GuiGetStyle(SCROLLBAR, SCROLL_SLIDER_SIZE);   // Save default slider size
+        int prevScrollSpeed = GuiGetStyle(SCROLLBAR, SCROLL_SPEED); // Save default scroll speed
+        GuiSetStyle(SCROLLBAR, SCROLL_SLIDER_SIZE, (int)sliderSize);            // Change slider size
+        GuiSetStyle(SCROLLBAR, SCROLL_SPEED, count - visibleItems); // Change scroll speed
+
+        startIndex = GuiScrollBar(scrollBarBounds, startIndex, 0, count - visibleItems);
+
+        GuiSetStyle(SCROLLBAR, SCROLL_SPEED, prevScrollSpeed); // Reset scroll speed to default
+        GuiSetStyle(SCROLLBAR, SCROLL_SLIDER_SIZE, prevSliderSize); // Reset slider size to default
+    }
+    //--------------------------------------------------------------------
+
+    state->filesListActive = itemSelected;
+    state->itemFocused = itemFocused;
+    state->filesListScrollIndex = startIndex;
 }
 
 #if defined(USE_CUSTOM_LISTVIEW_FILEINFO)
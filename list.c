@@ -1,22 +1,127 @@
 #include "list.h"
 
-Node* node_init(void* content, const size_t content_size, const print_content_funct print_funct, const content_free_funct free_funct)
+#include <stdio.h>
+
+// items keep the alignment malloc would give them
+#define LIST_POOL_ALIGN (2 * sizeof(void*))
+
+static size_t list_pool_round(const size_t size)
 {
-    if (!content)
-        return NULL;
+    return (size + LIST_POOL_ALIGN - 1) & ~(LIST_POOL_ALIGN - 1);
+}
 
-    Node* node = malloc(sizeof(Node));
-    if (!node) 
+ListPool list_pool_init(const size_t item_size, const size_t slab_items)
+{
+    ListPool pool = {
+        .item_size = list_pool_round(item_size ? item_size : 1),
+        .slab_items = slab_items ? slab_items : LIST_SLAB_ITEMS,
+        .slabs = NULL,
+        .slab_used = 0,
+        .free_items = NULL,
+        .live = 0,
+        .single_list = false,
+    };
+
+    return pool;
+}
+
+// every item goes with its slab, whether it was released or not
+void list_pool_free(ListPool* pool)
+{
+    if (!pool)
+        return;
+
+    while (pool->slabs) {
+        ListSlab* next = pool->slabs->next;
+        free(pool->slabs);
+        pool->slabs = next;
+    }
+
+    pool->slab_used = 0;
+    pool->free_items = NULL;
+    pool->live = 0;
+}
+
+void* list_pool_take(ListPool* pool)
+{
+    if (!pool)
         return NULL;
-    
+
+    void* item = pool->free_items;
+
+    if (item)
+        pool->free_items = *(void**)item;
+
+    else {
+        if (!pool->slabs || (pool->slab_used == pool->slab_items)) {
+            ListSlab* slab = malloc(list_pool_round(sizeof(ListSlab)) + (pool->item_size * pool->slab_items));
+            if (!slab)
+                return NULL;
+
+            slab->next = pool->slabs;
+            pool->slabs = slab;
+            pool->slab_used = 0;
+        }
+
+        item = (char*)pool->slabs + list_pool_round(sizeof(ListSlab)) + (pool->item_size * pool->slab_used);
+        pool->slab_used++;
+    }
+
+    pool->live++;
+
+    return item;
+}
+
+void list_pool_give(ListPool* pool, void* item)
+{
+    if (!pool || !item)
+        return;
+
+    *(void**)item = pool->free_items;
+    pool->free_items = item;
+    pool->live--;
+}
+
+static void node_setup(Node* node, void* content, const size_t content_size, const print_content_funct print_funct, const content_free_funct free_funct, ListPool* pool)
+{
     node->content = content;
     node->size = content_size;
 
     node->free_funct = free_funct;
     node->print_funct = print_funct;
+    node->pool = pool;
     
     node->prev = node->next = NULL;
+}
+
+Node* node_init(void* content, const size_t content_size, const print_content_funct print_funct, const content_free_funct free_funct)
+{
+    if (!content)
+        return NULL;
+
+    Node* node = malloc(sizeof(Node));
+    if (!node) 
+        return NULL;
     
+    node_setup(node, content, content_size, print_funct, free_funct, NULL);
+    
+    return node;
+}
+
+Node* node_init_pooled(ListPool* pool, void* content, const size_t content_size, const print_content_funct print_funct, const content_free_funct free_funct)
+{
+    if (!content)
+        return NULL;
+
+    if (!pool)
+        return node_init(content, content_size, print_funct, free_funct);
+
+    Node* node = list_pool_take(pool);
+    if (!node)
+        return NULL;
+
+    node_setup(node, content, content_size, print_funct, free_funct, pool);
+
     return node;
 }
 
@@ -28,7 +133,12 @@ void node_free(Node* node)
     if (node->content && node->free_funct)
         node->free_funct(node->content);
 
-    free(node); node = NULL;
+    if (node->pool)
+        list_pool_give(node->pool, node);
+    else
+        free(node);
+
+    node = NULL;
 }
 
 void node_print(const Node* node)
@@ -43,20 +153,68 @@ List list_init()
         .count = 0,
         .head = NULL,
         .tail = NULL,
+        .pool = NULL,
+        .owns_pool = false,
+        .freed_contents = 0,
     };
     
     return list;
 }
 
+// nodes come from a pool that may be shared by every list of a session, freed ones return to its freelist
+List list_init_pooled(ListPool* pool)
+{
+    List list = list_init();
+    list.pool = pool;
+
+    return list;
+}
+
+// nodes come from slabs of this list alone, freeing the list releases them all at once
+List list_init_slab(const size_t slab_nodes)
+{
+    List list = list_init();
+
+    list.pool = malloc(sizeof(ListPool));
+    if (!list.pool) {
+        fprintf(stderr, "list_init_slab: malloc returned null\n");
+        return list;
+    }
+
+    *list.pool = list_pool_init(sizeof(Node), slab_nodes);
+    list.pool->single_list = true;
+    list.owns_pool = true;
+
+    return list;
+}
+
 void list_free(List* list)
 {
     if (!list)
         return;
 
-    while (list->head) 
-        node_free(list_dequeue(list));
+    if (list->owns_pool) {
+        // only contents need a walk, the nodes themselves go with the slabs
+        if (list->freed_contents > 0) {
+            for (Node* node = list->head; node; node = node->next) {
+                if (node->content && node->free_funct)
+                    node->free_funct(node->content);
+            }
+        }
+
+        list_pool_free(list->pool);
+        free(list->pool); list->pool = NULL;
+        list->owns_pool = false;
+    }
+
+    else {
+        while (list->head) 
+            node_free(list_dequeue(list));
+    }
 
     list->head = list->tail = NULL;
+    list->count = 0;
+    list->freed_contents = 0;
 }
 
 void list_print(const List* list)
@@ -68,10 +226,23 @@ void list_print(const List* list)
         node_print(node);
 }
 
-void list_append(List* list, Node* node)
+// a list that owns its pool only takes that pool's nodes, freeing it drops the slabs without walking the nodes
+bool list_append(List* list, Node* node)
 {
     if (!list || !node)
-        return;
+        return false;
+
+    // a foreign node would leak when the slabs are dropped
+    if (list->owns_pool && (node->pool != list->pool)) {
+        fprintf(stderr, "list_append: the list only takes nodes from its own slabs\n");
+        return false;
+    }
+
+    // a slab node moved elsewhere would dangle once its list is freed
+    if (!list->owns_pool && node->pool && node->pool->single_list) {
+        fprintf(stderr, "list_append: the node belongs to another list's slabs\n");
+        return false;
+    }
 
     node->prev = node->next = NULL;
 
@@ -84,23 +255,111 @@ void list_append(List* list, Node* node)
         list->tail = node;
     }
 
+    if (node->content && node->free_funct)
+        list->freed_contents++;
+
     list->count++;
+
+    return true;
 }
 
-Node* list_dequeue(List* list)
+// node from the list's pool, or malloced without one, appended
+Node* list_push(List* list, void* content, const size_t content_size, const print_content_funct print_funct, const content_free_funct free_funct)
 {
     if (!list)
         return NULL;
 
+    Node* node = node_init_pooled(list->pool, content, content_size, print_funct, free_funct);
+    if (!node)
+        return NULL;
+
+    // a node the list refuses would otherwise leak, its content stays the caller's as when no node could be made
+    if (!list_append(list, node)) {
+        node->free_funct = NULL;
+        node_free(node);
+        return NULL;
+    }
+
+    return node;
+}
+
+Node* list_dequeue(List* list)
+{
+    if (!list || !list->head)
+        return NULL;
+
     Node* detached = list->head;
 
     list->head = list->head->next;
     if (!list->head) 
         list->tail = NULL;
+    else
+        list->head->prev = NULL;
 
     detached->prev = detached->next = NULL;
 
+    if (detached->content && detached->free_funct)
+        list->freed_contents--;
+
     list->count--;
     
+    return detached;
+}
+
+IntrusiveList intrusive_list_init()
+{
+    IntrusiveList list = {
+        .count = 0,
+        .head = NULL,
+        .tail = NULL,
+    };
+
+    return list;
+}
+
+void intrusive_list_append(IntrusiveList* list, ListLink* link)
+{
+    if (!list || !link)
+        return;
+
+    link->prev = list->tail;
+    link->next = NULL;
+
+    if (list->tail)
+        list->tail->next = link;
+    else
+        list->head = link;
+
+    list->tail = link;
+    list->count++;
+}
+
+void intrusive_list_remove(IntrusiveList* list, ListLink* link)
+{
+    if (!list || !link)
+        return;
+
+    if (link->prev)
+        link->prev->next = link->next;
+    else
+        list->head = link->next;
+
+    if (link->next)
+        link->next->prev = link->prev;
+    else
+        list->tail = link->prev;
+
+    link->prev = link->next = NULL;
+    list->count--;
+}
+
+ListLink* intrusive_list_dequeue(IntrusiveList* list)
+{
+    if (!list || !list->head)
+        return NULL;
+
+    ListLink* detached = list->head;
+    intrusive_list_remove(list, detached);
+
     return detached;
 }
\ No newline at end of file
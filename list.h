@@ -1,11 +1,37 @@
 #ifndef LINKED_LIST_H
 #define LINKED_LIST_H
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdlib.h>
 
+#define LIST_SLAB_ITEMS 1024   // items carved from each slab when a pool is not given a size
+
 typedef void (*print_content_funct)(void*);
 typedef void (*content_free_funct)(void*);
 
+typedef struct ListSlab
+{
+    struct ListSlab* next;
+} ListSlab;
+
+// fixed size items carved from slabs, released items are reused through a freelist threaded through them
+typedef struct ListPool
+{
+    size_t item_size;
+    size_t slab_items;
+    ListSlab* slabs;       // newest first, each followed by slab_items items, allocated
+    size_t slab_used;      // items handed out from the newest slab
+    void* free_items;      // released items, the first word of each points to the next
+    size_t live;           // items handed out and not released
+    bool single_list;      // carved for one list by list_init_slab, its nodes never move to another list
+} ListPool;
+
+ListPool list_pool_init(const size_t item_size, const size_t slab_items);
+void list_pool_free(ListPool* pool);
+void* list_pool_take(ListPool* pool);
+void list_pool_give(ListPool* pool, void* item);
+
 typedef struct Node 
 {
     size_t size;
@@ -14,9 +40,11 @@ typedef struct Node
     struct Node* next;
     content_free_funct free_funct;
     print_content_funct print_funct;
+    ListPool* pool;        // pool the node came from, null when malloced
 } Node;
 
 Node* node_init(void* data, const size_t data_size, const print_content_funct print_funct, const content_free_funct free_funct);
+Node* node_init_pooled(ListPool* pool, void* data, const size_t data_size, const print_content_funct print_funct, const content_free_funct free_funct);
 void node_free(Node* node);
 void node_print(const Node* node);
 
@@ -25,12 +53,40 @@ typedef struct
     size_t count;
     Node* head; 
     Node* tail; 
+    ListPool* pool;        // nodes made by list_push come from here when set
+    bool owns_pool;        // the pool holds this list's nodes only, freeing the list drops its slabs
+    size_t freed_contents; // nodes whose content has a free function, the rest need no walk on free
 } List;
 
 List list_init();
+List list_init_pooled(ListPool* pool);
+List list_init_slab(const size_t slab_nodes);
 void list_free(List* list);
 void list_print(const List* list);
 Node* list_dequeue(List* list);
-void list_append(List* list, Node* node);
+bool list_append(List* list, Node* node);
+Node* list_push(List* list, void* data, const size_t data_size, const print_content_funct print_funct, const content_free_funct free_funct);
+
+// links embedded in the caller's struct, no allocation per element
+typedef struct ListLink
+{
+    struct ListLink* prev;
+    struct ListLink* next;
+} ListLink;
+
+typedef struct
+{
+    size_t count;
+    ListLink* head;
+    ListLink* tail;
+} IntrusiveList;
+
+// struct embedding 'link' as 'member'
+#define LIST_CONTAINER(link, type, member) ((type*)((char*)(link) - offsetof(type, member)))
+
+IntrusiveList intrusive_list_init();
+void intrusive_list_append(IntrusiveList* list, ListLink* link);
+void intrusive_list_remove(IntrusiveList* list, ListLink* link);
+ListLink* intrusive_list_dequeue(IntrusiveList* list);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,675 @@
+#include "map_file.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "utils.h"
+
+// the implementations are compiled into raylib, only the declarations are needed here
+#include "external/sdefl.h"
+#include "external/sinfl.h"
+
+#define MAP_BLOCK_RAW_SIZE (TILE_CHUNK_CELLS * 6)  // sheet (2), sprite (2), type, flags
+#define MAP_BLOCK_MAX_SIZE (MAP_BLOCK_RAW_SIZE + 64) // above sdefl_bound of a raw block, anything larger is corrupt
+#define MAP_ASSET_RECORD_SIZE 14                   // id (8), sprite size (4), path length (2), then the path
+#define MAP_TOC_RECORD_SIZE 32                     // cx, cy, cell count, block size, checksum (4 each), block offset (8), rgba
+#define MAP_TOC_RECORD_SIZE_V1 28                  // the same without the color
+#define MAP_COMPRESSION_LEVEL SDEFL_LVL_DEF
+
+typedef struct
+{
+    TileChunk* chunk;         // saved from, null for a chunk only the source map has
+    long source;              // entry of the source map to read the chunk from, -1 for none
+    unsigned int cell_count;
+    unsigned char* data;      // compressed block, allocated
+    int size;
+    unsigned int checksum;    // of the compressed bytes
+    unsigned long long offset;
+    int cx, cy;
+    Color color;
+} MapBlock;
+
+// where the grid's block for a chunk key went, so a source chunk painted over is merged without a scan
+typedef struct
+{
+    long long key;
+    size_t block;             // index into MapJob.blocks plus one, 0 marks a free slot
+} MapBlockSlot;
+
+typedef struct
+{
+    MapBlock* blocks;
+    size_t count;
+    MapBlockSlot* index;      // grid blocks by chunk key, open addressing, only built when there is a source, allocated
+    size_t index_capacity;    // a power of two
+    atomic_size_t next;       // next block a worker may claim
+    atomic_bool failed;
+    const MapFile* source;    // map the blocks with a source entry are read from
+    const TilePalette* palette; // cells are resolved against it for the toc's average colors
+} MapJob;
+
+static void put_u16(unsigned char* p, const unsigned int v)
+{
+    p[0] = v; p[1] = v >> 8;
+}
+
+static void put_u32(unsigned char* p, const unsigned int v)
+{
+    put_u16(p, v); put_u16(p + 2, v >> 16);
+}
+
+static void put_u64(unsigned char* p, const unsigned long long v)
+{
+    put_u32(p, v); put_u32(p + 4, v >> 32);
+}
+
+static void put_f32(unsigned char* p, const float v)
+{
+    unsigned int bits;
+    memcpy(&bits, &v, sizeof(bits));
+    put_u32(p, bits);
+}
+
+static unsigned int get_u16(const unsigned char* p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static unsigned int get_u32(const unsigned char* p)
+{
+    return get_u16(p) | (get_u16(p + 2) << 16);
+}
+
+static unsigned long long get_u64(const unsigned char* p)
+{
+    return get_u32(p) | ((unsigned long long)get_u32(p + 4) << 32);
+}
+
+static float get_f32(const unsigned char* p)
+{
+    const unsigned int bits = get_u32(p);
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+// FNV-1a over a compressed block
+static unsigned int map_block_checksum(const unsigned char* data, const int size)
+{
+    unsigned int hash = 2166136261u;
+
+    for (int i = 0; i < size; i++)
+        hash = (hash ^ data[i]) * 16777619u;
+
+    return hash;
+}
+
+static double map_file_now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + (ts.tv_nsec * 1e-9);
+}
+
+// one plane per byte of a cell, runs of equal sheets or types then compress to almost nothing
+static void map_block_pack(unsigned char* raw, const TileChunk* chunk)
+{
+    for (int i = 0; i < TILE_CHUNK_CELLS; i++) {
+        const TileCell cell = chunk->cells[i];
+
+        raw[i]                        = cell.sheet;
+        raw[i + TILE_CHUNK_CELLS]     = cell.sheet >> 8;
+        raw[i + TILE_CHUNK_CELLS * 2] = cell.sprite;
+        raw[i + TILE_CHUNK_CELLS * 3] = cell.sprite >> 8;
+        raw[i + TILE_CHUNK_CELLS * 4] = cell.type;
+        raw[i + TILE_CHUNK_CELLS * 5] = cell.flags;
+    }
+}
+
+// returns the number of non-empty cells, slots the remap table does not know are dropped
+static unsigned int map_block_unpack(TileChunk* chunk, const unsigned char* raw, const unsigned short* remap, const size_t remap_count)
+{
+    unsigned int count = 0;
+
+    for (int i = 0; i < TILE_CHUNK_CELLS; i++) {
+        const unsigned int saved = raw[i] | (raw[i + TILE_CHUNK_CELLS] << 8);
+        const unsigned short slot = (saved <= remap_count) ? remap[saved] : 0;
+
+        if (slot == 0)
+            continue;
+
+        chunk->cells[i] = (TileCell) {
+            .sheet = slot,
+            .sprite = raw[i + TILE_CHUNK_CELLS * 2] | (raw[i + TILE_CHUNK_CELLS * 3] << 8),
+            .type = raw[i + TILE_CHUNK_CELLS * 4],
+            .flags = raw[i + TILE_CHUNK_CELLS * 5],
+        };
+
+        count++;
+    }
+
+    return count;
+}
+
+// alpha weighted average of the cells as the palette shows them, empty cells count as transparent
+static Color map_block_color(const TilePalette* palette, const TileChunk* chunk)
+{
+    unsigned int sums[4] = {0};
+    TileCell last = {0};
+    Color color = BLANK;
+
+    for (int i = 0; i < TILE_CHUNK_CELLS; i++) {
+        const TileCell cell = chunk->cells[i];
+        if (tile_cell_is_empty(cell))
+            continue;
+
+        // runs of the same sprite are the norm, the palette is only asked again when it changes
+        if ((cell.sheet != last.sheet) || (cell.sprite != last.sprite)) {
+            color = palette_sheet_cell_color(tile_palette_get_sheet(palette, cell.sheet), cell.sprite);
+            last = cell;
+        }
+
+        sums[0] += color.r * color.a;
+        sums[1] += color.g * color.a;
+        sums[2] += color.b * color.a;
+        sums[3] += color.a;
+    }
+
+    if (sums[3] == 0)
+        return BLANK;
+
+    return (Color) {
+        .r = sums[0] / sums[3],
+        .g = sums[1] / sums[3],
+        .b = sums[2] / sums[3],
+        .a = sums[3] / TILE_CHUNK_CELLS,
+    };
+}
+
+static int map_chunk_entry_compare(const void* a, const void* b)
+{
+    const long long ka = ((const MapChunkEntry*)a)->key;
+    const long long kb = ((const MapChunkEntry*)b)->key;
+
+    return (ka > kb) - (ka < kb);
+}
+
+// maps the file and reads the header, asset table and toc, blocks are only paged in once a chunk is read
+bool map_file_open(MapFile* map, const char* path, const map_slot_funct remap, void* user)
+{
+    if (!map || !valid_string(path))
+        return false;
+
+    memset(map, 0, sizeof(MapFile));
+
+    // chunks stream in wherever the view goes, read ahead would mostly fetch blocks nobody asked for
+    if (!mapped_file_open(&map->file, path, FILE_ACCESS_RANDOM))
+        return false;
+
+    const unsigned char* header = map->file.data;
+
+    const unsigned int version = (map->file.size >= MAP_FILE_HEADER_SIZE) ? get_u16(header + 4) : 0;
+
+    if ((map->file.size < MAP_FILE_HEADER_SIZE) || (memcmp(header, MAP_FILE_MAGIC, 4) != 0) || (version < 1) || (version > MAP_FILE_VERSION) || (get_u16(header + 6) != TILE_CHUNK_SIZE)) {
+        fprintf(stderr, "map_file_open: \"%s\" is not a map this version can read\n", path);
+        mapped_file_close(&map->file);
+        return false;
+    }
+
+    map->slot_count = get_u32(header + 8);
+    map->chunk_count = get_u32(header + 12);
+    map->cell_count = get_u64(header + 32);
+    map->spawn_point = (Vector2){ get_f32(header + 40), get_f32(header + 44) };
+
+    // the asset table sits right before the toc, both are parsed in place
+    const unsigned long long asset_offset = get_u64(header + 16);
+    const unsigned long long toc_offset = get_u64(header + 24);
+    const size_t record_size = (version == 1) ? MAP_TOC_RECORD_SIZE_V1 : MAP_TOC_RECORD_SIZE;
+    const unsigned long long meta_end = toc_offset + ((unsigned long long)map->chunk_count * record_size);
+
+    bool opened = (asset_offset <= toc_offset) && (toc_offset <= meta_end) && (meta_end <= map->file.size);
+
+    const unsigned char* meta = map->file.data + ((opened) ? asset_offset : 0);
+    map->chunks = opened ? calloc((map->chunk_count > 0) ? map->chunk_count : 1, sizeof(MapChunkEntry)) : NULL;
+    map->slots = opened ? calloc(map->slot_count + 1, sizeof(unsigned short)) : NULL;
+
+    opened = map->chunks && map->slots;
+
+    // resolve every saved slot up front, readers then only look the table up
+    size_t p = 0;
+    const size_t asset_bytes = toc_offset - asset_offset;
+
+    for (size_t s = 0; opened && (s < map->slot_count); s++) {
+        if (((p + MAP_ASSET_RECORD_SIZE) > asset_bytes) || ((p + MAP_ASSET_RECORD_SIZE + get_u16(meta + p + 12)) > asset_bytes)) {
+            opened = false;
+            break;
+        }
+
+        const size_t path_len = get_u16(meta + p + 12);
+
+        MapAsset asset = {
+            .id = get_u64(meta + p),
+            .sprite_size = get_f32(meta + p + 8),
+            .path = strndup((const char*)meta + p + MAP_ASSET_RECORD_SIZE, path_len),
+        };
+
+        if (!asset.path) {
+            opened = false;
+            break;
+        }
+
+        map->slots[s + 1] = (remap) ? remap(&asset, user) : (s + 1);
+
+        free(asset.path); asset.path = NULL;
+
+        p += MAP_ASSET_RECORD_SIZE + path_len;
+    }
+
+    for (size_t i = 0; opened && (i < map->chunk_count); i++) {
+        const unsigned char* record = meta + asset_bytes + (i * record_size);
+
+        map->chunks[i] = (MapChunkEntry) {
+            .key = tile_chunk_key((int)get_u32(record), (int)get_u32(record + 4)),
+            .size = get_u32(record + 12),
+            .checksum = get_u32(record + 16),
+            .offset = get_u64(record + 20),
+            .version = 0,
+            .color = (version == 1) ? BLANK : (Color){ record[28], record[29], record[30], record[31] },
+            .state = MAP_CHUNK_ON_DISK,
+        };
+
+        const MapChunkEntry* entry = &map->chunks[i];
+        if ((entry->size > MAP_BLOCK_MAX_SIZE) || (entry->offset > map->file.size) || (entry->size > (map->file.size - entry->offset)))
+            opened = false;
+    }
+
+    if (!opened) {
+        fprintf(stderr, "map_file_open: \"%s\" is truncated or corrupt\n", path);
+        map_file_close(map);
+        return false;
+    }
+
+    qsort(map->chunks, map->chunk_count, sizeof(MapChunkEntry), map_chunk_entry_compare);
+
+    return true;
+}
+
+void map_file_close(MapFile* map)
+{
+    if (!map)
+        return;
+
+    mapped_file_close(&map->file);
+
+    if (map->chunks) {
+        free(map->chunks); map->chunks = NULL;
+    }
+
+    if (map->slots) {
+        free(map->slots); map->slots = NULL;
+    }
+
+    map->chunk_count = map->slot_count = 0;
+}
+
+// index of the chunk's toc entry, -1 when the map has no block for it
+long map_file_find_chunk(const MapFile* map, const int cx, const int cy)
+{
+    if (!map || !map->chunks)
+        return -1;
+
+    const long long key = tile_chunk_key(cx, cy);
+
+    size_t lo = 0, hi = map->chunk_count;
+    while (lo < hi) {
+        const size_t mid = lo + ((hi - lo) / 2);
+
+        if (map->chunks[mid].key < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return ((lo < map->chunk_count) && (map->chunks[lo].key == key)) ? (long)lo : -1;
+}
+
+// decodes one block into chunk (cx, cy, count and cells), safe to call from several threads at once
+bool map_file_read_chunk(const MapFile* map, const size_t index, TileChunk* chunk)
+{
+    if (!map || !chunk || (index >= map->chunk_count))
+        return false;
+
+    const MapChunkEntry* entry = &map->chunks[index];
+
+    // the toc was checked against the file size on open, the block is read where it lies
+    const unsigned char* block = map->file.data + entry->offset;
+    unsigned char raw[MAP_BLOCK_RAW_SIZE];
+
+    // sinflate trusts match lengths blindly, so a damaged block must be caught before it is inflated
+    if ((map_block_checksum(block, entry->size) != entry->checksum) || (sinflate(raw, MAP_BLOCK_RAW_SIZE, block, entry->size) != MAP_BLOCK_RAW_SIZE)) {
+        fprintf(stderr, "map_file_read_chunk: block %zu is corrupt\n", index);
+        return false;
+    }
+
+    chunk->cx = (int)(entry->key >> 32);
+    chunk->cy = (int)(entry->key & 0xFFFFFFFF);
+
+    memset(chunk->cells, 0, sizeof(chunk->cells));
+    chunk->count = map_block_unpack(chunk, raw, map->slots, map->slot_count);
+
+    return true;
+}
+
+static void* map_compress_work(void* arg)
+{
+    MapJob* job = (MapJob*) arg;
+
+    // almost 1MB, one per worker
+    struct sdefl* sdefl = calloc(1, sizeof(struct sdefl));
+    TileChunk* scratch = (job->source) ? malloc(sizeof(TileChunk)) : NULL;
+
+    if (!sdefl || (job->source && !scratch)) {
+        fprintf(stderr, "map_compress_work: allocation returned null\n");
+        atomic_store(&job->failed, true);
+    }
+
+    unsigned char raw[MAP_BLOCK_RAW_SIZE];
+    const int bound = sdefl_bound(MAP_BLOCK_RAW_SIZE);
+
+    size_t i;
+    while (!atomic_load(&job->failed) && ((i = atomic_fetch_add(&job->next, 1)) < job->count)) {
+        MapBlock* block = &job->blocks[i];
+        const TileChunk* chunk = block->chunk;
+
+        // a chunk still on disk is carried over, with whatever the grid painted over it in the meantime on top
+        if (block->source >= 0) {
+            if (!map_file_read_chunk(job->source, block->source, scratch)) {
+                atomic_store(&job->failed, true);
+                break;
+            }
+
+            for (int c = 0; block->chunk && (c < TILE_CHUNK_CELLS); c++) {
+                if (tile_cell_is_empty(block->chunk->cells[c]))
+                    continue;
+
+                scratch->count += tile_cell_is_empty(scratch->cells[c]);
+                scratch->cells[c] = block->chunk->cells[c];
+            }
+
+            chunk = scratch;
+        }
+
+        block->data = malloc(bound);
+        if (!block->data) {
+            fprintf(stderr, "map_compress_work: malloc returned null\n");
+            atomic_store(&job->failed, true);
+            break;
+        }
+
+        block->cx = chunk->cx;
+        block->cy = chunk->cy;
+        block->cell_count = chunk->count;
+        block->color = map_block_color(job->palette, chunk);
+
+        map_block_pack(raw, chunk);
+        block->size = sdeflate(sdefl, block->data, raw, MAP_BLOCK_RAW_SIZE, MAP_COMPRESSION_LEVEL);
+        block->checksum = map_block_checksum(block->data, block->size);
+    }
+
+    if (scratch) {
+        free(scratch); scratch = NULL;
+    }
+
+    if (sdefl) {
+        free(sdefl); sdefl = NULL;
+    }
+
+    return NULL;
+}
+
+// spreads the job's blocks over the cores, the calling thread takes a share too, returns the number of threads used
+static int map_job_run(MapJob* job, void* (*work)(void*))
+{
+    atomic_init(&job->next, 0);
+    atomic_init(&job->failed, false);
+
+    const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+
+    int nthreads = (cores < 1) ? 1 : ((cores > MAP_FILE_MAX_THREADS) ? MAP_FILE_MAX_THREADS : cores);
+    if ((size_t)nthreads > job->count)
+        nthreads = (job->count > 0) ? job->count : 1;
+
+    pthread_t threads[MAP_FILE_MAX_THREADS];
+    int started = 0;
+
+    // a worker that fails to start only means fewer hands, the rest still claim every block
+    for (int t = 1; t < nthreads; t++) {
+        if (pthread_create(&threads[started], NULL, work, job) != 0)
+            break;
+
+        started++;
+    }
+
+    work(job);
+
+    for (int t = 0; t < started; t++)
+        pthread_join(threads[t], NULL);
+
+    return started + 1;
+}
+
+static size_t map_block_slot(const MapJob* job, const long long key)
+{
+    unsigned long long h = key;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+
+    size_t i = h & (job->index_capacity - 1);
+
+    while ((job->index[i].block != 0) && (job->index[i].key != key))
+        i = (i + 1) & (job->index_capacity - 1);
+
+    return i;
+}
+
+static void map_collect_chunk(TileChunk* chunk, void* user)
+{
+    MapJob* job = (MapJob*) user;
+
+    if (job->index)
+        job->index[map_block_slot(job, chunk->key)] = (MapBlockSlot){ .key = chunk->key, .block = job->count + 1 };
+
+    job->blocks[job->count++] = (MapBlock) {
+        .chunk = chunk,
+        .source = -1,
+    };
+}
+
+// writes the grid, plus every chunk of source the grid never took over, source may be the file being replaced
+bool map_file_save(const char* path, TileGrid* grid, const TilePalette* palette, AssetCache* cache, const Vector2 spawn_point, const MapFile* source, MapFileStats* stats)
+{
+    if (!valid_string(path) || !grid || !palette || !cache)
+        return false;
+
+    const double start = map_file_now();
+
+    const size_t nblocks = tile_grid_chunk_count(grid) + ((source) ? source->chunk_count : 0);
+
+    MapJob job = {0};
+    job.source = source;
+    job.palette = palette;
+    job.blocks = calloc((nblocks > 0) ? nblocks : 1, sizeof(MapBlock));
+    if (!job.blocks) {
+        fprintf(stderr, "map_file_save: calloc returned null\n");
+        return false;
+    }
+
+    // at most half full, so probes stay short
+    if (source) {
+        job.index_capacity = 16;
+        while (job.index_capacity < (tile_grid_chunk_count(grid) * 2))
+            job.index_capacity *= 2;
+
+        job.index = calloc(job.index_capacity, sizeof(MapBlockSlot));
+        if (!job.index) {
+            fprintf(stderr, "map_file_save: calloc returned null\n");
+            free(job.blocks); job.blocks = NULL;
+            return false;
+        }
+    }
+
+    tile_grid_for_each_chunk(grid, map_collect_chunk, &job);
+
+    for (size_t i = 0; source && (i < source->chunk_count); i++) {
+        const MapChunkEntry* entry = &source->chunks[i];
+        if ((entry->state == MAP_CHUNK_IN_GRID) || (entry->state == MAP_CHUNK_FAILED))
+            continue;
+
+        // a chunk painted on before its block streamed in already has a grid block, merge into that one
+        const MapBlockSlot* painted = &job.index[map_block_slot(&job, entry->key)];
+
+        MapBlock* block = (painted->block != 0) ? &job.blocks[painted->block - 1] : &job.blocks[job.count++];
+
+        block->source = i;
+    }
+
+    if (job.index) {
+        free(job.index); job.index = NULL;
+    }
+
+    const int nthreads = map_job_run(&job, map_compress_work);
+
+    bool saved = !atomic_load(&job.failed);
+
+    // header, asset table and toc are assembled in one buffer, every offset is known once the blocks are compressed
+    size_t asset_bytes = 0;
+    size_t cell_count = 0;
+
+    for (size_t s = 0; saved && (s < palette->sheet_count); s++) {
+        const AssetEntry* entry = asset_cache_find(cache, palette->sheets[s].asset_id);
+        const size_t path_len = (entry && entry->path) ? strlen(entry->path) : 0;
+
+        // the record stores the length in 16 bits, a longer path would shift every record after it
+        if (path_len > UINT16_MAX) {
+            fprintf(stderr, "map_file_save: the path of sheet %zu is %zu bytes long, at most %d fit in a map\n", s + 1, path_len, UINT16_MAX);
+            saved = false;
+        }
+
+        asset_bytes += MAP_ASSET_RECORD_SIZE + path_len;
+    }
+
+    const size_t asset_offset = MAP_FILE_HEADER_SIZE;
+    const size_t toc_offset = asset_offset + asset_bytes;
+    const size_t meta_size = toc_offset + (job.count * MAP_TOC_RECORD_SIZE);
+
+    unsigned char* meta = saved ? calloc(1, meta_size) : NULL;
+    if (saved && !meta) {
+        fprintf(stderr, "map_file_save: calloc returned null\n");
+        saved = false;
+    }
+
+    size_t file_size = meta_size;
+
+    if (saved) {
+        unsigned char* p = meta + asset_offset;
+
+        for (size_t s = 0; s < palette->sheet_count; s++) {
+            const PaletteSheet* sheet = &palette->sheets[s];
+            const AssetEntry* entry = asset_cache_find(cache, sheet->asset_id);
+            const size_t path_len = (entry && entry->path) ? strlen(entry->path) : 0;
+
+            put_u64(p, sheet->asset_id);
+            put_f32(p + 8, sheet->sprite_size);
+            put_u16(p + 12, path_len);
+            memcpy(p + MAP_ASSET_RECORD_SIZE, (path_len > 0) ? entry->path : "", path_len);
+
+            p += MAP_ASSET_RECORD_SIZE + path_len;
+        }
+
+        for (size_t i = 0; i < job.count; i++) {
+            MapBlock* block = &job.blocks[i];
+            block->offset = file_size;
+            file_size += block->size;
+            cell_count += block->cell_count;
+
+            put_u32(p, block->cx);
+            put_u32(p + 4, block->cy);
+            put_u32(p + 8, block->cell_count);
+            put_u32(p + 12, block->size);
+            put_u32(p + 16, block->checksum);
+            put_u64(p + 20, block->offset);
+            p[28] = block->color.r;
+            p[29] = block->color.g;
+            p[30] = block->color.b;
+            p[31] = block->color.a;
+
+            p += MAP_TOC_RECORD_SIZE;
+        }
+
+        p = meta;
+
+        memcpy(p, MAP_FILE_MAGIC, 4);
+        put_u16(p + 4, MAP_FILE_VERSION);
+        put_u16(p + 6, TILE_CHUNK_SIZE);
+        put_u32(p + 8, palette->sheet_count);
+        put_u32(p + 12, job.count);
+        put_u64(p + 16, asset_offset);
+        put_u64(p + 24, toc_offset);
+        put_u64(p + 32, cell_count);
+        put_f32(p + 40, spawn_point.x);
+        put_f32(p + 44, spawn_point.y);
+    }
+
+    // written next to the destination and renamed over it, a map streaming from the old file keeps reading its own copy
+    FileWriter writer;
+    if (saved && file_writer_open(&writer, path)) {
+        saved = file_writer_write(&writer, meta, meta_size);
+
+        for (size_t i = 0; saved && (i < job.count); i++)
+            saved = file_writer_write(&writer, job.blocks[i].data, job.blocks[i].size);
+
+        if (saved)
+            saved = file_writer_commit(&writer);
+        else
+            file_writer_abort(&writer);
+
+        if (!saved)
+            fprintf(stderr, "map_file_save: failed to write \"%s\"\n", path);
+    } else {
+        saved = false;
+    }
+
+    if (saved && stats) {
+        (*stats) = (MapFileStats) {
+            .chunk_count = job.count,
+            .cell_count = cell_count,
+            .raw_bytes = job.count * MAP_BLOCK_RAW_SIZE,
+            .file_bytes = file_size,
+            .thread_count = nthreads,
+            .seconds = map_file_now() - start,
+        };
+    }
+
+    for (size_t i = 0; i < job.count; i++) {
+        if (job.blocks[i].data) {
+            free(job.blocks[i].data); job.blocks[i].data = NULL;
+        }
+    }
+
+    if (meta) {
+        free(meta); meta = NULL;
+    }
+
+    free(job.blocks); job.blocks = NULL;
+
+    return saved;
+}
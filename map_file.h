@@ -0,0 +1,84 @@
+#ifndef MAP_FILE_H
+#define MAP_FILE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "raylib.h"
+#include "tile_grid.h"
+#include "tile_palette.h"
+#include "asset_cache.h"
+#include "utils.h"
+
+// layout, every field little endian:
+//   header      magic, version, chunk size, counts, section offsets, spawn point (MAP_FILE_HEADER_SIZE bytes)
+//   asset table one record per palette slot at save time: id, sprite size, path
+//   toc         one record per chunk: coordinate, cell count, block offset and size, average color
+//   blocks      one raw deflate stream per chunk, cells stored as byte planes so similar bytes sit together
+#define MAP_FILE_MAGIC "WBMF"
+#define MAP_FILE_VERSION 2 // 1 has no average colors in its toc, it still opens
+#define MAP_FILE_EXTENSION ".wbm"
+#define MAP_FILE_HEADER_SIZE 48
+#define MAP_FILE_MAX_THREADS 16
+
+typedef struct
+{
+    unsigned long int id; // AssetEntry id the sheet was imported from
+    char* path;           // allocated
+    float sprite_size;
+} MapAsset;
+
+// maps a slot of the saved palette onto the live one, returning 0 drops every cell that used it
+typedef unsigned short (*map_slot_funct)(const MapAsset* asset, void* user);
+
+typedef enum
+{
+    MAP_CHUNK_ON_DISK,   // only in the file
+    MAP_CHUNK_REQUESTED, // being read by a background thread
+    MAP_CHUNK_IN_GRID,   // the grid owns the chunk now, saving takes it from there (or drops it if it was erased)
+    MAP_CHUNK_FAILED,    // the block could not be read, never retried
+} MapChunkState;
+
+typedef struct
+{
+    long long key;             // tile_chunk_key of the chunk, the table is sorted by it
+    unsigned long long offset; // of the compressed block
+    unsigned int size;
+    unsigned int checksum;
+    unsigned int version;      // grid version the chunk had when it entered the grid, differs once it is edited
+    Color color;               // alpha weighted average of the cells at save time, what the minimap shows while the chunk is on disk
+    unsigned char state;       // MapChunkState
+} MapChunkEntry;
+
+// a map opened for random access, blocks are inflated straight from the mapping on demand until map_file_close
+typedef struct
+{
+    MappedFile file;
+    MapChunkEntry* chunks;  // allocated
+    size_t chunk_count;
+    unsigned short* slots;  // live palette slot for every saved slot, index 0 unused, allocated
+    size_t slot_count;
+    size_t cell_count;      // as saved
+    Vector2 spawn_point;
+} MapFile;
+
+typedef struct
+{
+    size_t chunk_count;
+    size_t cell_count;
+    size_t raw_bytes;  // block bytes before compression
+    size_t file_bytes;
+    int thread_count;
+    double seconds;    // wall time of the whole save
+} MapFileStats;
+
+// random access operations
+bool map_file_open(MapFile* map, const char* path, const map_slot_funct remap, void* user);
+void map_file_close(MapFile* map);
+long map_file_find_chunk(const MapFile* map, const int cx, const int cy);
+bool map_file_read_chunk(const MapFile* map, const size_t index, TileChunk* chunk);
+
+// whole map operations
+bool map_file_save(const char* path, TileGrid* grid, const TilePalette* palette, AssetCache* cache, const Vector2 spawn_point, const MapFile* source, MapFileStats* stats);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,616 @@
+#include "minimap.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+Minimap minimap_init(const minimap_color_funct resolve, void* user)
+{
+    return (Minimap) {
+        .texture = (Texture){0},
+        .pixels = NULL,
+        .sums = NULL,
+        .chunks = NULL,
+        .origin_cx = 0,
+        .origin_cy = 0,
+        .scale = 0,
+        .min_cx = 0,
+        .min_cy = 0,
+        .max_cx = 0,
+        .max_cy = 0,
+        .bounded = false,
+        .placed = false,
+        .redraw = false,
+        .synced = false,
+        .saved_colors = true,
+        .map = NULL,
+        .resolve = resolve,
+        .user = user,
+        .updated_chunks = 0,
+    };
+}
+
+static void minimap_remove_chunks(Minimap* minimap)
+{
+    MinimapChunk* current, *tmp;
+
+    HASH_ITER(hh, minimap->chunks, current, tmp) {
+        HASH_DEL(minimap->chunks, current);
+        free(current);
+    }
+
+    minimap->chunks = NULL;
+}
+
+void minimap_free(Minimap* minimap)
+{
+    if (!minimap)
+        return;
+
+    minimap_remove_chunks(minimap);
+
+    if (minimap->texture.id != 0) {
+        UnloadTexture(minimap->texture);
+        minimap->texture = (Texture){0};
+    }
+
+    if (minimap->pixels) {
+        free(minimap->pixels); minimap->pixels = NULL;
+    }
+
+    if (minimap->sums) {
+        free(minimap->sums); minimap->sums = NULL;
+    }
+}
+
+// forgets every chunk, for when another map replaces the grid
+void minimap_clear(Minimap* minimap)
+{
+    if (!minimap)
+        return;
+
+    minimap_remove_chunks(minimap);
+
+    minimap->scale = 0;
+    minimap->bounded = false;
+    minimap->placed = false;
+    minimap->synced = false;
+    minimap->saved_colors = true;
+    minimap->map = NULL;
+}
+
+// averages every chunk in the grid again on the next update, the colors cells resolve to have changed
+void minimap_invalidate(Minimap* minimap)
+{
+    if (!minimap)
+        return;
+
+    MinimapChunk* current, *tmp;
+
+    HASH_ITER(hh, minimap->chunks, current, tmp)
+        current->version = 0;
+
+    minimap->synced = false;
+    minimap->saved_colors = false;
+}
+
+static long long minimap_window_chunks(const int scale)
+{
+    return (long long)(MINIMAP_SIZE / MINIMAP_CHUNK_TEXELS) << scale;
+}
+
+static bool minimap_in_window(const Minimap* minimap, const int cx, const int cy)
+{
+    const long long side = minimap_window_chunks(minimap->scale);
+
+    return (cx >= minimap->origin_cx) && (cx < (minimap->origin_cx + side)) && (cy >= minimap->origin_cy) && (cy < (minimap->origin_cy + side));
+}
+
+// each texel is the alpha weighted average of its block of cells, empty cells count as transparent
+static void minimap_average(const Minimap* minimap, const TileChunk* chunk, Color* texels)
+{
+    unsigned int sums[MINIMAP_CHUNK_TEXELS * MINIMAP_CHUNK_TEXELS][4] = {0};
+
+    for (int c = 0; c < TILE_CHUNK_CELLS; c++) {
+        if (tile_cell_is_empty(chunk->cells[c]))
+            continue;
+
+        const Color color = minimap->resolve(chunk->cells[c], minimap->user);
+        const int texel = (((c / TILE_CHUNK_SIZE) / MINIMAP_CELLS_PER_TEXEL) * MINIMAP_CHUNK_TEXELS) + ((c % TILE_CHUNK_SIZE) / MINIMAP_CELLS_PER_TEXEL);
+
+        sums[texel][0] += color.r * color.a;
+        sums[texel][1] += color.g * color.a;
+        sums[texel][2] += color.b * color.a;
+        sums[texel][3] += color.a;
+    }
+
+    for (int t = 0; t < MINIMAP_CHUNK_TEXELS * MINIMAP_CHUNK_TEXELS; t++) {
+        const unsigned int a = sums[t][3];
+
+        texels[t] = (a == 0) ? BLANK : (Color) {
+            .r = sums[t][0] / a,
+            .g = sums[t][1] / a,
+            .b = sums[t][2] / a,
+            .a = a / (MINIMAP_CELLS_PER_TEXEL * MINIMAP_CELLS_PER_TEXEL),
+        };
+    }
+}
+
+// alpha weighted average of a square block of a chunk's texels, the same weighting as the cells they came from
+static Color minimap_blend(const Color* texels, const int x0, const int y0, const int side)
+{
+    unsigned int sums[4] = {0};
+
+    for (int ty = y0; ty < (y0 + side); ty++) {
+        for (int tx = x0; tx < (x0 + side); tx++) {
+            const Color color = texels[(ty * MINIMAP_CHUNK_TEXELS) + tx];
+
+            sums[0] += color.r * color.a;
+            sums[1] += color.g * color.a;
+            sums[2] += color.b * color.a;
+            sums[3] += color.a;
+        }
+    }
+
+    if (sums[3] == 0)
+        return BLANK;
+
+    return (Color) {
+        .r = sums[0] / sums[3],
+        .g = sums[1] / sums[3],
+        .b = sums[2] / sums[3],
+        .a = sums[3] / (side * side),
+    };
+}
+
+static void minimap_flat(Color* texels, const Color color)
+{
+    for (int t = 0; t < MINIMAP_CHUNK_TEXELS * MINIMAP_CHUNK_TEXELS; t++)
+        texels[t] = color;
+}
+
+// writes the chunk's texels, down to one per chunk at MINIMAP_CHUNK_SCALE
+static void minimap_write_chunk(Minimap* minimap, const int cx, const int cy, const Color* texels, const bool upload)
+{
+    const int side = MINIMAP_CHUNK_TEXELS >> minimap->scale;
+    const int step = MINIMAP_CHUNK_TEXELS / side;
+    const int x0 = (cx - minimap->origin_cx) * side;
+    const int y0 = (cy - minimap->origin_cy) * side;
+
+    Color block[MINIMAP_CHUNK_TEXELS * MINIMAP_CHUNK_TEXELS];
+
+    for (int ty = 0; ty < side; ty++) {
+        for (int tx = 0; tx < side; tx++)
+            block[(ty * side) + tx] = (step == 1) ? texels[(ty * MINIMAP_CHUNK_TEXELS) + tx] : minimap_blend(texels, tx * step, ty * step, step);
+
+        memcpy(&minimap->pixels[((y0 + ty) * MINIMAP_SIZE) + x0], &block[ty * side], sizeof(Color) * side);
+    }
+
+    // only the chunk's own texels go to the GPU
+    if (upload)
+        UpdateTextureRec(minimap->texture, (Rectangle){ x0, y0, side, side }, block);
+}
+
+// above MINIMAP_CHUNK_SCALE a texel covers a square of chunks, each one adds its average to the texel's sums
+static size_t minimap_coarse_texel(const Minimap* minimap, const int cx, const int cy)
+{
+    const int shift = minimap->scale - MINIMAP_CHUNK_SCALE;
+
+    return ((size_t)((cy - minimap->origin_cy) >> shift) * MINIMAP_SIZE) + ((cx - minimap->origin_cx) >> shift);
+}
+
+static void minimap_sum(Minimap* minimap, const size_t texel, const Color color, const bool add)
+{
+    unsigned long long* sums = &minimap->sums[texel * 4];
+    const unsigned long long parts[4] = { color.r * color.a, color.g * color.a, color.b * color.a, color.a };
+
+    for (int i = 0; i < 4; i++)
+        sums[i] = (add) ? (sums[i] + parts[i]) : (sums[i] - parts[i]);
+}
+
+static Color minimap_coarse_color(const Minimap* minimap, const size_t texel)
+{
+    const unsigned long long* sums = &minimap->sums[texel * 4];
+    const unsigned long long chunks = 1ull << (2 * (minimap->scale - MINIMAP_CHUNK_SCALE));
+
+    if (sums[3] == 0)
+        return BLANK;
+
+    return (Color) {
+        .r = sums[0] / sums[3],
+        .g = sums[1] / sums[3],
+        .b = sums[2] / sums[3],
+        .a = sums[3] / chunks,
+    };
+}
+
+// repaints the chunk's share of the texture, 'before' is the average it showed until now
+static void minimap_show(Minimap* minimap, const int cx, const int cy, const Color before, const Color* texels, const Color color)
+{
+    if (!minimap->placed || minimap->redraw || !minimap_in_window(minimap, cx, cy))
+        return;
+
+    if (minimap->scale <= MINIMAP_CHUNK_SCALE) {
+        minimap_write_chunk(minimap, cx, cy, texels, true);
+        return;
+    }
+
+    if (!minimap->sums)
+        return;
+
+    const size_t texel = minimap_coarse_texel(minimap, cx, cy);
+
+    minimap_sum(minimap, texel, before, false);
+    minimap_sum(minimap, texel, color, true);
+    minimap->pixels[texel] = minimap_coarse_color(minimap, texel);
+
+    UpdateTextureRec(minimap->texture, (Rectangle){ texel % MINIMAP_SIZE, texel / MINIMAP_SIZE, 1, 1 }, &minimap->pixels[texel]);
+}
+
+static bool minimap_load_texture(Minimap* minimap)
+{
+    minimap->pixels = calloc((size_t)MINIMAP_SIZE * MINIMAP_SIZE, sizeof(Color));
+    if (!minimap->pixels) {
+        fprintf(stderr, "minimap_load_texture: calloc returned null\n");
+        return false;
+    }
+
+    const Image image = {
+        .data = minimap->pixels,
+        .width = MINIMAP_SIZE,
+        .height = MINIMAP_SIZE,
+        .mipmaps = 1,
+        .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8,
+    };
+
+    minimap->texture = LoadTextureFromImage(image);
+    if (minimap->texture.id == 0) {
+        fprintf(stderr, "minimap_load_texture: LoadTextureFromImage failed\n");
+        free(minimap->pixels); minimap->pixels = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+// grows the bounds over the chunk, a chunk outside the window has the next update place it again
+static void minimap_extend(Minimap* minimap, const int cx, const int cy)
+{
+    if (!minimap->bounded) {
+        minimap->min_cx = minimap->max_cx = cx;
+        minimap->min_cy = minimap->max_cy = cy;
+        minimap->bounded = true;
+    }
+
+    minimap->min_cx = (cx < minimap->min_cx) ? cx : minimap->min_cx;
+    minimap->min_cy = (cy < minimap->min_cy) ? cy : minimap->min_cy;
+    minimap->max_cx = (cx > minimap->max_cx) ? cx : minimap->max_cx;
+    minimap->max_cy = (cy > minimap->max_cy) ? cy : minimap->max_cy;
+
+    if (minimap->placed && !minimap_in_window(minimap, cx, cy))
+        minimap->placed = false;
+}
+
+// the finest scale whose window holds the bounds, centered on them, bounds only grow so the scale never goes back down
+static void minimap_place(Minimap* minimap)
+{
+    const long long span_x = (long long)minimap->max_cx - minimap->min_cx + 1;
+    const long long span_y = (long long)minimap->max_cy - minimap->min_cy + 1;
+    const long long span = (span_x > span_y) ? span_x : span_y;
+
+    // a texel of slack on each side, aligning the origin to whole texels then never pushes a chunk out
+    int scale = 0;
+    while ((scale < MINIMAP_MAX_SCALE) && ((span + (2ll << ((scale > MINIMAP_CHUNK_SCALE) ? (scale - MINIMAP_CHUNK_SCALE) : 0))) > minimap_window_chunks(scale)))
+        scale++;
+
+    const long long side = minimap_window_chunks(scale);
+    const int shift = (scale > MINIMAP_CHUNK_SCALE) ? (scale - MINIMAP_CHUNK_SCALE) : 0;
+
+    minimap->scale = scale;
+    minimap->origin_cx = (int)(((minimap->min_cx - ((side - span_x) / 2)) >> shift) << shift);
+    minimap->origin_cy = (int)(((minimap->min_cy - ((side - span_y) / 2)) >> shift) << shift);
+    minimap->placed = true;
+    minimap->redraw = true;
+}
+
+// rewrites the whole texture, the averages the map saved first, then every entry over them
+static void minimap_redraw(Minimap* minimap)
+{
+    const bool coarse = minimap->scale > MINIMAP_CHUNK_SCALE;
+
+    memset(minimap->pixels, 0, sizeof(Color) * MINIMAP_SIZE * MINIMAP_SIZE);
+
+    if (coarse && !minimap->sums) {
+        minimap->sums = malloc(sizeof(unsigned long long) * 4 * MINIMAP_SIZE * MINIMAP_SIZE);
+        if (!minimap->sums) {
+            fprintf(stderr, "minimap_redraw: malloc returned null\n");
+            return;
+        }
+    }
+
+    if (coarse)
+        memset(minimap->sums, 0, sizeof(unsigned long long) * 4 * MINIMAP_SIZE * MINIMAP_SIZE);
+
+    Color flat[MINIMAP_CHUNK_TEXELS * MINIMAP_CHUNK_TEXELS];
+
+    for (size_t i = 0; minimap->map && (i < minimap->map->chunk_count); i++) {
+        const MapChunkEntry* saved = &minimap->map->chunks[i];
+        const int cx = (int)(saved->key >> 32);
+        const int cy = (int)(saved->key & 0xFFFFFFFF);
+
+        MinimapChunk* entry;
+        HASH_FIND(hh, minimap->chunks, &saved->key, sizeof(saved->key), entry);
+
+        if (entry || !minimap_in_window(minimap, cx, cy))
+            continue;
+
+        if (coarse) {
+            minimap_sum(minimap, minimap_coarse_texel(minimap, cx, cy), saved->color, true);
+            continue;
+        }
+
+        minimap_flat(flat, saved->color);
+        minimap_write_chunk(minimap, cx, cy, flat, false);
+    }
+
+    MinimapChunk* entry, *tmp;
+
+    HASH_ITER(hh, minimap->chunks, entry, tmp) {
+        if (!minimap_in_window(minimap, entry->cx, entry->cy))
+            continue;
+
+        if (coarse)
+            minimap_sum(minimap, minimap_coarse_texel(minimap, entry->cx, entry->cy), entry->color, true);
+        else
+            minimap_write_chunk(minimap, entry->cx, entry->cy, entry->texels, false);
+    }
+
+    for (size_t t = 0; coarse && (t < (size_t)MINIMAP_SIZE * MINIMAP_SIZE); t++)
+        minimap->pixels[t] = minimap_coarse_color(minimap, t);
+
+    UpdateTexture(minimap->texture, minimap->pixels);
+}
+
+// what a chunk without an entry shows, the average the map saved for it
+static Color minimap_saved_color(const Minimap* minimap, const int cx, const int cy)
+{
+    const long index = map_file_find_chunk(minimap->map, cx, cy);
+
+    return (index >= 0) ? minimap->map->chunks[index].color : BLANK;
+}
+
+// the chunk holds just what its block does, so the saved average already describes it
+static bool minimap_unedited(const Minimap* minimap, const TileChunk* chunk)
+{
+    const long index = map_file_find_chunk(minimap->map, chunk->cx, chunk->cy);
+
+    return (index >= 0) && (minimap->map->chunks[index].state == MAP_CHUNK_IN_GRID) && (minimap->map->chunks[index].version == chunk->version);
+}
+
+// brings the chunk's entry in step with the grid, averaging its cells only when they changed
+static void minimap_sync_chunk(Minimap* minimap, const TileChunk* chunk)
+{
+    minimap_extend(minimap, chunk->cx, chunk->cy);
+
+    MinimapChunk* entry;
+    HASH_FIND(hh, minimap->chunks, &chunk->key, sizeof(chunk->key), entry);
+
+    if (entry)
+        entry->seen = true;
+
+    // at a texel per chunk or coarser, a chunk streamed in untouched shows no more than its saved average
+    if (minimap->saved_colors && (minimap->scale >= MINIMAP_CHUNK_SCALE) && minimap_unedited(minimap, chunk)) {
+        if (!entry)
+            return;
+
+        const Color saved = minimap_saved_color(minimap, chunk->cx, chunk->cy);
+        Color flat[MINIMAP_CHUNK_TEXELS * MINIMAP_CHUNK_TEXELS];
+
+        minimap_flat(flat, saved);
+        minimap_show(minimap, chunk->cx, chunk->cy, entry->color, flat, saved);
+
+        HASH_DEL(minimap->chunks, entry);
+        free(entry);
+        return;
+    }
+
+    // versions tell the edited chunks apart, only those are averaged again
+    if (entry && (entry->version == chunk->version) && (entry->version != 0))
+        return;
+
+    const Color before = (entry) ? entry->color : minimap_saved_color(minimap, chunk->cx, chunk->cy);
+
+    if (!entry) {
+        entry = calloc(1, sizeof(MinimapChunk));
+        if (!entry) {
+            fprintf(stderr, "minimap_sync_chunk: calloc returned null\n");
+            return;
+        }
+
+        entry->key = chunk->key;
+        entry->cx = chunk->cx;
+        entry->cy = chunk->cy;
+        entry->seen = true;
+        HASH_ADD(hh, minimap->chunks, key, sizeof(entry->key), entry);
+    }
+
+    minimap_average(minimap, chunk, entry->texels);
+    entry->color = minimap_blend(entry->texels, 0, 0, MINIMAP_CHUNK_TEXELS);
+    entry->version = chunk->version;
+    minimap->updated_chunks++;
+
+    minimap_show(minimap, chunk->cx, chunk->cy, before, entry->texels, entry->color);
+}
+
+// the grid no longer holds the chunk: streamed out it shows what the map saved, erased it goes blank
+static void minimap_drop_chunk(Minimap* minimap, const long long key, const int cx, const int cy)
+{
+    MinimapChunk* entry;
+    HASH_FIND(hh, minimap->chunks, &key, sizeof(key), entry);
+
+    const long index = map_file_find_chunk(minimap->map, cx, cy);
+    const bool on_disk = (index >= 0) && ((minimap->map->chunks[index].state == MAP_CHUNK_ON_DISK) || (minimap->map->chunks[index].state == MAP_CHUNK_REQUESTED));
+
+    Color flat[MINIMAP_CHUNK_TEXELS * MINIMAP_CHUNK_TEXELS];
+
+    // streamed out or painted over before its block came in and erased again, either way the file has the cells
+    if (on_disk) {
+        if (!entry)
+            return;
+
+        const Color saved = minimap->map->chunks[index].color;
+
+        minimap_flat(flat, saved);
+        minimap_show(minimap, cx, cy, entry->color, flat, saved);
+
+        HASH_DEL(minimap->chunks, entry);
+        free(entry);
+        return;
+    }
+
+    // blank already, version 0 and off disk is only ever an erased chunk
+    if (entry && (entry->version == 0))
+        return;
+
+    if (!entry && (index < 0))
+        return;
+
+    const Color before = (entry) ? entry->color : minimap->map->chunks[index].color;
+
+    // a chunk the map has a block for keeps a blank entry, without one it would fall back to the saved average
+    if (!entry) {
+        entry = calloc(1, sizeof(MinimapChunk));
+        if (!entry) {
+            fprintf(stderr, "minimap_drop_chunk: calloc returned null\n");
+            return;
+        }
+
+        entry->key = key;
+        entry->cx = cx;
+        entry->cy = cy;
+        HASH_ADD(hh, minimap->chunks, key, sizeof(entry->key), entry);
+    }
+
+    memset(entry->texels, 0, sizeof(entry->texels));
+    entry->color = BLANK;
+    entry->version = 0;
+
+    minimap_show(minimap, cx, cy, before, entry->texels, entry->color);
+
+    if (index < 0) {
+        HASH_DEL(minimap->chunks, entry);
+        free(entry);
+    }
+}
+
+// every chunk of the grid, for the first update on a grid or when its dirty list ran out of room
+static void minimap_walk(Minimap* minimap, TileGrid* grid)
+{
+    MinimapChunk* entry, *tmp;
+
+    HASH_ITER(hh, minimap->chunks, entry, tmp)
+        entry->seen = false;
+
+    TileChunk* chunk, *next;
+
+    HASH_ITER(hh, grid->chunks, chunk, next)
+        minimap_sync_chunk(minimap, chunk);
+
+    HASH_ITER(hh, minimap->chunks, entry, tmp) {
+        if (!entry->seen)
+            minimap_drop_chunk(minimap, entry->key, entry->cx, entry->cy);
+    }
+
+    // a chunk erased after it streamed in left no entry behind when it was never averaged, its saved average no longer holds
+    for (size_t i = 0; minimap->map && (i < minimap->map->chunk_count); i++) {
+        const MapChunkEntry* saved = &minimap->map->chunks[i];
+        const int cx = (int)(saved->key >> 32);
+        const int cy = (int)(saved->key & 0xFFFFFFFF);
+
+        if ((saved->state == MAP_CHUNK_IN_GRID) && !tile_grid_find_chunk(grid, cx, cy))
+            minimap_drop_chunk(minimap, saved->key, cx, cy);
+    }
+}
+
+// call once per frame with the chunk the view is centered on, costs nothing while the grid lists no dirty chunk
+void minimap_update(Minimap* minimap, TileGrid* grid, const MapFile* map, const int focus_cx, const int focus_cy)
+{
+    if (!minimap || !grid || !minimap->resolve)
+        return;
+
+    minimap->updated_chunks = 0;
+
+    if (!minimap->pixels && !minimap_load_texture(minimap))
+        return;
+
+    // a map opened since the last update replaced the whole grid, its toc gives the extent before any chunk streams in
+    if (map != minimap->map) {
+        minimap_clear(minimap);
+        minimap->map = map;
+
+        for (size_t i = 0; map && (i < map->chunk_count); i++)
+            minimap_extend(minimap, (int)(map->chunks[i].key >> 32), (int)(map->chunks[i].key & 0xFFFFFFFF));
+    }
+
+    // the view stays on the minimap even when it wanders off the map
+    minimap_extend(minimap, focus_cx, focus_cy);
+
+    if (!minimap->placed)
+        minimap_place(minimap);
+
+    if (!minimap->synced || grid->dirty_overflow) {
+        minimap_walk(minimap, grid);
+        minimap->synced = true;
+    }
+    else {
+        for (size_t i = 0; i < grid->dirty_count; i++) {
+            const long long key = grid->dirty[i];
+            const int cx = (int)(key >> 32);
+            const int cy = (int)(key & 0xFFFFFFFF);
+
+            const TileChunk* chunk = tile_grid_find_chunk(grid, cx, cy);
+
+            if (chunk)
+                minimap_sync_chunk(minimap, chunk);
+            else
+                minimap_drop_chunk(minimap, key, cx, cy);
+        }
+    }
+
+    tile_grid_clear_dirty(grid);
+
+    // a chunk landed outside the window, which is placed again around the grown bounds
+    if (!minimap->placed)
+        minimap_place(minimap);
+
+    if (minimap->redraw) {
+        minimap_redraw(minimap);
+        minimap->redraw = false;
+    }
+}
+
+Vector2 minimap_texel_to_cell(const Minimap* minimap, const Vector2 texel)
+{
+    if (!minimap)
+        return (Vector2){0,0};
+
+    const float cells = (float)MINIMAP_CELLS_PER_TEXEL * (float)(1 << minimap->scale);
+
+    return (Vector2) {
+        .x = ((float)minimap->origin_cx * TILE_CHUNK_SIZE) + (texel.x * cells),
+        .y = ((float)minimap->origin_cy * TILE_CHUNK_SIZE) + (texel.y * cells),
+    };
+}
+
+Vector2 minimap_cell_to_texel(const Minimap* minimap, const Vector2 cell)
+{
+    if (!minimap)
+        return (Vector2){0,0};
+
+    const float cells = (float)MINIMAP_CELLS_PER_TEXEL * (float)(1 << minimap->scale);
+
+    return (Vector2) {
+        .x = (cell.x - ((float)minimap->origin_cx * TILE_CHUNK_SIZE)) / cells,
+        .y = (cell.y - ((float)minimap->origin_cy * TILE_CHUNK_SIZE)) / cells,
+    };
+}
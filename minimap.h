@@ -0,0 +1,64 @@
+#ifndef MINIMAP_H
+#define MINIMAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "raylib.h"
+#include "uthash.h"
+#include "tile_grid.h"
+#include "map_file.h"
+
+#define MINIMAP_SIZE 256              // texels per texture side, the whole map is scaled to fit
+#define MINIMAP_CHUNK_TEXELS 4        // texels per chunk side at the finest scale, each one averages a square block of cells
+#define MINIMAP_CELLS_PER_TEXEL (TILE_CHUNK_SIZE / MINIMAP_CHUNK_TEXELS)
+#define MINIMAP_CHUNK_SCALE 2         // the scale at which a chunk is one texel, coarser ones average several chunks per texel
+#define MINIMAP_MAX_SCALE 24          // a window of 2^30 chunks per side, wider than any int cell coordinate reaches
+
+// the color a cell shows on the minimap
+typedef Color (*minimap_color_funct)(const TileCell cell, void* user);
+
+// a chunk the grid holds or held, chunks only on disk show the average the map saved for them and have none
+typedef struct
+{
+    UT_hash_handle hh;     // for hashing operations, keyed by 'key'
+    long long key;         // tile_chunk_key of the chunk
+    int cx, cy;
+    unsigned int version;  // TileChunk version the texels were averaged from, 0 once the chunk left the grid
+    bool seen;             // found in the grid by the current full walk
+    Color color;           // average of the texels, what the chunk adds to a texel at coarse scales
+    Color texels[MINIMAP_CHUNK_TEXELS * MINIMAP_CHUNK_TEXELS];
+} MinimapChunk;
+
+typedef struct
+{
+    Texture texture;            // MINIMAP_SIZE square, loaded by the first update
+    Color* pixels;              // CPU copy of the texture, rewritten in full only when the window is placed again, allocated
+    unsigned long long* sums;   // alpha weighted r, g, b and alpha summed over every chunk of a texel, only above MINIMAP_CHUNK_SCALE, allocated
+    MinimapChunk* chunks;       // uthash head
+    int origin_cx, origin_cy;   // chunk at the texture's top left corner
+    int scale;                  // a texel's side is MINIMAP_CELLS_PER_TEXEL << scale cells
+    int min_cx, min_cy;         // chunks the map and the grid cover so far, with the focus, the window is fitted around them
+    int max_cx, max_cy;
+    bool bounded;               // the bounds hold at least one chunk
+    bool placed;                // the window fits the bounds, cleared when a chunk lands outside of it
+    bool redraw;                // the window was placed again, the whole texture is rewritten at the end of the update
+    bool synced;                // entries match the grid, the grid's dirty list is all there is to read
+    bool saved_colors;          // the map's averages still match what cells resolve to, cleared by minimap_invalidate
+    const MapFile* map;         // map the last update streamed from, another one means another world
+    minimap_color_funct resolve;
+    void* user;
+
+    // per update stats
+    size_t updated_chunks;
+} Minimap;
+
+Minimap minimap_init(const minimap_color_funct resolve, void* user);
+void minimap_free(Minimap* minimap);
+void minimap_clear(Minimap* minimap);
+void minimap_invalidate(Minimap* minimap);
+void minimap_update(Minimap* minimap, TileGrid* grid, const MapFile* map, const int focus_cx, const int focus_cy);
+Vector2 minimap_texel_to_cell(const Minimap* minimap, const Vector2 texel);
+Vector2 minimap_cell_to_texel(const Minimap* minimap, const Vector2 cell);
+
+#endif
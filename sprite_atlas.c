@@ -0,0 +1,468 @@
+#include "sprite_atlas.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rlgl.h"
+
+// raylib already links a copy of stb_rect_pack, keep this one private to the translation unit
+#if defined(__GNUC__)
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wunused-function"
+#endif
+
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "external/stb_rect_pack.h"
+
+#if defined(__GNUC__)
+    #pragma GCC diagnostic pop
+#endif
+
+struct AtlasPage
+{
+    Texture texture;
+    stbrp_context packer;
+    stbrp_node nodes[SPRITE_ATLAS_PAGE_SIZE];
+};
+
+static AtlasPage* atlas_page_init()
+{
+    AtlasPage* page = malloc(sizeof(AtlasPage));
+    if (!page) {
+        fprintf(stderr, "atlas_page_init: malloc returned null\n");
+        return NULL;
+    }
+
+    // storage only, nothing is sampled outside the bands and every band is written with its gutters
+    page->texture = (Texture) {
+        .id = rlLoadTexture(NULL, SPRITE_ATLAS_PAGE_SIZE, SPRITE_ATLAS_PAGE_SIZE, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, 1),
+        .width = SPRITE_ATLAS_PAGE_SIZE,
+        .height = SPRITE_ATLAS_PAGE_SIZE,
+        .mipmaps = 1,
+        .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8,
+    };
+
+    if (!IsTextureReady(page->texture)) {
+        free(page); page = NULL;
+        return NULL;
+    }
+
+    stbrp_init_target(&page->packer, SPRITE_ATLAS_PAGE_SIZE, SPRITE_ATLAS_PAGE_SIZE, page->nodes, SPRITE_ATLAS_PAGE_SIZE);
+
+    return page;
+}
+
+static void atlas_page_free(AtlasPage* page)
+{
+    if (!page)
+        return;
+
+    if (IsTextureReady(page->texture))
+        UnloadTexture(page->texture);
+
+    free(page); page = NULL;
+}
+
+static AtlasPage* sprite_atlas_new_page(SpriteAtlas* atlas)
+{
+    AtlasPage** pages = realloc(atlas->pages, sizeof(AtlasPage*) * (atlas->page_count + 1));
+    if (!pages) {
+        fprintf(stderr, "sprite_atlas_new_page: realloc returned null\n");
+        return NULL;
+    }
+
+    atlas->pages = pages;
+
+    AtlasPage* page = atlas_page_init();
+    if (page)
+        atlas->pages[atlas->page_count++] = page;
+
+    return page;
+}
+
+SpriteAtlas sprite_atlas_init()
+{
+    return (SpriteAtlas) {
+        .pages = NULL,
+        .page_count = 0,
+        .sheets = NULL,
+        .sheet_count = 0,
+    };
+}
+
+void sprite_atlas_free(SpriteAtlas* atlas)
+{
+    if (!atlas)
+        return;
+
+    for (size_t i = 0; i < atlas->page_count; i++)
+        atlas_page_free(atlas->pages[i]);
+
+    for (size_t i = 0; i < atlas->sheet_count; i++) {
+        if (atlas->sheets[i].sprites) {
+            free(atlas->sheets[i].sprites); atlas->sheets[i].sprites = NULL;
+        }
+
+        if (atlas->sheets[i].bands) {
+            free(atlas->sheets[i].bands); atlas->sheets[i].bands = NULL;
+        }
+    }
+
+    if (atlas->pages) {
+        free(atlas->pages); atlas->pages = NULL;
+    }
+
+    if (atlas->sheets) {
+        free(atlas->sheets); atlas->sheets = NULL;
+    }
+
+    atlas->page_count = atlas->sheet_count = 0;
+}
+
+// copies one cell of a R8G8B8A8 image into dest, 'stride' bytes apart per row, whatever hangs off the image edge is left alone
+static void copy_cell_pixels(unsigned char* dest, const size_t stride, const Image* image, const Rectangle source)
+{
+    const int size = source.width;
+    const int x0 = source.x, y0 = source.y;
+
+    const int w = ((x0 + size) <= image->width) ? size : (image->width - x0);
+    const int h = ((y0 + size) <= image->height) ? size : (image->height - y0);
+
+    for (int y = 0; y < h; y++)
+        memcpy(dest + ((size_t)y * stride), (unsigned char*)image->data + (((size_t)(y0 + y) * image->width) + x0) * 4, (size_t)w * 4);
+}
+
+bool atlas_staging_init(AtlasStaging* staging, const PaletteSheet* sheet, const Image* image)
+{
+    if (!staging || !sheet || !image || !IsImageReady(*image))
+        return false;
+
+    (*staging) = (AtlasStaging){0};
+
+    const int size = sheet->sprite_size;
+    const int padded = size + (SPRITE_ATLAS_PADDING * 2);
+    const int nsprites = palette_sheet_sprite_count(sheet);
+
+    if ((size <= 0) || (padded > SPRITE_ATLAS_PAGE_SIZE))
+        return false;
+
+    if (nsprites == 0)
+        return true;
+
+    // as wide as a page allows, a band of rows then fills a page with a single rect
+    const int columns = (nsprites < (SPRITE_ATLAS_PAGE_SIZE / padded)) ? nsprites : (SPRITE_ATLAS_PAGE_SIZE / padded);
+    const int rows = (nsprites + columns - 1) / columns;
+    const size_t stride = (size_t)columns * padded * 4;
+
+    Image rgba = (image->format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) ? (*image) : ImageCopy(*image);
+    if (rgba.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8)
+        ImageFormat(&rgba, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+    // gutters and cells hanging off the sheet edge stay transparent
+    unsigned char* pixels = (IsImageReady(rgba) && (rgba.format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8)) ? calloc((size_t)rows * padded, stride) : NULL;
+
+    if (pixels) {
+        int cell = -1;
+
+        for (int sprite = 0; sprite < nsprites; sprite++) {
+            cell = palette_sheet_next_cell(sheet, cell);
+
+            const int x = ((sprite % columns) * padded) + SPRITE_ATLAS_PADDING;
+            const int y = ((sprite / columns) * padded) + SPRITE_ATLAS_PADDING;
+
+            copy_cell_pixels(pixels + ((size_t)y * stride) + ((size_t)x * 4), stride, &rgba, palette_sheet_sprite_rect(sheet, cell));
+        }
+    }
+
+    else
+        fprintf(stderr, "atlas_staging_init: failed to stage %d sprites\n", nsprites);
+
+    if (rgba.data != image->data)
+        UnloadImage(rgba);
+
+    if (!pixels)
+        return false;
+
+    (*staging) = (AtlasStaging) {
+        .pixels = pixels,
+        .columns = columns,
+        .rows = rows,
+        .padded = padded,
+        .sprite_count = nsprites,
+    };
+
+    return true;
+}
+
+void atlas_staging_free(AtlasStaging* staging)
+{
+    if (!staging)
+        return;
+
+    if (staging->pixels) {
+        free(staging->pixels); staging->pixels = NULL;
+    }
+
+    staging->columns = staging->rows = staging->sprite_count = 0;
+}
+
+// places the staging rows as few bands as the pages allow, fitting as many rows as possible on the pages already open
+static bool sprite_atlas_place_bands(SpriteAtlas* atlas, AtlasSheet* atlas_sheet, const AtlasStaging* staging)
+{
+    const int width = staging->columns * staging->padded;
+    const int page_rows = SPRITE_ATLAS_PAGE_SIZE / staging->padded;
+
+    int row = 0;
+
+    // a single row always fits an empty page, so this ends
+    for (size_t p = 0; row < staging->rows; ) {
+        AtlasPage* page = (p < atlas->page_count) ? atlas->pages[p] : sprite_atlas_new_page(atlas);
+        if (!page)
+            return false;
+
+        int rows = ((staging->rows - row) < page_rows) ? (staging->rows - row) : page_rows;
+        stbrp_rect rect = {0};
+
+        // a rect that does not fit leaves the packer as it was, so fewer rows can be tried on the same page
+        for (; rows > 0; rows /= 2) {
+            rect = (stbrp_rect){ .w = width, .h = rows * staging->padded };
+            stbrp_pack_rects(&page->packer, &rect, 1);
+
+            if (rect.was_packed)
+                break;
+        }
+
+        if (rows == 0) {
+            p++;
+            continue;
+        }
+
+        AtlasBand* bands = realloc(atlas_sheet->bands, sizeof(AtlasBand) * (atlas_sheet->band_count + 1));
+        if (!bands) {
+            fprintf(stderr, "sprite_atlas_place_bands: realloc returned null\n");
+            return false;
+        }
+
+        atlas_sheet->bands = bands;
+        atlas_sheet->bands[atlas_sheet->band_count++] = (AtlasBand) {
+            .page = p + 1,
+            .x = rect.x,
+            .y = rect.y,
+            .first_row = row,
+            .rows = rows,
+        };
+
+        row += rows;
+    }
+
+    return true;
+}
+
+static AtlasSheet* sprite_atlas_get_sheet(const SpriteAtlas* atlas, const unsigned short slot)
+{
+    if (!atlas || (slot == 0) || (slot > atlas->sheet_count) || !atlas->sheets[slot - 1].sprites)
+        return NULL;
+
+    return &atlas->sheets[slot - 1];
+}
+
+// places the bands of a freshly imported sheet, none of its sprites is looked up in the atlas before sprite_atlas_map_sheet
+// earlier sheets are never moved so existing mappings stay valid
+bool sprite_atlas_place_sheet(SpriteAtlas* atlas, const unsigned short slot, const PaletteSheet* sheet, const AtlasStaging* staging)
+{
+    if (!atlas || !sheet || (slot == 0) || !staging)
+        return false;
+
+    const int ncells = palette_sheet_cell_count(sheet);
+    if ((ncells <= 0) || (staging->sprite_count != palette_sheet_sprite_count(sheet)))
+        return false;
+
+    if (slot > atlas->sheet_count) {
+        AtlasSheet* sheets = realloc(atlas->sheets, sizeof(AtlasSheet) * slot);
+        if (!sheets) {
+            fprintf(stderr, "sprite_atlas_place_sheet: realloc returned null\n");
+            return false;
+        }
+
+        memset(sheets + atlas->sheet_count, 0, sizeof(AtlasSheet) * (slot - atlas->sheet_count));
+
+        atlas->sheets = sheets;
+        atlas->sheet_count = slot;
+    }
+
+    AtlasSheet* atlas_sheet = &atlas->sheets[slot - 1];
+    if (atlas_sheet->sprites)
+        return false;
+
+    // page 0 everywhere, lookups fall back to the sheet texture until the rows are up
+    atlas_sheet->sprites = calloc(ncells, sizeof(AtlasSprite));
+    if (!atlas_sheet->sprites) {
+        fprintf(stderr, "sprite_atlas_place_sheet: calloc returned null\n");
+        return false;
+    }
+
+    atlas_sheet->cell_count = ncells;
+    atlas_sheet->sprite_size = sheet->sprite_size;
+    atlas_sheet->columns = staging->columns;
+
+    return (staging->sprite_count == 0) || sprite_atlas_place_bands(atlas, atlas_sheet, staging);
+}
+
+// uploads staging rows [first_row, first_row + rows) into the bands holding them, one texture update per band touched
+// the staging has to be laid out like the one the bands were placed for
+bool sprite_atlas_upload_rows(SpriteAtlas* atlas, const unsigned short slot, const AtlasStaging* staging, const int first_row, const int rows)
+{
+    const AtlasSheet* atlas_sheet = sprite_atlas_get_sheet(atlas, slot);
+    if (!atlas_sheet || !staging || !staging->pixels || (staging->columns != atlas_sheet->columns) || (staging->padded != (int)atlas_sheet->sprite_size + (SPRITE_ATLAS_PADDING * 2)))
+        return false;
+
+    const int last_row = first_row + rows;
+    const size_t stride = (size_t)staging->columns * staging->padded * 4;
+
+    for (size_t b = 0; b < atlas_sheet->band_count; b++) {
+        const AtlasBand band = atlas_sheet->bands[b];
+        const int from = (first_row > band.first_row) ? first_row : band.first_row;
+        const int to = (last_row < (band.first_row + band.rows)) ? last_row : (band.first_row + band.rows);
+
+        if (from >= to)
+            continue;
+
+        const Rectangle rect = { band.x, band.y + ((from - band.first_row) * staging->padded), staging->columns * staging->padded, (to - from) * staging->padded };
+
+        UpdateTextureRec(atlas->pages[band.page - 1]->texture, rect, staging->pixels + ((size_t)from * staging->padded * stride));
+    }
+
+    return true;
+}
+
+// maps every listed cell to its place in the bands, once their rows are uploaded lookups hand out the atlas rects
+void sprite_atlas_map_sheet(SpriteAtlas* atlas, const unsigned short slot, const PaletteSheet* sheet)
+{
+    AtlasSheet* atlas_sheet = sprite_atlas_get_sheet(atlas, slot);
+    if (!atlas_sheet || !sheet || (atlas_sheet->cell_count != palette_sheet_cell_count(sheet)))
+        return;
+
+    const int nsprites = palette_sheet_sprite_count(sheet);
+    const int padded = atlas_sheet->sprite_size + (SPRITE_ATLAS_PADDING * 2);
+    int cell = -1;
+
+    for (size_t b = 0; b < atlas_sheet->band_count; b++) {
+        const AtlasBand band = atlas_sheet->bands[b];
+        const int first = band.first_row * atlas_sheet->columns;
+        const int last = (band.first_row + band.rows) * atlas_sheet->columns;
+
+        for (int sprite = first; (sprite < last) && (sprite < nsprites); sprite++) {
+            cell = palette_sheet_next_cell(sheet, cell);
+
+            atlas_sheet->sprites[cell] = (AtlasSprite) {
+                .page = band.page,
+                .x = band.x + (((sprite - first) % atlas_sheet->columns) * padded) + SPRITE_ATLAS_PADDING,
+                .y = band.y + (((sprite - first) / atlas_sheet->columns) * padded) + SPRITE_ATLAS_PADDING,
+            };
+        }
+    }
+}
+
+// packs and uploads the listed sprites of a freshly imported sheet in one go
+bool sprite_atlas_add_sheet(SpriteAtlas* atlas, const unsigned short slot, const PaletteSheet* sheet, const Image* image)
+{
+    if (!atlas || !sheet || (slot == 0) || !image || !IsImageReady(*image))
+        return false;
+
+    if (sprite_atlas_get_sheet(atlas, slot))
+        return true;
+
+    AtlasStaging staging;
+    bool packed_all = atlas_staging_init(&staging, sheet, image) && sprite_atlas_place_sheet(atlas, slot, sheet, &staging);
+
+    if (packed_all && (staging.rows > 0))
+        packed_all = sprite_atlas_upload_rows(atlas, slot, &staging, 0, staging.rows);
+
+    sprite_atlas_map_sheet(atlas, slot, sheet);
+
+    atlas_staging_free(&staging);
+
+    if (!packed_all)
+        fprintf(stderr, "sprite_atlas_add_sheet: some sprites of slot %d were left in their sheet texture\n", slot);
+
+    return packed_all;
+}
+
+// rewrites the packed sprites of a sheet whose file changed, sprites keep their place so lookups and meshes stay valid
+bool sprite_atlas_update_sheet(SpriteAtlas* atlas, const unsigned short slot, const PaletteSheet* sheet, const Image* image)
+{
+    if (!atlas || !sheet || (slot == 0) || (slot > atlas->sheet_count) || !image || !IsImageReady(*image))
+        return false;
+
+    const AtlasSheet* atlas_sheet = &atlas->sheets[slot - 1];
+    if (!atlas_sheet->sprites || (atlas_sheet->cell_count != palette_sheet_cell_count(sheet)))
+        return false;
+
+    Image rgba = (image->format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) ? (*image) : ImageCopy(*image);
+    if (rgba.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8)
+        ImageFormat(&rgba, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+    bool updated = IsImageReady(rgba) && (rgba.format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+    const int padded = atlas_sheet->sprite_size + (SPRITE_ATLAS_PADDING * 2);
+    const int width = atlas_sheet->columns * padded;
+    const size_t stride = (size_t)width * 4;
+
+    // each band is rebuilt from the new pixels of the cells packed into it, then goes up in one update
+    for (size_t b = 0; updated && (b < atlas_sheet->band_count); b++) {
+        const AtlasBand band = atlas_sheet->bands[b];
+        const int height = band.rows * padded;
+
+        unsigned char* pixels = calloc(height, stride);
+        if (!pixels) {
+            fprintf(stderr, "sprite_atlas_update_sheet: calloc returned null\n");
+            updated = false;
+            break;
+        }
+
+        for (int cell = 0; cell < atlas_sheet->cell_count; cell++) {
+            const AtlasSprite sprite = atlas_sheet->sprites[cell];
+
+            if ((sprite.page != band.page) || (sprite.x < band.x) || (sprite.y < band.y) || (sprite.x >= (band.x + width)) || (sprite.y >= (band.y + height)))
+                continue;
+
+            copy_cell_pixels(pixels + ((size_t)(sprite.y - band.y) * stride) + ((size_t)(sprite.x - band.x) * 4), stride, &rgba, palette_sheet_sprite_rect(sheet, cell));
+        }
+
+        UpdateTextureRec(atlas->pages[band.page - 1]->texture, (Rectangle){ band.x, band.y, width, height }, pixels);
+
+        free(pixels); pixels = NULL;
+    }
+
+    if (rgba.data != image->data)
+        UnloadImage(rgba);
+
+    return updated;
+}
+
+// returns false when the sprite was not packed, the caller then draws it from its sheet texture
+bool sprite_atlas_lookup(const SpriteAtlas* atlas, const unsigned short slot, const int cell, Texture* texture, Rectangle* source)
+{
+    if (!atlas || (slot == 0) || (slot > atlas->sheet_count) || !texture || !source)
+        return false;
+
+    const AtlasSheet* sheet = &atlas->sheets[slot - 1];
+    if (!sheet->sprites || (cell < 0) || (cell >= sheet->cell_count))
+        return false;
+
+    const AtlasSprite sprite = sheet->sprites[cell];
+    if ((sprite.page == 0) || (sprite.page > atlas->page_count))
+        return false;
+
+    (*texture) = atlas->pages[sprite.page - 1]->texture;
+    (*source) = (Rectangle) {
+        .x = sprite.x,
+        .y = sprite.y,
+        .width = sheet->sprite_size,
+        .height = sheet->sprite_size,
+    };
+
+    return true;
+}
\ No newline at end of file
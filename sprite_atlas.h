@@ -0,0 +1,72 @@
+#ifndef SPRITE_ATLAS_H
+#define SPRITE_ATLAS_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "raylib.h"
+#include "tile_palette.h"
+
+#define SPRITE_ATLAS_PAGE_SIZE 2048 // width and height of every atlas page
+#define SPRITE_ATLAS_PADDING 1      // transparent gutter around each sprite so neighbours never bleed
+
+typedef struct AtlasPage AtlasPage; // page texture plus its packer state, defined in sprite_atlas.c
+
+typedef struct
+{
+    unsigned short page; // 1-based page the sprite was packed into, 0 when it was not packed
+    unsigned short x, y; // top left corner of the sprite inside the page
+} AtlasSprite;
+
+// a run of staging rows placed as one rect, and uploaded with one call
+typedef struct
+{
+    unsigned short page;      // 1-based
+    unsigned short x, y;      // top left corner inside the page
+    unsigned short first_row; // first staging row it holds
+    unsigned short rows;
+} AtlasBand;
+
+typedef struct
+{
+    AtlasSprite* sprites; // one per cell of the palette sheet, allocated
+    int cell_count;
+    float sprite_size;
+    AtlasBand* bands;     // allocated
+    size_t band_count;
+    int columns;          // sprites per band row, every band is as wide
+} AtlasSheet;
+
+// the listed sprites of a sheet laid out row after row with their gutters, so a band of rows goes up as one texture update
+typedef struct
+{
+    unsigned char* pixels; // R8G8B8A8, 'columns' padded sprites per row, allocated
+    int columns;
+    int rows;
+    int padded;            // sprite size plus the gutter on both sides
+    int sprite_count;
+} AtlasStaging;
+
+typedef struct
+{
+    AtlasPage** pages;   // allocated, each page is allocated on its own since the packer keeps pointers into itself
+    size_t page_count;
+    AtlasSheet* sheets;  // indexed by palette slot - 1, allocated
+    size_t sheet_count;
+} SpriteAtlas;
+
+// staging operations, these only touch memory
+bool atlas_staging_init(AtlasStaging* staging, const PaletteSheet* sheet, const Image* image);
+void atlas_staging_free(AtlasStaging* staging);
+
+// atlas operations
+SpriteAtlas sprite_atlas_init();
+void sprite_atlas_free(SpriteAtlas* atlas);
+bool sprite_atlas_place_sheet(SpriteAtlas* atlas, const unsigned short slot, const PaletteSheet* sheet, const AtlasStaging* staging);
+bool sprite_atlas_upload_rows(SpriteAtlas* atlas, const unsigned short slot, const AtlasStaging* staging, const int first_row, const int rows);
+void sprite_atlas_map_sheet(SpriteAtlas* atlas, const unsigned short slot, const PaletteSheet* sheet);
+bool sprite_atlas_add_sheet(SpriteAtlas* atlas, const unsigned short slot, const PaletteSheet* sheet, const Image* image);
+bool sprite_atlas_update_sheet(SpriteAtlas* atlas, const unsigned short slot, const PaletteSheet* sheet, const Image* image);
+bool sprite_atlas_lookup(const SpriteAtlas* atlas, const unsigned short slot, const int cell, Texture* texture, Rectangle* source);
+
+#endif
\ No newline at end of file
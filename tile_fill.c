@@ -0,0 +1,429 @@
+#include "tile_fill.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "uthash.h"
+
+// a chunk row is handled as one mask, so it has to fit a word
+_Static_assert(TILE_CHUNK_SIZE <= 64, "tile_fill: a chunk row must fit in 64 bits");
+
+#define FILL_ROW_BITS ((TILE_CHUNK_SIZE == 64) ? ~0ULL : ((1ULL << (TILE_CHUNK_SIZE % 64)) - 1))
+
+#define FILL_CACHE_SIZE 256 // direct mapped, a scanline touches a row of chunks over and over
+
+// one chunk a flood fill has looked at
+typedef struct
+{
+    UT_hash_handle hh;                          // for hashing operations, keyed by 'key'
+    long long key;                              // tile_chunk_key of the chunk
+    int cx, cy;
+    unsigned long long match[TILE_CHUNK_WORDS]; // cells holding the target value, worked out once
+    unsigned long long mask[TILE_CHUNK_WORDS];  // cells the fill has reached
+} FillRegion;
+
+typedef struct
+{
+    int x, y;
+} FillSeed;
+
+typedef struct
+{
+    TileGrid* grid;
+    TileCell target;          // value every cell of the region has
+    FillRegion* regions;      // uthash head
+    FillRegion* cache[FILL_CACHE_SIZE];
+    size_t cell_count;
+    FillBounds bounds;        // of every span marked so far
+    FillSeed* stack;          // allocated
+    size_t stack_count;
+    size_t stack_capacity;
+} FloodState;
+
+_Static_assert(sizeof(TileCell) == 6, "tile_fill: a cell is compared as a 4 and a 2 byte word");
+
+// two word compares rather than four field compares, a region's match mask runs this on every cell of its chunk
+static bool fill_cell_equal(const TileCell a, const TileCell b)
+{
+    unsigned int a_low, b_low;
+    unsigned short a_high, b_high;
+
+    memcpy(&a_low, &a, 4); memcpy(&a_high, (const unsigned char*)&a + 4, 2);
+    memcpy(&b_low, &b, 4); memcpy(&b_high, (const unsigned char*)&b + 4, 2);
+
+    return (a_low == b_low) & (a_high == b_high);
+}
+
+static bool fill_cell_matches(const TileCell cell, const TileCell target)
+{
+    if (tile_cell_is_empty(target))
+        return tile_cell_is_empty(cell);
+
+    return fill_cell_equal(cell, target);
+}
+
+static size_t fill_mask_count(const unsigned long long* mask)
+{
+    size_t count = 0;
+
+    for (int w = 0; w < TILE_CHUNK_WORDS; w++)
+        count += __builtin_popcountll(mask[w]);
+
+    return count;
+}
+
+// every cell of each row in the inclusive local span
+static void fill_mask_span(unsigned long long* mask, const int lx0, const int ly0, const int lx1, const int ly1)
+{
+    const int width = lx1 - lx0 + 1; // at most TILE_CHUNK_SIZE, so the shift below is defined
+    const unsigned long long row = ((1ULL << width) - 1) << lx0;
+
+    for (int ly = ly0; ly <= ly1; ly++) {
+        const int cell = ly * TILE_CHUNK_SIZE;
+        mask[cell / 64] |= row << (cell & 63);
+    }
+}
+
+size_t tile_fill_rect(EditHistory* history, TileGrid* grid, const int x0, const int y0, const int x1, const int y1, const TileCell cell)
+{
+    if (!history || !grid)
+        return 0;
+
+    const int min_x = (x0 < x1) ? x0 : x1, max_x = (x0 < x1) ? x1 : x0;
+    const int min_y = (y0 < y1) ? y0 : y1, max_y = (y0 < y1) ? y1 : y0;
+
+    const size_t cell_count = (size_t)(max_x - min_x + 1) * (size_t)(max_y - min_y + 1);
+    if (cell_count > TILE_FILL_MAX_CELLS) {
+        fprintf(stderr, "tile_fill_rect: %zu cells is over the %d cell limit\n", cell_count, TILE_FILL_MAX_CELLS);
+        return 0;
+    }
+
+    const bool implicit = !history->open;
+    if (implicit)
+        edit_history_begin(history, history->closed_at, false);
+
+    size_t filled = 0;
+    bool failed = false;
+
+    // one masked write per chunk, interior chunks take the full mask
+    for (int cy = tile_chunk_coord(min_y); !failed && (cy <= tile_chunk_coord(max_y)); cy++) {
+        const int chunk_y = cy * TILE_CHUNK_SIZE;
+        const int ly0 = (min_y > chunk_y) ? (min_y - chunk_y) : 0;
+        const int ly1 = (max_y < (chunk_y + TILE_CHUNK_SIZE - 1)) ? (max_y - chunk_y) : (TILE_CHUNK_SIZE - 1);
+
+        for (int cx = tile_chunk_coord(min_x); !failed && (cx <= tile_chunk_coord(max_x)); cx++) {
+            const int chunk_x = cx * TILE_CHUNK_SIZE;
+            const int lx0 = (min_x > chunk_x) ? (min_x - chunk_x) : 0;
+            const int lx1 = (max_x < (chunk_x + TILE_CHUNK_SIZE - 1)) ? (max_x - chunk_x) : (TILE_CHUNK_SIZE - 1);
+
+            unsigned long long mask[TILE_CHUNK_WORDS] = {0};
+            fill_mask_span(mask, lx0, ly0, lx1, ly1);
+
+            // the chunks written so far stay written and undo as one step with the rest of the entry
+            if (!edit_history_fill(history, grid, cx, cy, mask, cell)) {
+                fprintf(stderr, "tile_fill_rect: failed to write chunk (%d, %d), %zu of %zu cells filled\n", cx, cy, filled, cell_count);
+                failed = true;
+                break;
+            }
+
+            filled += fill_mask_count(mask);
+        }
+    }
+
+    if (implicit)
+        edit_history_end(history, history->closed_at);
+
+    return filled;
+}
+
+static FillRegion* flood_region(FloodState* state, const int cx, const int cy)
+{
+    const unsigned int slot = ((unsigned int)cx * 31u + (unsigned int)cy) & (FILL_CACHE_SIZE - 1);
+
+    FillRegion* region = state->cache[slot];
+    if (region && (region->cx == cx) && (region->cy == cy))
+        return region;
+
+    const long long key = tile_chunk_key(cx, cy);
+
+    HASH_FIND(hh, state->regions, &key, sizeof(key), region);
+
+    if (!region) {
+        region = calloc(1, sizeof(FillRegion));
+        if (!region) {
+            fprintf(stderr, "flood_region: calloc returned null\n");
+            return NULL;
+        }
+
+        region->key = key;
+        region->cx = cx;
+        region->cy = cy;
+
+        const TileChunk* chunk = tile_grid_find_chunk(state->grid, cx, cy);
+
+        // a missing chunk is empty throughout
+        for (int w = 0; !chunk && tile_cell_is_empty(state->target) && (w < TILE_CHUNK_WORDS); w++)
+            region->match[w] = ~0ULL;
+
+        // a word at a time so the bits build up in a register, with the empty target, the one every fill over blank space has, split out
+        for (int w = 0; chunk && (w < TILE_CHUNK_WORDS); w++) {
+            const TileCell* cells = &chunk->cells[w * 64];
+            unsigned long long match = 0;
+
+            if (tile_cell_is_empty(state->target)) {
+                for (int c = 0; c < 64; c++)
+                    match |= (unsigned long long)tile_cell_is_empty(cells[c]) << c;
+            }
+            else {
+                for (int c = 0; c < 64; c++)
+                    match |= (unsigned long long)fill_cell_equal(cells[c], state->target) << c;
+            }
+
+            region->match[w] = match;
+        }
+
+        HASH_ADD(hh, state->regions, key, sizeof(region->key), region);
+    }
+
+    state->cache[slot] = region;
+
+    return region;
+}
+
+// one bit per cell of row y in chunk cx that belongs to the region and has not been reached yet, all clear if out of memory
+static unsigned long long flood_row_open(FloodState* state, const int cx, const int y)
+{
+    const FillRegion* region = flood_region(state, cx, tile_chunk_coord(y));
+    if (!region)
+        return 0;
+
+    const int row = (y & (TILE_CHUNK_SIZE - 1)) * TILE_CHUNK_SIZE;
+
+    return ((region->match[row / 64] & ~region->mask[row / 64]) >> (row & 63)) & FILL_ROW_BITS;
+}
+
+static bool flood_push(FloodState* state, const int x, const int y)
+{
+    if (state->stack_count == state->stack_capacity) {
+        const size_t capacity = (state->stack_capacity) ? (state->stack_capacity * 2) : 256;
+
+        FillSeed* stack = realloc(state->stack, sizeof(FillSeed) * capacity);
+        if (!stack) {
+            fprintf(stderr, "flood_push: realloc returned null\n");
+            return false;
+        }
+
+        state->stack = stack;
+        state->stack_capacity = capacity;
+    }
+
+    state->stack[state->stack_count++] = (FillSeed){ .x = x, .y = y };
+
+    return true;
+}
+
+// walks the open run through x to its ends a chunk row at a time, gives up once it is wider than 'limit'
+static bool flood_span(FloodState* state, const int x, const int y, const size_t limit, int* x0, int* x1)
+{
+    int left = x;
+
+    while (true) {
+        const int cx = tile_chunk_coord(left);
+        const int lx = left & (TILE_CHUNK_SIZE - 1);
+        const unsigned long long open = flood_row_open(state, cx, y);
+
+        // the cell just past the previous chunk's edge is closed, the run started there
+        if (!((open >> lx) & 1)) {
+            left++;
+            break;
+        }
+
+        // closed cells at or below lx
+        const unsigned long long gaps = ~open & ((lx == 63) ? ~0ULL : ((2ULL << lx) - 1));
+
+        if (gaps) {
+            left = (cx * TILE_CHUNK_SIZE) + (63 - __builtin_clzll(gaps)) + 1;
+            break;
+        }
+
+        left = (cx * TILE_CHUNK_SIZE) - 1;
+
+        if ((size_t)(x - left) > limit)
+            return false;
+    }
+
+    int right = x;
+
+    while (true) {
+        const int cx = tile_chunk_coord(right);
+        const int lx = right & (TILE_CHUNK_SIZE - 1);
+        const unsigned long long open = flood_row_open(state, cx, y);
+
+        if (!((open >> lx) & 1)) {
+            right--;
+            break;
+        }
+
+        // closed cells at or above lx, the bits past the row count as closed
+        const unsigned long long gaps = (~open | ~FILL_ROW_BITS) & ~((1ULL << lx) - 1);
+
+        if (gaps && (__builtin_ctzll(gaps) < TILE_CHUNK_SIZE)) {
+            right = (cx * TILE_CHUNK_SIZE) + __builtin_ctzll(gaps) - 1;
+            break;
+        }
+
+        right = (cx * TILE_CHUNK_SIZE) + TILE_CHUNK_SIZE;
+
+        if ((size_t)(right - left) > limit)
+            return false;
+    }
+
+    if ((size_t)(right - left + 1) > limit)
+        return false;
+
+    (*x0) = left;
+    (*x1) = right;
+
+    return true;
+}
+
+// marks [x0, x1] of row y, one mask write per chunk the span crosses
+static bool flood_mark(FloodState* state, const int x0, const int x1, const int y)
+{
+    const int ly = y & (TILE_CHUNK_SIZE - 1);
+
+    if (state->cell_count == 0)
+        state->bounds = (FillBounds){ .x0 = x0, .y0 = y, .x1 = x1, .y1 = y };
+
+    state->bounds.x0 = (x0 < state->bounds.x0) ? x0 : state->bounds.x0;
+    state->bounds.x1 = (x1 > state->bounds.x1) ? x1 : state->bounds.x1;
+    state->bounds.y0 = (y < state->bounds.y0) ? y : state->bounds.y0;
+    state->bounds.y1 = (y > state->bounds.y1) ? y : state->bounds.y1;
+
+    for (int x = x0; x <= x1;) {
+        const int cx = tile_chunk_coord(x);
+        const int chunk_end = (cx * TILE_CHUNK_SIZE) + TILE_CHUNK_SIZE - 1;
+        const int end = (x1 < chunk_end) ? x1 : chunk_end;
+
+        FillRegion* region = flood_region(state, cx, tile_chunk_coord(y));
+        if (!region)
+            return false;
+
+        fill_mask_span(region->mask, x & (TILE_CHUNK_SIZE - 1), ly, end & (TILE_CHUNK_SIZE - 1), ly);
+
+        state->cell_count += end - x + 1;
+        x = end + 1;
+    }
+
+    return true;
+}
+
+// queues a seed at the start of every open run in row y between x0 and x1, a run crossing a chunk edge keeps the seed of the chunk it started in
+static bool flood_scan(FloodState* state, const int x0, const int x1, const int y)
+{
+    // the last cell of the previous chunk was open, so this chunk's first cell continues its run
+    unsigned long long carry = 0;
+
+    for (int x = x0; x <= x1;) {
+        const int cx = tile_chunk_coord(x);
+        const int base = cx * TILE_CHUNK_SIZE;
+        const int end = (x1 < (base + TILE_CHUNK_SIZE - 1)) ? x1 : (base + TILE_CHUNK_SIZE - 1);
+
+        const unsigned long long span = ((2ULL << (end - base)) - 1) & ~((1ULL << (x - base)) - 1);
+        const unsigned long long open = flood_row_open(state, cx, y) & span;
+
+        for (unsigned long long starts = open & ~((open << 1) | carry); starts; starts &= starts - 1) {
+            if (!flood_push(state, base + __builtin_ctzll(starts), y))
+                return false;
+        }
+
+        carry = (open >> (TILE_CHUNK_SIZE - 1)) & 1;
+        x = end + 1;
+    }
+
+    return true;
+}
+
+static void flood_state_free(FloodState* state)
+{
+    FillRegion* current, *tmp;
+
+    HASH_ITER(hh, state->regions, current, tmp) {
+        HASH_DEL(state->regions, current);
+        free(current);
+    }
+
+    state->regions = NULL;
+
+    if (state->stack) {
+        free(state->stack); state->stack = NULL;
+    }
+}
+
+// scanline fill with an explicit stack, the region is found in full before anything is written so a refused fill leaves the grid untouched
+// 'bounds' is optional and only written when something was filled
+size_t tile_fill_flood(EditHistory* history, TileGrid* grid, const int x, const int y, const TileCell cell, const size_t max_cells, FillBounds* bounds)
+{
+    if (!history || !grid)
+        return 0;
+
+    FloodState state = {
+        .grid = grid,
+        .target = tile_grid_get(grid, x, y),
+    };
+
+    if (fill_cell_matches(cell, state.target))
+        return 0;
+
+    bool failed = !flood_push(&state, x, y);
+
+    while (!failed && (state.stack_count > 0)) {
+        const FillSeed seed = state.stack[--state.stack_count];
+
+        // reached through another run since it was queued
+        if (!((flood_row_open(&state, tile_chunk_coord(seed.x), seed.y) >> (seed.x & (TILE_CHUNK_SIZE - 1))) & 1))
+            continue;
+
+        // an open row never ends on its own, the span stops growing once it alone would break the limit
+        int x0, x1;
+        if (!flood_span(&state, seed.x, seed.y, max_cells - state.cell_count, &x0, &x1)) {
+            fprintf(stderr, "tile_fill_flood: region is over the %zu cell limit\n", max_cells);
+            failed = true;
+            break;
+        }
+
+        failed = !flood_mark(&state, x0, x1, seed.y) || !flood_scan(&state, x0, x1, seed.y - 1) || !flood_scan(&state, x0, x1, seed.y + 1);
+    }
+
+    size_t filled = 0;
+
+    if (!failed) {
+        const bool implicit = !history->open;
+        if (implicit)
+            edit_history_begin(history, history->closed_at, false);
+
+        FillRegion* region, *tmp;
+
+        // chunks that were only looked at carry an empty mask, filling them is a no-op
+        HASH_ITER(hh, state.regions, region, tmp) {
+            if (!edit_history_fill(history, grid, region->cx, region->cy, region->mask, cell)) {
+                fprintf(stderr, "tile_fill_flood: failed to write chunk (%d, %d), %zu of %zu cells filled\n", region->cx, region->cy, filled, state.cell_count);
+                break;
+            }
+
+            filled += fill_mask_count(region->mask);
+        }
+
+        if (implicit)
+            edit_history_end(history, history->closed_at);
+
+        if (bounds)
+            (*bounds) = state.bounds;
+    }
+
+    flood_state_free(&state);
+
+    return filled;
+}
@@ -0,0 +1,21 @@
+#ifndef TILE_FILL_H
+#define TILE_FILL_H
+
+#include <stddef.h>
+
+#include "tile_grid.h"
+#include "edit_history.h"
+
+#define TILE_FILL_MAX_CELLS (1 << 22) // bigger fills are refused, an unbounded flood would otherwise cover the whole plane
+
+// inclusive cell bounds of what a fill covered
+typedef struct
+{
+    int x0, y0, x1, y1;
+} FillBounds;
+
+// both write through the history, opening an entry of their own if none is open, and return the number of cells written, a chunk that fails to write stops the fill
+size_t tile_fill_rect(EditHistory* history, TileGrid* grid, const int x0, const int y0, const int x1, const int y1, const TileCell cell);
+size_t tile_fill_flood(EditHistory* history, TileGrid* grid, const int x, const int y, const TileCell cell, const size_t max_cells, FillBounds* bounds);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,523 @@
+#include "tile_grid.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool tile_cell_is_empty(const TileCell cell)
+{
+    return cell.sheet == 0;
+}
+
+long long tile_chunk_key(const int cx, const int cy)
+{
+    return (long long)(((unsigned long long)(unsigned int)cx << 32) | (unsigned int)cy);
+}
+
+int tile_chunk_coord(const int cell_coord)
+{
+    // floor division, so that cell -1 lands in chunk -1 and not chunk 0
+    return (cell_coord >= 0) ? (cell_coord / TILE_CHUNK_SIZE) : (((cell_coord + 1) / TILE_CHUNK_SIZE) - 1);
+}
+
+static int tile_chunk_local(const int cell_coord)
+{
+    return cell_coord & (TILE_CHUNK_SIZE - 1);
+}
+
+TileCell* tile_chunk_cell(TileChunk* chunk, const int x, const int y)
+{
+    if (!chunk)
+        return NULL;
+
+    return &chunk->cells[(tile_chunk_local(y) * TILE_CHUNK_SIZE) + tile_chunk_local(x)];
+}
+
+TileGrid tile_grid_init()
+{
+    return (TileGrid) {
+        .chunks = NULL,
+        .cell_count = 0,
+        .revision = 0,
+        .last = NULL,
+        .spare = NULL,
+        .spare_count = 0,
+        .spare_capacity = 0,
+        .dirty = NULL,
+        .dirty_count = 0,
+        .dirty_capacity = 0,
+        .dirty_overflow = false,
+        .dirty_revision = 0,
+    };
+}
+
+void tile_grid_free(TileGrid* grid)
+{
+    if (!grid)
+        return;
+
+    TileChunk* current, *tmp;
+
+    HASH_ITER(hh, grid->chunks, current, tmp) {
+        HASH_DEL(grid->chunks, current);
+        free(current);
+    }
+
+    grid->chunks = NULL;
+    grid->last = NULL;
+    grid->cell_count = 0;
+
+    for (size_t i = 0; i < grid->spare_count; i++)
+        free(grid->spare[i]);
+
+    free(grid->spare); grid->spare = NULL;
+    grid->spare_count = 0;
+    grid->spare_capacity = 0;
+
+    free(grid->dirty); grid->dirty = NULL;
+    grid->dirty_count = 0;
+    grid->dirty_capacity = 0;
+    grid->dirty_overflow = false;
+}
+
+// lists the chunk's key once per clear, a chunk written since is still listed from the first write
+static void tile_grid_mark_dirty(TileGrid* grid, const TileChunk* chunk)
+{
+    if ((chunk->version > grid->dirty_revision) || grid->dirty_overflow)
+        return;
+
+    if (grid->dirty_count == grid->dirty_capacity) {
+        const size_t capacity = (grid->dirty_capacity) ? (grid->dirty_capacity * 2) : 64;
+
+        long long* dirty = (capacity <= TILE_GRID_DIRTY_CHUNKS) ? realloc(grid->dirty, sizeof(long long) * capacity) : NULL;
+
+        // full or out of memory, the reader falls back to walking every chunk
+        if (!dirty) {
+            grid->dirty_overflow = true;
+            return;
+        }
+
+        grid->dirty = dirty;
+        grid->dirty_capacity = capacity;
+    }
+
+    grid->dirty[grid->dirty_count++] = chunk->key;
+}
+
+TileChunk* tile_grid_find_chunk(const TileGrid* grid, const int cx, const int cy)
+{
+    if (!grid)
+        return NULL;
+
+    const long long key = tile_chunk_key(cx, cy);
+
+    if (grid->last && (grid->last->key == key))
+        return grid->last;
+
+    TileChunk* found = NULL;
+
+    HASH_FIND(hh, grid->chunks, &key, sizeof(key), found);
+
+    // only a lookup cache, a grid is never shared between threads
+    if (found)
+        ((TileGrid*)grid)->last = found;
+
+    return found;
+}
+
+TileChunk* tile_grid_get_chunk(TileGrid* grid, const int cx, const int cy)
+{
+    if (!grid)
+        return NULL;
+
+    TileChunk* chunk = tile_grid_find_chunk(grid, cx, cy);
+    if (chunk)
+        return chunk;
+
+    // a spare chunk was paged in already, clearing it costs a fraction of what a fresh allocation does
+    if (grid->spare_count > 0) {
+        chunk = grid->spare[--grid->spare_count];
+        memset(chunk, 0, sizeof(TileChunk));
+    }
+    else {
+        // calloc leaves every cell with sheet 0, i.e empty
+        chunk = calloc(1, sizeof(TileChunk));
+        if (!chunk) {
+            fprintf(stderr, "tile_grid_get_chunk: calloc returned null\n");
+            return NULL;
+        }
+    }
+
+    chunk->cx = cx;
+    chunk->cy = cy;
+    chunk->key = tile_chunk_key(cx, cy);
+
+    HASH_ADD(hh, grid->chunks, key, sizeof(chunk->key), chunk);
+    grid->last = chunk;
+
+    return chunk;
+}
+
+// takes ownership of a chunk built outside the grid (cx, cy, count and cells set), replacing any chunk already at its coordinate
+bool tile_grid_insert_chunk(TileGrid* grid, TileChunk* chunk)
+{
+    if (!grid || !chunk)
+        return false;
+
+    TileChunk* existing = tile_grid_find_chunk(grid, chunk->cx, chunk->cy);
+    if (existing)
+        tile_grid_remove_chunk(grid, existing);
+
+    if (chunk->count == 0) {
+        free(chunk); chunk = NULL;
+        return true;
+    }
+
+    chunk->key = tile_chunk_key(chunk->cx, chunk->cy);
+    chunk->version = 0;
+    tile_grid_touch_chunk(grid, chunk);
+
+    HASH_ADD(hh, grid->chunks, key, sizeof(chunk->key), chunk);
+    grid->cell_count += chunk->count;
+
+    return true;
+}
+
+// frees the chunk outright, streaming evicts through here and expects the memory back
+void tile_grid_remove_chunk(TileGrid* grid, TileChunk* chunk)
+{
+    if (!grid || !chunk)
+        return;
+
+    tile_grid_mark_dirty(grid, chunk);
+
+    grid->cell_count -= chunk->count;
+
+    if (grid->last == chunk)
+        grid->last = NULL;
+
+    HASH_DEL(grid->chunks, chunk);
+
+    free(chunk); chunk = NULL;
+}
+
+// bumps the chunk's version and lists it dirty, for cells written in place outside the grid's own operations
+void tile_grid_touch_chunk(TileGrid* grid, TileChunk* chunk)
+{
+    if (!grid || !chunk)
+        return;
+
+    tile_grid_mark_dirty(grid, chunk);
+    chunk->version = ++grid->revision;
+}
+
+// empties the dirty list, called by its reader once every listed chunk was looked at
+void tile_grid_clear_dirty(TileGrid* grid)
+{
+    if (!grid)
+        return;
+
+    grid->dirty_count = 0;
+    grid->dirty_overflow = false;
+    grid->dirty_revision = grid->revision;
+}
+
+// a chunk a write left empty, undo or the next stroke is likely to fill it again, so it goes to the spares while there is room
+static void tile_grid_drop_chunk(TileGrid* grid, TileChunk* chunk)
+{
+    if (grid->spare_count == grid->spare_capacity) {
+        const size_t capacity = (grid->spare_capacity) ? (grid->spare_capacity * 2) : 64;
+
+        TileChunk** spare = (capacity <= TILE_GRID_SPARE_CHUNKS) ? realloc(grid->spare, sizeof(TileChunk*) * capacity) : NULL;
+
+        // full or out of memory, the chunk is simply freed
+        if (!spare) {
+            tile_grid_remove_chunk(grid, chunk);
+            return;
+        }
+
+        grid->spare = spare;
+        grid->spare_capacity = capacity;
+    }
+
+    grid->cell_count -= chunk->count;
+
+    if (grid->last == chunk)
+        grid->last = NULL;
+
+    HASH_DEL(grid->chunks, chunk);
+
+    grid->spare[grid->spare_count++] = chunk;
+}
+
+TileCell tile_grid_get(const TileGrid* grid, const int x, const int y)
+{
+    TileChunk* chunk = tile_grid_find_chunk(grid, tile_chunk_coord(x), tile_chunk_coord(y));
+    if (!chunk)
+        return (TileCell){0};
+
+    return *tile_chunk_cell(chunk, x, y);
+}
+
+bool tile_grid_set(TileGrid* grid, const int x, const int y, const TileCell cell)
+{
+    if (!grid)
+        return false;
+
+    if (tile_cell_is_empty(cell)) {
+        tile_grid_erase(grid, x, y);
+        return true;
+    }
+
+    TileChunk* chunk = tile_grid_get_chunk(grid, tile_chunk_coord(x), tile_chunk_coord(y));
+    if (!chunk)
+        return false;
+
+    TileCell* dest = tile_chunk_cell(chunk, x, y);
+
+    if (tile_cell_is_empty(*dest)) {
+        chunk->count++;
+        grid->cell_count++;
+    }
+
+    (*dest) = cell;
+    tile_grid_touch_chunk(grid, chunk);
+
+    return true;
+}
+
+void tile_grid_erase(TileGrid* grid, const int x, const int y)
+{
+    TileChunk* chunk = tile_grid_find_chunk(grid, tile_chunk_coord(x), tile_chunk_coord(y));
+    if (!chunk)
+        return;
+
+    TileCell* dest = tile_chunk_cell(chunk, x, y);
+    if (tile_cell_is_empty(*dest))
+        return;
+
+    (*dest) = (TileCell){0};
+    tile_grid_touch_chunk(grid, chunk);
+    chunk->count--;
+    grid->cell_count--;
+
+    // chunks only exist while they hold something
+    if (chunk->count == 0)
+        tile_grid_drop_chunk(grid, chunk);
+}
+
+// writes a whole chunk's worth of cells in one go, 'cells' holds one value per set bit of 'mask' in cell order
+bool tile_grid_write_masked(TileGrid* grid, const int cx, const int cy, const unsigned long long* mask, const TileCell* cells)
+{
+    if (!grid || !mask || !cells)
+        return false;
+
+    TileChunk* chunk = tile_grid_find_chunk(grid, cx, cy);
+
+    if (!chunk) {
+        // nothing to clear in a chunk that does not exist, only create it if something lands in it
+        bool any = false;
+        size_t n = 0;
+
+        for (int w = 0; (w < TILE_CHUNK_WORDS) && !any; w++) {
+            for (unsigned long long bits = mask[w]; bits && !any; bits &= bits - 1, n++)
+                any = !tile_cell_is_empty(cells[n]);
+        }
+
+        if (!any)
+            return true;
+
+        chunk = tile_grid_get_chunk(grid, cx, cy);
+        if (!chunk)
+            return false;
+    }
+
+    size_t n = 0;
+
+    for (int w = 0; w < TILE_CHUNK_WORDS; w++) {
+        for (unsigned long long bits = mask[w]; bits; bits &= bits - 1, n++) {
+            TileCell* dest = &chunk->cells[(w * 64) + __builtin_ctzll(bits)];
+
+            const bool was_empty = tile_cell_is_empty(*dest);
+            const bool is_empty = tile_cell_is_empty(cells[n]);
+
+            (*dest) = cells[n];
+
+            if (was_empty && !is_empty) {
+                chunk->count++;
+                grid->cell_count++;
+            }
+            else if (!was_empty && is_empty) {
+                chunk->count--;
+                grid->cell_count--;
+            }
+        }
+    }
+
+    tile_grid_touch_chunk(grid, chunk);
+
+    if (chunk->count == 0)
+        tile_grid_drop_chunk(grid, chunk);
+
+    return true;
+}
+
+// writes 'cell' into every cell whose bit is set in mask, the chunk is marked dirty once however many cells change
+bool tile_grid_fill_masked(TileGrid* grid, const int cx, const int cy, const unsigned long long* mask, const TileCell cell)
+{
+    if (!grid || !mask)
+        return false;
+
+    const bool is_empty = tile_cell_is_empty(cell);
+    const TileCell value = (is_empty) ? (TileCell){0} : cell;
+
+    TileChunk* chunk = (is_empty) ? tile_grid_find_chunk(grid, cx, cy) : tile_grid_get_chunk(grid, cx, cy);
+    if (!chunk)
+        return is_empty;
+
+    // cells that were empty before the write
+    unsigned int was_empty = 0;
+    unsigned int written = 0;
+
+    for (int w = 0; w < TILE_CHUNK_WORDS; w++) {
+        // whole words are the common case for fills, a plain loop over them skips the bit scan
+        if (mask[w] == ~0ULL) {
+            TileCell* dest = &chunk->cells[w * 64];
+
+            // a full chunk has no empty cell to count, painting over a finished floor is a plain store loop
+            if (chunk->count == TILE_CHUNK_CELLS) {
+                for (int c = 0; c < 64; c++)
+                    dest[c] = value;
+            }
+            else {
+                for (int c = 0; c < 64; c++) {
+                    was_empty += tile_cell_is_empty(dest[c]);
+                    dest[c] = value;
+                }
+            }
+
+            written += 64;
+            continue;
+        }
+
+        for (unsigned long long bits = mask[w]; bits; bits &= bits - 1, written++) {
+            TileCell* dest = &chunk->cells[(w * 64) + __builtin_ctzll(bits)];
+
+            was_empty += tile_cell_is_empty(*dest);
+            (*dest) = value;
+        }
+    }
+
+    const unsigned int filled = written - was_empty;
+    const unsigned int now_filled = (is_empty) ? 0 : written;
+
+    chunk->count = chunk->count - filled + now_filled;
+    grid->cell_count = grid->cell_count - filled + now_filled;
+    tile_grid_touch_chunk(grid, chunk);
+
+    if (chunk->count == 0)
+        tile_grid_drop_chunk(grid, chunk);
+
+    return true;
+}
+
+size_t tile_grid_chunk_count(const TileGrid* grid)
+{
+    return (grid) ? HASH_COUNT(grid->chunks) : 0;
+}
+
+// spare chunks are left out, their number is bounded by TILE_GRID_SPARE_CHUNKS and evicting can not shrink it
+size_t tile_grid_memory_usage(const TileGrid* grid)
+{
+    if (!grid)
+        return 0;
+
+    return (tile_grid_chunk_count(grid) * sizeof(TileChunk)) + HASH_OVERHEAD(hh, grid->chunks);
+}
+
+void tile_grid_for_each_chunk(TileGrid* grid, const tile_chunk_funct funct, void* user)
+{
+    if (!grid || !funct)
+        return;
+
+    TileChunk* current, *tmp;
+
+    // tmp keeps the iteration valid if funct removes the chunk it was handed
+    HASH_ITER(hh, grid->chunks, current, tmp)
+        funct(current, user);
+}
+
+void tile_grid_query_chunks(TileGrid* grid, const int x0, const int y0, const int x1, const int y1, const tile_chunk_funct funct, void* user)
+{
+    if (!grid || !funct || (x1 < x0) || (y1 < y0))
+        return;
+
+    const int cx0 = tile_chunk_coord(x0), cx1 = tile_chunk_coord(x1);
+    const int cy0 = tile_chunk_coord(y0), cy1 = tile_chunk_coord(y1);
+
+    const double area = ((double)cx1 - cx0 + 1) * ((double)cy1 - cy0 + 1);
+
+    // probe every coordinate of a small window, but walk the table when the window holds more slots than there are chunks
+    if (area <= tile_grid_chunk_count(grid)) {
+        for (int cy = cy0; cy <= cy1; cy++) {
+            for (int cx = cx0; cx <= cx1; cx++) {
+                TileChunk* chunk = tile_grid_find_chunk(grid, cx, cy);
+                if (chunk)
+                    funct(chunk, user);
+            }
+        }
+    }
+
+    else {
+        TileChunk* current, *tmp;
+
+        HASH_ITER(hh, grid->chunks, current, tmp) {
+            if ((current->cx >= cx0) && (current->cx <= cx1) && (current->cy >= cy0) && (current->cy <= cy1))
+                funct(current, user);
+        }
+    }
+}
+
+typedef struct
+{
+    int x0, y0, x1, y1;
+    tile_cell_funct funct;
+    void* user;
+} TileCellQuery;
+
+static void tile_grid_query_chunk_cells(TileChunk* chunk, void* user)
+{
+    const TileCellQuery* query = (TileCellQuery*) user;
+
+    const int base_x = chunk->cx * TILE_CHUNK_SIZE;
+    const int base_y = chunk->cy * TILE_CHUNK_SIZE;
+
+    // clip the query window to this chunk
+    const int lx0 = (query->x0 > base_x) ? (query->x0 - base_x) : 0;
+    const int ly0 = (query->y0 > base_y) ? (query->y0 - base_y) : 0;
+    const int lx1 = (query->x1 < base_x + TILE_CHUNK_SIZE - 1) ? (query->x1 - base_x) : (TILE_CHUNK_SIZE - 1);
+    const int ly1 = (query->y1 < base_y + TILE_CHUNK_SIZE - 1) ? (query->y1 - base_y) : (TILE_CHUNK_SIZE - 1);
+
+    for (int ly = ly0; ly <= ly1; ly++) {
+        for (int lx = lx0; lx <= lx1; lx++) {
+            const TileCell cell = chunk->cells[(ly * TILE_CHUNK_SIZE) + lx];
+            if (!tile_cell_is_empty(cell))
+                query->funct(base_x + lx, base_y + ly, cell, query->user);
+        }
+    }
+}
+
+void tile_grid_query(TileGrid* grid, const int x0, const int y0, const int x1, const int y1, const tile_cell_funct funct, void* user)
+{
+    if (!funct)
+        return;
+
+    TileCellQuery query = {
+        .x0 = x0, .y0 = y0,
+        .x1 = x1, .y1 = y1,
+        .funct = funct,
+        .user = user,
+    };
+
+    tile_grid_query_chunks(grid, x0, y0, x1, y1, tile_grid_query_chunk_cells, &query);
+}
\ No newline at end of file
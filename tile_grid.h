@@ -0,0 +1,90 @@
+#ifndef TILE_GRID_H
+#define TILE_GRID_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "uthash.h"
+
+#define TILE_CHUNK_SIZE 32 // cells per chunk side, must be a power of two
+#define TILE_CHUNK_CELLS (TILE_CHUNK_SIZE * TILE_CHUNK_SIZE)
+#define TILE_CHUNK_WORDS (TILE_CHUNK_CELLS / 64) // 64 bit words in a one bit per cell mask
+#define TILE_GRID_SPARE_CHUNKS 4096 // chunks emptied by writes kept for reuse, undoing and redoing a 2000x2000 fill never allocates
+#define TILE_GRID_DIRTY_CHUNKS 65536 // keys the dirty list holds before it gives up and asks its reader for a full walk
+
+typedef enum
+{
+	TILE_TYPE_WALL,
+	TILE_TYPE_FLOOR,
+	TILE_TYPE_DOOR,
+	TILE_TYPE_BUFF,
+	TILE_TYPE_INTERACTABLE,
+    TILE_TYPE_N_ITEMS,
+} TileType;
+
+typedef struct
+{
+    unsigned short sheet;  // 1-based slot of the sprite sheet, 0 marks an empty cell
+    unsigned short sprite; // index of the sprite inside its sheet (row major)
+    unsigned char type;    // TileType
+    unsigned char flags;   // reserved for per-cell state
+} TileCell;
+
+typedef struct
+{
+    UT_hash_handle hh;                // for hashing operations, keyed by 'key'
+    long long key;                    // packed chunk coordinate, see tile_chunk_key
+    int cx, cy;                       // chunk coordinate (cell coordinate / TILE_CHUNK_SIZE)
+    unsigned int count;               // number of non-empty cells
+    unsigned int version;             // grid revision of the last write, lets caches know when to rebuild
+    TileCell cells[TILE_CHUNK_CELLS]; // row major, allocated as a whole on first write
+} TileChunk;
+
+typedef struct
+{
+    TileChunk* chunks;     // uthash head
+    size_t cell_count;     // number of non-empty cells across every chunk
+    unsigned int revision; // bumped on every write, never 0 once a chunk has been written
+    TileChunk* last;       // chunk of the last lookup, neighbouring cells mostly share it, so it is checked before hashing
+    TileChunk** spare;     // chunks emptied by writes, handed out again before allocating, allocated
+    size_t spare_count;
+    size_t spare_capacity;
+    long long* dirty;      // keys of chunks written, inserted or removed since tile_grid_clear_dirty, each listed once, allocated
+    size_t dirty_count;
+    size_t dirty_capacity;
+    bool dirty_overflow;   // the list ran out of room, whoever reads it has to look at every chunk instead
+    unsigned int dirty_revision; // revision at the last clear, a chunk with a later version is listed already
+} TileGrid;
+
+typedef void (*tile_chunk_funct)(TileChunk* chunk, void* user);
+typedef void (*tile_cell_funct)(const int x, const int y, const TileCell cell, void* user);
+
+// cell operations
+bool tile_cell_is_empty(const TileCell cell);
+
+// chunk operations
+long long tile_chunk_key(const int cx, const int cy);
+int tile_chunk_coord(const int cell_coord);
+TileCell* tile_chunk_cell(TileChunk* chunk, const int x, const int y);
+
+// grid operations
+TileGrid tile_grid_init();
+void tile_grid_free(TileGrid* grid);
+TileChunk* tile_grid_find_chunk(const TileGrid* grid, const int cx, const int cy);
+TileChunk* tile_grid_get_chunk(TileGrid* grid, const int cx, const int cy);
+bool tile_grid_insert_chunk(TileGrid* grid, TileChunk* chunk);
+void tile_grid_remove_chunk(TileGrid* grid, TileChunk* chunk);
+void tile_grid_touch_chunk(TileGrid* grid, TileChunk* chunk);
+void tile_grid_clear_dirty(TileGrid* grid);
+TileCell tile_grid_get(const TileGrid* grid, const int x, const int y);
+bool tile_grid_set(TileGrid* grid, const int x, const int y, const TileCell cell);
+void tile_grid_erase(TileGrid* grid, const int x, const int y);
+bool tile_grid_write_masked(TileGrid* grid, const int cx, const int cy, const unsigned long long* mask, const TileCell* cells);
+bool tile_grid_fill_masked(TileGrid* grid, const int cx, const int cy, const unsigned long long* mask, const TileCell cell);
+size_t tile_grid_chunk_count(const TileGrid* grid);
+size_t tile_grid_memory_usage(const TileGrid* grid);
+void tile_grid_for_each_chunk(TileGrid* grid, const tile_chunk_funct funct, void* user);
+void tile_grid_query_chunks(TileGrid* grid, const int x0, const int y0, const int x1, const int y1, const tile_chunk_funct funct, void* user);
+void tile_grid_query(TileGrid* grid, const int x0, const int y0, const int x1, const int y1, const tile_cell_funct funct, void* user);
+
+#endif
\ No newline at end of file
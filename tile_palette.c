@@ -0,0 +1,534 @@
+#include "tile_palette.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#define BITS_PER_WORD 64
+
+static bool bit_test(const unsigned long long* bits, const int i)
+{
+    return (bits[i / BITS_PER_WORD] >> (i % BITS_PER_WORD)) & 1ULL;
+}
+
+static void bit_set(unsigned long long* bits, const int i)
+{
+    bits[i / BITS_PER_WORD] |= (1ULL << (i % BITS_PER_WORD));
+}
+
+static int bit_words(const int nbits)
+{
+    return (nbits + BITS_PER_WORD - 1) / BITS_PER_WORD;
+}
+
+int palette_sheet_cell_count(const PaletteSheet* sheet)
+{
+    return (sheet) ? (sheet->columns * sheet->rows) : 0;
+}
+
+int palette_sheet_sprite_count(const PaletteSheet* sheet)
+{
+    return (sheet) ? sheet->sprite_count : 0;
+}
+
+// maps the n-th listed sprite of the sheet to its cell, i.e select(n) over the occupied bits
+int palette_sheet_sprite_cell(const PaletteSheet* sheet, const int sprite)
+{
+    if (!sheet || (sprite < 0) || (sprite >= sheet->sprite_count))
+        return -1;
+
+    // last word whose rank is at or below sprite
+    int lo = 0, hi = bit_words(palette_sheet_cell_count(sheet));
+    while (hi - lo > 1) {
+        const int mid = lo + ((hi - lo) / 2);
+
+        if (sheet->rank[mid] <= (unsigned int)sprite)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    unsigned long long word = sheet->occupied[lo];
+    for (unsigned int skip = sprite - sheet->rank[lo]; skip > 0; skip--)
+        word &= (word - 1);
+
+    return (lo * BITS_PER_WORD) + __builtin_ctzll(word);
+}
+
+// first listed cell after 'cell', -1 past the last one, pass -1 to get the first
+int palette_sheet_next_cell(const PaletteSheet* sheet, const int cell)
+{
+    const int ncells = palette_sheet_cell_count(sheet);
+    const int next = cell + 1;
+
+    if (!sheet || (next < 0) || (next >= ncells))
+        return -1;
+
+    int w = next / BITS_PER_WORD;
+    unsigned long long word = sheet->occupied[w] & (~0ULL << (next % BITS_PER_WORD));
+
+    while (!word) {
+        if (++w >= bit_words(ncells))
+            return -1;
+
+        word = sheet->occupied[w];
+    }
+
+    return (w * BITS_PER_WORD) + __builtin_ctzll(word);
+}
+
+SpriteClass palette_sheet_cell_class(const PaletteSheet* sheet, const int cell)
+{
+    if (!sheet || (cell < 0) || (cell >= palette_sheet_cell_count(sheet)) || !bit_test(sheet->occupied, cell))
+        return SPRITE_CLASS_EMPTY;
+
+    return bit_test(sheet->opaque, cell) ? SPRITE_CLASS_OPAQUE : SPRITE_CLASS_MIXED;
+}
+
+Rectangle palette_sheet_sprite_rect(const PaletteSheet* sheet, const int cell)
+{
+    if (!sheet || (sheet->columns <= 0))
+        return (Rectangle){0};
+
+    return (Rectangle) {
+        .x = (cell % sheet->columns) * sheet->sprite_size,
+        .y = (cell / sheet->columns) * sheet->sprite_size,
+        .width = sheet->sprite_size,
+        .height = sheet->sprite_size,
+    };
+}
+
+Color palette_sheet_cell_color(const PaletteSheet* sheet, const int cell)
+{
+    if (!sheet || !sheet->colors || (cell < 0) || (cell >= palette_sheet_cell_count(sheet)))
+        return BLANK;
+
+    return sheet->colors[cell];
+}
+
+// whether the image splits into the same grid of cells, the only case where every cell keeps its index
+bool palette_sheet_fits(const PaletteSheet* sheet, const Image* image)
+{
+    if (!sheet || !image || (sheet->sprite_size <= 0))
+        return false;
+
+    return (ceilf(image->width / sheet->sprite_size) == sheet->columns) && (ceilf(image->height / sheet->sprite_size) == sheet->rows);
+}
+
+// whether both sheets list the same cells, sprites then keep their palette index and their atlas place
+bool palette_sheet_same_cells(const PaletteSheet* sheet, const PaletteSheet* other)
+{
+    if (!sheet || !other || !sheet->occupied || !other->occupied || (sheet->columns != other->columns) || (sheet->rows != other->rows))
+        return false;
+
+    return memcmp(sheet->occupied, other->occupied, sizeof(unsigned long long) * bit_words(palette_sheet_cell_count(sheet))) == 0;
+}
+
+void palette_sheet_free(PaletteSheet* sheet)
+{
+    if (sheet && sheet->occupied) {
+        free(sheet->occupied); sheet->occupied = NULL;
+    }
+
+    if (sheet && sheet->colors) {
+        free(sheet->colors); sheet->colors = NULL;
+    }
+}
+
+// classifies every cell in a single pass over the rows of a R8G8B8A8 image
+static void palette_sheet_classify(PaletteSheet* sheet, const unsigned char* pixels, const int width, const int height)
+{
+    const int cell_size = sheet->sprite_size;
+
+    // the alpha byte of a pixel read as one 32 bit word, whatever the byte order
+    const unsigned char alpha_bytes[4] = { 0, 0, 0, 0xFF };
+    unsigned int alpha_mask;
+    memcpy(&alpha_mask, alpha_bytes, sizeof(alpha_mask));
+
+    // running OR/AND of every pixel in the current row of cells, one pair per column
+    unsigned int* any = malloc(sizeof(unsigned int) * sheet->columns * 2);
+    if (!any) {
+        fprintf(stderr, "palette_sheet_classify: malloc returned null\n");
+        return;
+    }
+
+    unsigned int* all = any + sheet->columns;
+
+    for (int row = 0; row < sheet->rows; row++) {
+        for (int column = 0; column < sheet->columns; column++) {
+            any[column] = 0;
+            all[column] = UINT_MAX;
+        }
+
+        const int y0 = row * cell_size;
+        const int y1 = (y0 + cell_size < height) ? (y0 + cell_size) : height;
+
+        for (int y = y0; y < y1; y++) {
+            const unsigned int* line = (const unsigned int*)(pixels + ((size_t)y * width * 4));
+
+            for (int column = 0; column < sheet->columns; column++) {
+                const int x0 = column * cell_size;
+                const int x1 = (x0 + cell_size < width) ? (x0 + cell_size) : width;
+
+                // plain reductions over a contiguous span, which the compiler turns into SIMD
+                unsigned int span_any = 0, span_all = UINT_MAX;
+                for (int x = x0; x < x1; x++) {
+                    span_any |= line[x];
+                    span_all &= line[x];
+                }
+
+                any[column] |= span_any;
+                all[column] &= span_all;
+            }
+        }
+
+        for (int column = 0; column < sheet->columns; column++) {
+            const int cell = (row * sheet->columns) + column;
+
+            // cells hanging off the right or bottom edge are partly transparent by definition
+            const bool partial = (((column + 1) * cell_size) > width) || (((row + 1) * cell_size) > height);
+
+            if (any[column] & alpha_mask)
+                bit_set(sheet->occupied, cell);
+
+            if (!partial && ((all[column] & alpha_mask) == alpha_mask))
+                bit_set(sheet->opaque, cell);
+        }
+    }
+
+    free(any); any = NULL;
+}
+
+// averages every cell of a R8G8B8A8 image, color channels weighted by alpha so transparent pixels add nothing
+static void palette_sheet_average(PaletteSheet* sheet, const unsigned char* pixels, const int width, const int height)
+{
+    const int cell_size = sheet->sprite_size;
+
+    for (int row = 0; row < sheet->rows; row++) {
+        const int y0 = row * cell_size;
+        const int y1 = (y0 + cell_size < height) ? (y0 + cell_size) : height;
+
+        for (int column = 0; column < sheet->columns; column++) {
+            const int x0 = column * cell_size;
+            const int x1 = (x0 + cell_size < width) ? (x0 + cell_size) : width;
+
+            unsigned long long r = 0, g = 0, b = 0, a = 0;
+
+            for (int y = y0; y < y1; y++) {
+                const unsigned char* p = pixels + ((((size_t)y * width) + x0) * 4);
+
+                for (int x = x0; x < x1; x++, p += 4) {
+                    r += p[0] * p[3];
+                    g += p[1] * p[3];
+                    b += p[2] * p[3];
+                    a += p[3];
+                }
+            }
+
+            const unsigned long long area = (unsigned long long)(x1 - x0) * (y1 - y0);
+
+            sheet->colors[(row * sheet->columns) + column] = (a == 0) ? BLANK : (Color) {
+                .r = r / a,
+                .g = g / a,
+                .b = b / a,
+                .a = a / area,
+            };
+        }
+    }
+}
+
+// splits a width x height sheet into cells and classifies them from image, every cell is listed without one
+// only touches memory, so sheets can be analyzed off the main thread and handed to the palette afterwards
+bool palette_sheet_init(PaletteSheet* sheet, const int width, const int height, const Image* image, const float sprite_size)
+{
+    if (!sheet || (sprite_size <= 0))
+        return false;
+
+    // a partial sprite at the right or bottom edge still gets its own cell
+    const int columns = ceilf(width / sprite_size);
+    const int rows = ceilf(height / sprite_size);
+
+    // cells address sprites with 16 bits
+    if ((columns <= 0) || (rows <= 0) || (((long)columns * rows) > (USHRT_MAX + 1L)))
+        return false;
+
+    (*sheet) = (PaletteSheet) {
+        .asset_id = 0,
+        .texture = NULL,
+        .columns = columns,
+        .rows = rows,
+        .sprite_size = sprite_size,
+        .first = 0,
+    };
+
+    const int ncells = palette_sheet_cell_count(sheet);
+    const int nwords = bit_words(ncells);
+
+    // both bitmaps and the rank table in one block
+    unsigned long long* block = calloc(1, (sizeof(unsigned long long) * nwords * 2) + (sizeof(unsigned int) * nwords));
+    if (!block) {
+        fprintf(stderr, "palette_sheet_init: calloc returned null\n");
+        return false;
+    }
+
+    sheet->occupied = block;
+    sheet->opaque = block + nwords;
+    sheet->rank = (unsigned int*)(block + (nwords * 2));
+
+    sheet->colors = malloc(sizeof(Color) * ncells);
+    if (!sheet->colors) {
+        fprintf(stderr, "palette_sheet_init: malloc returned null\n");
+        palette_sheet_free(sheet);
+        return false;
+    }
+
+    // what a cell shows when there are no pixels to average
+    for (int i = 0; i < ncells; i++)
+        sheet->colors[i] = GRAY;
+
+    if (!image || !IsImageReady(*image)) {
+        // nothing to look at, list every cell
+        for (int i = 0; i < ncells; i++)
+            bit_set(sheet->occupied, i);
+    }
+
+    else if (image->format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) {
+        palette_sheet_classify(sheet, image->data, image->width, image->height);
+        palette_sheet_average(sheet, image->data, image->width, image->height);
+    }
+
+    else {
+        Image rgba = ImageCopy(*image);
+        ImageFormat(&rgba, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+        if (IsImageReady(rgba) && (rgba.format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8)) {
+            palette_sheet_classify(sheet, rgba.data, rgba.width, rgba.height);
+            palette_sheet_average(sheet, rgba.data, rgba.width, rgba.height);
+        }
+
+        else {
+            for (int i = 0; i < ncells; i++)
+                bit_set(sheet->occupied, i);
+        }
+
+        UnloadImage(rgba);
+    }
+
+    unsigned int total = 0;
+    for (int w = 0; w < nwords; w++) {
+        sheet->rank[w] = total;
+        total += __builtin_popcountll(sheet->occupied[w]);
+    }
+
+    sheet->sprite_count = total;
+
+    return true;
+}
+
+TilePalette tile_palette_init()
+{
+    return (TilePalette) {
+        .sheets = NULL,
+        .sheet_count = 0,
+        .sheet_capacity = 0,
+        .sprite_count = 0,
+    };
+}
+
+void tile_palette_free(TilePalette* palette)
+{
+    if (!palette)
+        return;
+
+    for (size_t i = 0; i < palette->sheet_count; i++)
+        palette_sheet_free(&palette->sheets[i]);
+
+    if (palette->sheets) {
+        free(palette->sheets); palette->sheets = NULL;
+    }
+
+    palette->sheet_count = palette->sheet_capacity = palette->sprite_count = 0;
+}
+
+// recomputes where each sheet starts in the flat palette after a sheet's sprite count changed
+static void tile_palette_relayout(TilePalette* palette)
+{
+    palette->sprite_count = 0;
+
+    for (size_t i = 0; i < palette->sheet_count; i++) {
+        palette->sheets[i].first = palette->sprite_count;
+        palette->sprite_count += palette_sheet_sprite_count(&palette->sheets[i]);
+    }
+}
+
+static PaletteSheet* tile_palette_append(TilePalette* palette)
+{
+    if (palette->sheet_count >= USHRT_MAX)
+        return NULL;
+
+    if (palette->sheet_count == palette->sheet_capacity) {
+        const size_t capacity = (palette->sheet_capacity) ? (palette->sheet_capacity * 2) : 8;
+
+        PaletteSheet* sheets = realloc(palette->sheets, sizeof(PaletteSheet) * capacity);
+        if (!sheets) {
+            fprintf(stderr, "tile_palette_append: realloc returned null\n");
+            return NULL;
+        }
+
+        palette->sheets = sheets;
+        palette->sheet_capacity = capacity;
+    }
+
+    return &palette->sheets[palette->sheet_count++];
+}
+
+// holds a slot for a sheet still being loaded, it lists nothing until tile_palette_adopt_sheet fills it
+unsigned short tile_palette_reserve_sheet(TilePalette* palette, const unsigned long int asset_id, const float sprite_size)
+{
+    if (!palette || (sprite_size <= 0))
+        return 0;
+
+    PaletteSheet* sheet = tile_palette_append(palette);
+    if (!sheet)
+        return 0;
+
+    (*sheet) = (PaletteSheet) {
+        .asset_id = asset_id,
+        .texture = NULL,
+        .sprite_size = sprite_size,
+        .first = palette->sprite_count,
+    };
+
+    return palette->sheet_count;
+}
+
+// takes over an analyzed sheet, into the slot reserved for its asset if there is one, returns the 1-based slot, 0 on failure
+// on success 'sheet' is left empty, the palette owns what it held
+unsigned short tile_palette_adopt_sheet(TilePalette* palette, const unsigned long int asset_id, Texture* texture, PaletteSheet* sheet)
+{
+    if (!palette || !texture || !sheet || !sheet->occupied)
+        return 0;
+
+    PaletteSheet* reserved = tile_palette_find_sheet(palette, asset_id);
+    if (reserved && reserved->texture)
+        return 0;
+
+    PaletteSheet* dest = (reserved) ? reserved : tile_palette_append(palette);
+    if (!dest)
+        return 0;
+
+    (*dest) = (*sheet);
+    dest->asset_id = asset_id;
+    dest->texture = texture;
+
+    (*sheet) = (PaletteSheet){0};
+
+    // a reserved slot may sit before other sheets, whose sprites then move
+    if (reserved)
+        tile_palette_relayout(palette);
+
+    else {
+        dest->first = palette->sprite_count;
+        palette->sprite_count += dest->sprite_count;
+    }
+
+    return (dest - palette->sheets) + 1;
+}
+
+// returns the 1-based slot of the new sheet, 0 on failure, image is the CPU copy of texture used to skip empty cells
+unsigned short tile_palette_add_sheet(TilePalette* palette, const unsigned long int asset_id, Texture* texture, const Image* image, const float sprite_size)
+{
+    if (!palette || !texture)
+        return 0;
+
+    PaletteSheet sheet;
+    if (!palette_sheet_init(&sheet, texture->width, texture->height, image, sprite_size))
+        return 0;
+
+    const unsigned short slot = tile_palette_adopt_sheet(palette, asset_id, texture, &sheet);
+    if (slot == 0)
+        palette_sheet_free(&sheet);
+
+    return slot;
+}
+
+// swaps in the cells of a sheet analyzed again after its file changed on disk, later sheets shift when its sprite count changes
+// on success 'refreshed' is left empty, the palette owns what it held
+bool tile_palette_refresh_sheet(TilePalette* palette, const unsigned short slot, PaletteSheet* refreshed)
+{
+    PaletteSheet* sheet = tile_palette_get_sheet(palette, slot);
+    if (!sheet || !refreshed || !refreshed->occupied || (refreshed->columns != sheet->columns) || (refreshed->rows != sheet->rows))
+        return false;
+
+    PaletteSheet updated = (*refreshed);
+    updated.asset_id = sheet->asset_id;
+    updated.texture = sheet->texture;
+
+    palette_sheet_free(sheet);
+    (*sheet) = updated;
+
+    (*refreshed) = (PaletteSheet){0};
+
+    tile_palette_relayout(palette);
+
+    return true;
+}
+
+PaletteSheet* tile_palette_get_sheet(const TilePalette* palette, const unsigned short slot)
+{
+    if (!palette || (slot == 0) || (slot > palette->sheet_count))
+        return NULL;
+
+    return &palette->sheets[slot - 1];
+}
+
+PaletteSheet* tile_palette_find_sheet(const TilePalette* palette, const unsigned long int asset_id)
+{
+    if (!palette)
+        return NULL;
+
+    for (size_t i = 0; i < palette->sheet_count; i++) {
+        if (palette->sheets[i].asset_id == asset_id)
+            return &palette->sheets[i];
+    }
+
+    return NULL;
+}
+
+// maps a flat palette index to the sheet slot and cell it refers to
+bool tile_palette_locate(const TilePalette* palette, const size_t index, unsigned short* slot, int* cell)
+{
+    if (!palette || !slot || !cell || (index >= palette->sprite_count))
+        return false;
+
+    // sheets are sorted by 'first', the last one starting at or before index holds it (empty sheets share their successor's 'first')
+    size_t lo = 0, hi = palette->sheet_count;
+    while (hi - lo > 1) {
+        const size_t mid = lo + ((hi - lo) / 2);
+
+        if (palette->sheets[mid].first <= index)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    (*slot) = lo + 1;
+    (*cell) = palette_sheet_sprite_cell(&palette->sheets[lo], index - palette->sheets[lo].first);
+
+    return (*cell) >= 0;
+}
+
+// the flat palette index of a sheet's cell, the inverse of tile_palette_locate, -1 when the cell is not listed
+long tile_palette_index(const TilePalette* palette, const unsigned short slot, const int cell)
+{
+    const PaletteSheet* sheet = tile_palette_get_sheet(palette, slot);
+    if (!sheet || (palette_sheet_cell_class(sheet, cell) == SPRITE_CLASS_EMPTY))
+        return -1;
+
+    // listed cells before it: the word's rank plus the set bits below it in the word
+    const unsigned long long below = sheet->occupied[cell / BITS_PER_WORD] & ((1ULL << (cell % BITS_PER_WORD)) - 1);
+
+    return sheet->first + sheet->rank[cell / BITS_PER_WORD] + __builtin_popcountll(below);
+}
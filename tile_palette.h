@@ -0,0 +1,65 @@
+#ifndef TILE_PALETTE_H
+#define TILE_PALETTE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "raylib.h"
+
+typedef enum
+{
+    SPRITE_CLASS_EMPTY,  // every pixel is fully transparent, never shown in the palette
+    SPRITE_CLASS_OPAQUE, // every pixel is fully opaque
+    SPRITE_CLASS_MIXED,  // anything else
+} SpriteClass;
+
+// a sprite sheet split into a grid of sprite_size cells, cell i lives at column (i % columns), row (i / columns)
+typedef struct
+{
+    unsigned long int asset_id;   // id of the AssetEntry the sheet was imported from
+    Texture* texture;             // owned by the AssetEntry
+    int columns;
+    int rows;
+    float sprite_size;
+    size_t first;                 // palette index of the sheet's first sprite
+    int sprite_count;             // non-empty cells, the only ones listed in the palette
+    unsigned long long* occupied; // one bit per cell, set when the cell is not SPRITE_CLASS_EMPTY, allocated
+    unsigned long long* opaque;   // one bit per cell, set when the cell is SPRITE_CLASS_OPAQUE, shares occupied's allocation
+    unsigned int* rank;           // set occupied bits before each 64 cell word, shares occupied's allocation
+    Color* colors;                // average color of each cell weighted by alpha, what the minimap shows, allocated
+} PaletteSheet;
+
+typedef struct
+{
+    PaletteSheet* sheets; // allocated, a sheet's slot is its index plus one
+    size_t sheet_count;
+    size_t sheet_capacity;
+    size_t sprite_count; // sprites across every sheet
+} TilePalette;
+
+// sheet operations
+int palette_sheet_cell_count(const PaletteSheet* sheet);
+int palette_sheet_sprite_count(const PaletteSheet* sheet);
+int palette_sheet_sprite_cell(const PaletteSheet* sheet, const int sprite);
+int palette_sheet_next_cell(const PaletteSheet* sheet, const int cell);
+SpriteClass palette_sheet_cell_class(const PaletteSheet* sheet, const int cell);
+Rectangle palette_sheet_sprite_rect(const PaletteSheet* sheet, const int cell);
+Color palette_sheet_cell_color(const PaletteSheet* sheet, const int cell);
+bool palette_sheet_fits(const PaletteSheet* sheet, const Image* image);
+bool palette_sheet_same_cells(const PaletteSheet* sheet, const PaletteSheet* other);
+bool palette_sheet_init(PaletteSheet* sheet, const int width, const int height, const Image* image, const float sprite_size);
+void palette_sheet_free(PaletteSheet* sheet);
+
+// palette operations
+TilePalette tile_palette_init();
+void tile_palette_free(TilePalette* palette);
+unsigned short tile_palette_reserve_sheet(TilePalette* palette, const unsigned long int asset_id, const float sprite_size);
+unsigned short tile_palette_adopt_sheet(TilePalette* palette, const unsigned long int asset_id, Texture* texture, PaletteSheet* sheet);
+unsigned short tile_palette_add_sheet(TilePalette* palette, const unsigned long int asset_id, Texture* texture, const Image* image, const float sprite_size);
+bool tile_palette_refresh_sheet(TilePalette* palette, const unsigned short slot, PaletteSheet* refreshed);
+PaletteSheet* tile_palette_get_sheet(const TilePalette* palette, const unsigned short slot);
+PaletteSheet* tile_palette_find_sheet(const TilePalette* palette, const unsigned long int asset_id);
+bool tile_palette_locate(const TilePalette* palette, const size_t index, unsigned short* slot, int* cell);
+long tile_palette_index(const TilePalette* palette, const unsigned short slot, const int cell);
+
+#endif
\ No newline at end of file
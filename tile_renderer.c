@@ -0,0 +1,682 @@
+#include "tile_renderer.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "rlgl.h"
+#include "raymath.h"
+
+#define TILE_VERTEX_FLOATS 4 // x, y, u, v
+#define TILE_QUAD_VERTICES 6 // two triangles, no index buffer
+#define TILE_MESH_MAX_FLOATS (TILE_CHUNK_CELLS * TILE_QUAD_VERTICES * TILE_VERTEX_FLOATS)
+
+#define TILE_MESH_EVICT_INTERVAL 60 // frames between eviction sweeps
+#define TILE_MESH_MAX_IDLE 120      // frames a mesh may go undrawn before its buffers are released
+
+#define TILE_TARGET_MIN_CELL_PIXELS 4     // texels per cell side of the coarsest target
+#define TILE_TARGET_MAX_CELL_PIXELS 32    // 1024x1024 targets, zooming in further magnifies them
+#define TILE_TARGET_RENDERS_PER_FRAME 16  // jumping to an unseen area spreads its renders over a few frames
+
+typedef struct
+{
+    unsigned int texture_id;
+    Rectangle uv; // normalized source rectangle
+    int lx, ly;   // cell coordinate inside the chunk
+} TileQuad;
+
+static void tile_chunk_mesh_release(TileRenderer* renderer, TileChunkMesh* mesh)
+{
+    if (!mesh)
+        return;
+
+    if (mesh->vao != 0)
+        rlUnloadVertexArray(mesh->vao);
+
+    if (mesh->vbo != 0)
+        rlUnloadVertexBuffer(mesh->vbo);
+
+    mesh->vao = mesh->vbo = 0;
+    mesh->vertex_count = 0;
+
+    if (mesh->ranges) {
+        if (renderer->hold) {
+            for (int i = 0; i < mesh->range_count; i++)
+                renderer->hold(mesh->ranges[i].texture_id, -1, renderer->user);
+        }
+
+        free(mesh->ranges); mesh->ranges = NULL;
+    }
+
+    mesh->range_count = 0;
+}
+
+static void tile_renderer_remove_mesh(TileRenderer* renderer, TileChunkMesh* mesh)
+{
+    HASH_DEL(renderer->meshes, mesh);
+    tile_chunk_mesh_release(renderer, mesh);
+    free(mesh); mesh = NULL;
+}
+
+static void tile_target_unlink(TileRenderer* renderer, TileChunkTarget* target)
+{
+    if (target->prev)
+        target->prev->next = target->next;
+    else
+        renderer->lru_head = target->next;
+
+    if (target->next)
+        target->next->prev = target->prev;
+    else
+        renderer->lru_tail = target->prev;
+
+    target->prev = target->next = NULL;
+}
+
+static void tile_target_touch(TileRenderer* renderer, TileChunkTarget* target)
+{
+    if (renderer->lru_head == target)
+        return;
+
+    if (target->prev || target->next || (renderer->lru_tail == target))
+        tile_target_unlink(renderer, target);
+
+    target->next = renderer->lru_head;
+
+    if (renderer->lru_head)
+        renderer->lru_head->prev = target;
+
+    renderer->lru_head = target;
+
+    if (!renderer->lru_tail)
+        renderer->lru_tail = target;
+}
+
+// color and depth attachment, LoadRenderTexture gives every target both
+static size_t tile_target_bytes(const int cell_pixels)
+{
+    const size_t side = (size_t)TILE_CHUNK_SIZE * cell_pixels;
+
+    return side * side * 8;
+}
+
+static void tile_renderer_remove_target(TileRenderer* renderer, TileChunkTarget* target)
+{
+    tile_target_unlink(renderer, target);
+    HASH_DEL(renderer->targets, target);
+
+    if (target->target.id != 0) {
+        UnloadRenderTexture(target->target);
+        renderer->target_bytes -= tile_target_bytes(target->cell_pixels);
+    }
+
+    free(target); target = NULL;
+}
+
+// evicts least recently drawn targets until 'bytes' more fit, a target drawn this frame is never taken
+static bool tile_renderer_make_room(TileRenderer* renderer, const size_t bytes)
+{
+    while ((renderer->target_bytes + bytes) > renderer->target_budget) {
+        TileChunkTarget* oldest = renderer->lru_tail;
+
+        if (!oldest || (oldest->last_frame == renderer->frame))
+            return false;
+
+        tile_renderer_remove_target(renderer, oldest);
+    }
+
+    return true;
+}
+
+TileRenderer tile_renderer_init(const tile_sprite_funct resolve, void* user)
+{
+    return (TileRenderer) {
+        .meshes = NULL,
+        .scratch = NULL,
+        .frame = 0,
+        .resolve = resolve,
+        .hold = NULL,
+        .user = user,
+        .cached = false,
+        .targets = NULL,
+        .lru_head = NULL,
+        .lru_tail = NULL,
+        .target_bytes = 0,
+        .target_budget = 0,
+        .visible_chunks = 0,
+        .rebuilt_chunks = 0,
+        .draw_calls = 0,
+        .texture_switches = 0,
+        .cache_hits = 0,
+        .cache_renders = 0,
+        .cache_fallbacks = 0,
+    };
+}
+
+void tile_renderer_free(TileRenderer* renderer)
+{
+    if (!renderer)
+        return;
+
+    TileChunkMesh* current, *tmp;
+
+    HASH_ITER(hh, renderer->meshes, current, tmp)
+        tile_renderer_remove_mesh(renderer, current);
+
+    TileChunkTarget* target, *next;
+
+    HASH_ITER(hh, renderer->targets, target, next)
+        tile_renderer_remove_target(renderer, target);
+
+    if (renderer->scratch) {
+        free(renderer->scratch); renderer->scratch = NULL;
+    }
+}
+
+void tile_renderer_invalidate(TileRenderer* renderer)
+{
+    if (!renderer)
+        return;
+
+    TileChunkMesh* current, *tmp;
+
+    // the version no chunk will ever carry, forcing a rebuild on the next draw
+    HASH_ITER(hh, renderer->meshes, current, tmp)
+        current->version = 0;
+
+    TileChunkTarget* target, *next;
+
+    HASH_ITER(hh, renderer->targets, target, next)
+        target->version = 0;
+}
+
+// 'hold' hears about every texture a mesh starts or stops binding, the renderer's user is passed along
+void tile_renderer_set_hold(TileRenderer* renderer, const tile_texture_funct hold)
+{
+    if (!renderer)
+        return;
+
+    renderer->hold = hold;
+}
+
+// turning the cache off releases every target, a smaller budget evicts down to it
+void tile_renderer_set_cache(TileRenderer* renderer, const bool enabled, const size_t budget)
+{
+    if (!renderer)
+        return;
+
+    renderer->cached = enabled;
+    renderer->target_budget = (enabled) ? budget : 0;
+
+    while (renderer->lru_tail && (renderer->target_bytes > renderer->target_budget))
+        tile_renderer_remove_target(renderer, renderer->lru_tail);
+}
+
+static float* tile_emit_quad(float* v, const float x, const float y, const Rectangle uv)
+{
+    const float x1 = x + 1, y1 = y + 1;
+    const float u0 = uv.x, v0 = uv.y;
+    const float u1 = uv.x + uv.width, v1 = uv.y + uv.height;
+
+    const float quad[TILE_QUAD_VERTICES * TILE_VERTEX_FLOATS] = {
+        x,  y,  u0, v0,
+        x,  y1, u0, v1,
+        x1, y1, u1, v1,
+        x,  y,  u0, v0,
+        x1, y1, u1, v1,
+        x1, y,  u1, v0,
+    };
+
+    for (int i = 0; i < TILE_QUAD_VERTICES * TILE_VERTEX_FLOATS; i++)
+        v[i] = quad[i];
+
+    return v + (TILE_QUAD_VERTICES * TILE_VERTEX_FLOATS);
+}
+
+static bool tile_chunk_mesh_build(TileRenderer* renderer, TileChunkMesh* mesh, TileChunk* chunk)
+{
+    static TileQuad quads[TILE_CHUNK_CELLS];
+
+    tile_chunk_mesh_release(renderer, mesh);
+
+    if (!renderer->scratch) {
+        renderer->scratch = malloc(sizeof(float) * TILE_MESH_MAX_FLOATS);
+        if (!renderer->scratch) {
+            fprintf(stderr, "tile_chunk_mesh_build: malloc returned null\n");
+            return false;
+        }
+    }
+
+    // resolve every occupied cell once, remembering the distinct textures in order of appearance
+    int nquads = 0;
+    unsigned int textures[TILE_CHUNK_CELLS];
+    int ntextures = 0;
+
+    for (int i = 0; i < TILE_CHUNK_CELLS; i++) {
+        const TileCell cell = chunk->cells[i];
+        if (tile_cell_is_empty(cell))
+            continue;
+
+        Texture texture = {0};
+        Rectangle source = {0};
+        if (!renderer->resolve || !renderer->resolve(cell, &texture, &source, renderer->user) || (texture.id == 0))
+            continue;
+
+        quads[nquads++] = (TileQuad) {
+            .texture_id = texture.id,
+            .uv = {
+                .x = source.x / texture.width,
+                .y = source.y / texture.height,
+                .width = source.width / texture.width,
+                .height = source.height / texture.height,
+            },
+            .lx = i % TILE_CHUNK_SIZE,
+            .ly = i / TILE_CHUNK_SIZE,
+        };
+
+        bool seen = false;
+        for (int t = 0; (t < ntextures) && !seen; t++)
+            seen = (textures[t] == texture.id);
+
+        if (!seen)
+            textures[ntextures++] = texture.id;
+    }
+
+    mesh->version = chunk->version;
+
+    if (nquads == 0)
+        return true;
+
+    mesh->ranges = malloc(sizeof(TileMeshRange) * ntextures);
+    if (!mesh->ranges) {
+        fprintf(stderr, "tile_chunk_mesh_build: malloc returned null\n");
+        return false;
+    }
+
+    // group the quads by texture so each texture is bound once per chunk
+    float* v = renderer->scratch;
+    for (int t = 0; t < ntextures; t++) {
+        const int first = (v - renderer->scratch) / TILE_VERTEX_FLOATS;
+
+        for (int q = 0; q < nquads; q++) {
+            if (quads[q].texture_id == textures[t])
+                v = tile_emit_quad(v, quads[q].lx, quads[q].ly, quads[q].uv);
+        }
+
+        mesh->ranges[t] = (TileMeshRange) {
+            .texture_id = textures[t],
+            .first = first,
+            .count = ((v - renderer->scratch) / TILE_VERTEX_FLOATS) - first,
+        };
+
+        // the mesh binds the texture every frame without resolving it again
+        if (renderer->hold)
+            renderer->hold(textures[t], 1, renderer->user);
+    }
+
+    mesh->range_count = ntextures;
+    mesh->vertex_count = nquads * TILE_QUAD_VERTICES;
+
+    const int stride = sizeof(float) * TILE_VERTEX_FLOATS;
+    const int* locs = rlGetShaderLocsDefault();
+
+    mesh->vao = rlLoadVertexArray();
+    rlEnableVertexArray(mesh->vao);
+
+        mesh->vbo = rlLoadVertexBuffer(renderer->scratch, mesh->vertex_count * stride, false);
+
+        rlSetVertexAttribute(locs[RL_SHADER_LOC_VERTEX_POSITION], 2, RL_FLOAT, false, stride, 0);
+        rlEnableVertexAttribute(locs[RL_SHADER_LOC_VERTEX_POSITION]);
+
+        rlSetVertexAttribute(locs[RL_SHADER_LOC_VERTEX_TEXCOORD01], 2, RL_FLOAT, false, stride, (void*)(2 * sizeof(float)));
+        rlEnableVertexAttribute(locs[RL_SHADER_LOC_VERTEX_TEXCOORD01]);
+
+    rlDisableVertexArray();
+    rlDisableVertexBuffer();
+
+    return true;
+}
+
+// the chunk's mesh, rebuilt first when the chunk changed since it was last built
+static TileChunkMesh* tile_renderer_mesh(TileRenderer* renderer, TileChunk* chunk)
+{
+    TileChunkMesh* mesh = NULL;
+    HASH_FIND(hh, renderer->meshes, &chunk->key, sizeof(chunk->key), mesh);
+
+    if (!mesh) {
+        mesh = calloc(1, sizeof(TileChunkMesh));
+        if (!mesh) {
+            fprintf(stderr, "tile_renderer_mesh: calloc returned null\n");
+            return NULL;
+        }
+
+        mesh->key = chunk->key;
+        HASH_ADD(hh, renderer->meshes, key, sizeof(mesh->key), mesh);
+    }
+
+    // vertex data only changes when the chunk does
+    if ((mesh->version != chunk->version) || (mesh->version == 0)) {
+        if (!tile_chunk_mesh_build(renderer, mesh, chunk))
+            return NULL;
+
+        renderer->rebuilt_chunks++;
+    }
+
+    mesh->last_frame = renderer->frame;
+
+    return mesh;
+}
+
+// state every mesh draw relies on, the default shader with a white tint sampling slot 0
+static void tile_renderer_begin_meshes()
+{
+    // everything queued through the default batch has to land before the chunk meshes
+    rlDrawRenderBatchActive();
+
+    const int* locs = rlGetShaderLocsDefault();
+    const float white[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    const int texture_slot = 0;
+
+    rlEnableShader(rlGetShaderIdDefault());
+    rlSetUniform(locs[RL_SHADER_LOC_COLOR_DIFFUSE], white, RL_SHADER_UNIFORM_VEC4, 1);
+    rlSetUniform(locs[RL_SHADER_LOC_MAP_DIFFUSE], &texture_slot, RL_SHADER_UNIFORM_SAMPLER2D, 1);
+    rlSetVertexAttributeDefault(locs[RL_SHADER_LOC_VERTEX_COLOR], white, RL_SHADER_ATTRIB_VEC4, 4);
+    rlActiveTextureSlot(texture_slot);
+}
+
+static void tile_renderer_end_meshes()
+{
+    rlDisableVertexArray();
+    rlDisableVertexBuffer();
+    rlDisableTexture();
+    rlDisableShader();
+}
+
+static void tile_renderer_draw_mesh(TileRenderer* renderer, const TileChunkMesh* mesh, const Matrix mvp, unsigned int* bound_texture)
+{
+    if (mesh->vertex_count == 0)
+        return;
+
+    const int* locs = rlGetShaderLocsDefault();
+    rlSetUniformMatrix(locs[RL_SHADER_LOC_MATRIX_MVP], mvp);
+
+    if (!rlEnableVertexArray(mesh->vao)) {
+        const int stride = sizeof(float) * TILE_VERTEX_FLOATS;
+
+        rlEnableVertexBuffer(mesh->vbo);
+        rlSetVertexAttribute(locs[RL_SHADER_LOC_VERTEX_POSITION], 2, RL_FLOAT, false, stride, 0);
+        rlEnableVertexAttribute(locs[RL_SHADER_LOC_VERTEX_POSITION]);
+        rlSetVertexAttribute(locs[RL_SHADER_LOC_VERTEX_TEXCOORD01], 2, RL_FLOAT, false, stride, (void*)(2 * sizeof(float)));
+        rlEnableVertexAttribute(locs[RL_SHADER_LOC_VERTEX_TEXCOORD01]);
+        rlDisableVertexAttribute(locs[RL_SHADER_LOC_VERTEX_COLOR]);
+    }
+
+    for (int i = 0; i < mesh->range_count; i++) {
+        if (mesh->ranges[i].texture_id != (*bound_texture)) {
+            (*bound_texture) = mesh->ranges[i].texture_id;
+            renderer->texture_switches++;
+        }
+
+        rlEnableTexture(mesh->ranges[i].texture_id);
+        rlDrawVertexArray(mesh->ranges[i].first, mesh->ranges[i].count);
+        renderer->draw_calls++;
+    }
+}
+
+// a target the chunk can be blitted from this frame, tile_renderer_update touched it and it holds the chunk's current cells
+static TileChunkTarget* tile_renderer_ready_target(const TileRenderer* renderer, const TileChunk* chunk)
+{
+    if (!renderer->cached)
+        return NULL;
+
+    TileChunkTarget* target = NULL;
+    HASH_FIND(hh, renderer->targets, &chunk->key, sizeof(chunk->key), target);
+
+    if (!target || (target->version != chunk->version) || (target->last_frame != renderer->frame))
+        return NULL;
+
+    return target;
+}
+
+typedef struct
+{
+    TileRenderer* renderer;
+    int cell_pixels;   // texels per cell side the current zoom wants
+} TileTargetContext;
+
+static bool tile_renderer_render_target(TileRenderer* renderer, TileChunkTarget* target, const TileChunkMesh* mesh, const int cell_pixels)
+{
+    if (target->cell_pixels != cell_pixels) {
+        if (target->target.id != 0) {
+            UnloadRenderTexture(target->target);
+            renderer->target_bytes -= tile_target_bytes(target->cell_pixels);
+        }
+
+        target->target = LoadRenderTexture(TILE_CHUNK_SIZE * cell_pixels, TILE_CHUNK_SIZE * cell_pixels);
+        target->cell_pixels = 0;
+
+        if (target->target.id == 0) {
+            fprintf(stderr, "tile_renderer_render_target: LoadRenderTexture failed\n");
+            return false;
+        }
+
+        target->cell_pixels = cell_pixels;
+        renderer->target_bytes += tile_target_bytes(cell_pixels);
+    }
+
+    BeginTextureMode(target->target);
+
+        ClearBackground(BLANK);
+
+        tile_renderer_begin_meshes();
+
+        // same cell unit vertices as on screen, scaled to the target's texels
+        const Matrix model = MatrixScale(cell_pixels, cell_pixels, 1.0f);
+        const Matrix mvp = MatrixMultiply(MatrixMultiply(model, rlGetMatrixModelview()), rlGetMatrixProjection());
+        unsigned int bound_texture = 0;
+
+        tile_renderer_draw_mesh(renderer, mesh, mvp, &bound_texture);
+
+        tile_renderer_end_meshes();
+
+    EndTextureMode();
+
+    return true;
+}
+
+// every visible target is marked before any is rendered, so making room never evicts one the view still needs
+static void tile_renderer_mark_chunk(TileChunk* chunk, void* user)
+{
+    TileRenderer* renderer = ((TileTargetContext*) user)->renderer;
+
+    TileChunkTarget* target = NULL;
+    HASH_FIND(hh, renderer->targets, &chunk->key, sizeof(chunk->key), target);
+
+    if (target) {
+        target->last_frame = renderer->frame;
+        tile_target_touch(renderer, target);
+    }
+}
+
+static void tile_renderer_update_chunk(TileChunk* chunk, void* user)
+{
+    TileTargetContext* ctx = (TileTargetContext*) user;
+    TileRenderer* renderer = ctx->renderer;
+
+    TileChunkTarget* target = NULL;
+    HASH_FIND(hh, renderer->targets, &chunk->key, sizeof(chunk->key), target);
+
+    // a finer target than the zoom needs is kept, a coarser one is rendered again
+    if (target && (target->version == chunk->version) && (target->cell_pixels >= ctx->cell_pixels)) {
+        renderer->cache_hits++;
+        return;
+    }
+
+    // drawn from its mesh this frame, the target catches up on a later one
+    if (renderer->cache_renders >= TILE_TARGET_RENDERS_PER_FRAME)
+        return;
+
+    TileChunkMesh* mesh = tile_renderer_mesh(renderer, chunk);
+    if (!mesh || (mesh->vertex_count == 0))
+        return;
+
+    const size_t held = (target && (target->target.id != 0)) ? tile_target_bytes(target->cell_pixels) : 0;
+    const size_t wanted = tile_target_bytes(ctx->cell_pixels);
+
+    if ((wanted > held) && !tile_renderer_make_room(renderer, wanted - held))
+        return;
+
+    if (!target) {
+        target = calloc(1, sizeof(TileChunkTarget));
+        if (!target) {
+            fprintf(stderr, "tile_renderer_update_chunk: calloc returned null\n");
+            return;
+        }
+
+        target->key = chunk->key;
+        HASH_ADD(hh, renderer->targets, key, sizeof(target->key), target);
+    }
+
+    tile_target_touch(renderer, target);
+
+    if (!tile_renderer_render_target(renderer, target, mesh, ctx->cell_pixels)) {
+        tile_renderer_remove_target(renderer, target);
+        return;
+    }
+
+    target->version = chunk->version;
+    target->last_frame = renderer->frame;
+    renderer->cache_renders++;
+}
+
+typedef struct
+{
+    TileRenderer* renderer;
+    float tile_size;
+    Matrix view_projection;
+    unsigned int bound_texture;
+} TileDrawContext;
+
+static void tile_renderer_blit_chunk(TileChunk* chunk, void* user)
+{
+    TileDrawContext* ctx = (TileDrawContext*) user;
+
+    const TileChunkTarget* target = tile_renderer_ready_target(ctx->renderer, chunk);
+    if (!target)
+        return;
+
+    const float chunk_extent = TILE_CHUNK_SIZE * ctx->tile_size;
+    const float side = target->target.texture.width;
+
+    // render textures come out upside down
+    const Rectangle source = { 0.0f, 0.0f, side, -side };
+    const Rectangle dest = { chunk->cx * chunk_extent, chunk->cy * chunk_extent, chunk_extent, chunk_extent };
+
+    DrawTexturePro(target->target.texture, source, dest, (Vector2){0,0}, 0.0f, WHITE);
+
+    ctx->renderer->visible_chunks++;
+    ctx->renderer->draw_calls++;
+    ctx->renderer->texture_switches++;
+}
+
+static void tile_renderer_draw_chunk(TileChunk* chunk, void* user)
+{
+    TileDrawContext* ctx = (TileDrawContext*) user;
+    TileRenderer* renderer = ctx->renderer;
+
+    if (tile_renderer_ready_target(renderer, chunk))
+        return;
+
+    TileChunkMesh* mesh = tile_renderer_mesh(renderer, chunk);
+    if (!mesh)
+        return;
+
+    renderer->visible_chunks++;
+
+    if (renderer->cached && (mesh->vertex_count > 0))
+        renderer->cache_fallbacks++;
+
+    // vertices are in cell units relative to the chunk, so a tile_size change never invalidates them
+    const float chunk_extent = TILE_CHUNK_SIZE * ctx->tile_size;
+    const Matrix model = MatrixMultiply(MatrixScale(ctx->tile_size, ctx->tile_size, 1.0f), MatrixTranslate(chunk->cx * chunk_extent, chunk->cy * chunk_extent, 0.0f));
+
+    tile_renderer_draw_mesh(renderer, mesh, MatrixMultiply(model, ctx->view_projection), &ctx->bound_texture);
+}
+
+static void tile_renderer_evict(TileRenderer* renderer)
+{
+    TileChunkMesh* current, *tmp;
+
+    HASH_ITER(hh, renderer->meshes, current, tmp) {
+        if ((renderer->frame - current->last_frame) > TILE_MESH_MAX_IDLE)
+            tile_renderer_remove_mesh(renderer, current);
+    }
+}
+
+// cells of the view, the chunks overlapping them are the only ones touched
+static void tile_renderer_view(const Rectangle world_bounds, const float tile_size, int* x0, int* y0, int* x1, int* y1)
+{
+    (*x0) = floorf(world_bounds.x / tile_size);
+    (*y0) = floorf(world_bounds.y / tile_size);
+    (*x1) = floorf((world_bounds.x + world_bounds.width) / tile_size);
+    (*y1) = floorf((world_bounds.y + world_bounds.height) / tile_size);
+}
+
+// call once per frame before tile_renderer_draw and outside of any scissor or camera mode, render textures need the plain screen state
+void tile_renderer_update(TileRenderer* renderer, TileGrid* grid, const Rectangle world_bounds, const float tile_size, const float zoom)
+{
+    if (!renderer)
+        return;
+
+    renderer->frame++;
+    renderer->visible_chunks = renderer->rebuilt_chunks = renderer->draw_calls = renderer->texture_switches = 0;
+    renderer->cache_hits = renderer->cache_renders = renderer->cache_fallbacks = 0;
+
+    if (!renderer->cached || !grid || (tile_size <= 0))
+        return;
+
+    // the smallest power of two at or above the on screen size of a cell
+    int cell_pixels = TILE_TARGET_MIN_CELL_PIXELS;
+    while ((cell_pixels < TILE_TARGET_MAX_CELL_PIXELS) && (cell_pixels < (tile_size * zoom)))
+        cell_pixels *= 2;
+
+    TileTargetContext ctx = {
+        .renderer = renderer,
+        .cell_pixels = cell_pixels,
+    };
+
+    int x0, y0, x1, y1;
+    tile_renderer_view(world_bounds, tile_size, &x0, &y0, &x1, &y1);
+
+    tile_grid_query_chunks(grid, x0, y0, x1, y1, tile_renderer_mark_chunk, &ctx);
+    tile_grid_query_chunks(grid, x0, y0, x1, y1, tile_renderer_update_chunk, &ctx);
+}
+
+void tile_renderer_draw(TileRenderer* renderer, TileGrid* grid, const Rectangle world_bounds, const float tile_size)
+{
+    if (!renderer || !grid || (tile_size <= 0))
+        return;
+
+    TileDrawContext ctx = {
+        .renderer = renderer,
+        .tile_size = tile_size,
+        .view_projection = MatrixMultiply(MatrixMultiply(rlGetMatrixTransform(), rlGetMatrixModelview()), rlGetMatrixProjection()),
+        .bound_texture = 0,
+    };
+
+    int x0, y0, x1, y1;
+    tile_renderer_view(world_bounds, tile_size, &x0, &y0, &x1, &y1);
+
+    // cached chunks go through the default batch as one quad each, the rest are drawn from their meshes after
+    if (renderer->cached)
+        tile_grid_query_chunks(grid, x0, y0, x1, y1, tile_renderer_blit_chunk, &ctx);
+
+    tile_renderer_begin_meshes();
+
+    tile_grid_query_chunks(grid, x0, y0, x1, y1, tile_renderer_draw_chunk, &ctx);
+
+    tile_renderer_end_meshes();
+
+    if ((renderer->frame % TILE_MESH_EVICT_INTERVAL) == 0)
+        tile_renderer_evict(renderer);
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#ifndef TILE_RENDERER_H
+#define TILE_RENDERER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "raylib.h"
+#include "uthash.h"
+#include "tile_grid.h"
+
+// resolves a cell into the texture and source rectangle it should be drawn with, returns false to skip the cell
+typedef bool (*tile_sprite_funct)(const TileCell cell, Texture* texture, Rectangle* source, void* user);
+
+// a mesh took (+1) or dropped (-1) a texture it draws with, the texture has to stay uploaded while held
+typedef void (*tile_texture_funct)(const unsigned int texture_id, const int delta, void* user);
+
+typedef struct
+{
+    unsigned int texture_id; // texture bound for this range
+    int first;               // first vertex of the range
+    int count;               // number of vertices in the range
+} TileMeshRange;
+
+typedef struct
+{
+    UT_hash_handle hh;     // for hashing operations, keyed by 'key'
+    long long key;         // same packed coordinate as the TileChunk this mesh was built from
+    unsigned int version;  // TileChunk version the vertex data was built from
+    unsigned int vao;      // vertex array object, 0 when unsupported
+    unsigned int vbo;      // interleaved position/texcoord quads, in cell units relative to the chunk origin
+    int vertex_count;
+    TileMeshRange* ranges; // one range per distinct texture, allocated
+    int range_count;
+    unsigned long int last_frame; // last frame the mesh was drawn, used for eviction
+} TileChunkMesh;
+
+// a chunk drawn once into its own texture, blitted as a single quad until the chunk changes
+typedef struct TileChunkTarget
+{
+    UT_hash_handle hh;             // for hashing operations, keyed by 'key'
+    long long key;                 // packed coordinate of the chunk
+    unsigned int version;          // TileChunk version the texture was rendered from, 0 when it has to be rendered again
+    int cell_pixels;               // texels per cell side the texture was rendered at
+    RenderTexture2D target;
+    unsigned long int last_frame;  // last frame the target was drawn, a target drawn this frame is never evicted
+    struct TileChunkTarget* prev;  // LRU links, most recently drawn first
+    struct TileChunkTarget* next;
+} TileChunkTarget;
+
+typedef struct
+{
+    TileChunkMesh* meshes; // uthash head
+    float* scratch;        // vertex staging buffer reused for every rebuild, allocated
+    unsigned long int frame;
+    tile_sprite_funct resolve;
+    tile_texture_funct hold; // optional
+    void* user;
+
+    // chunk texture cache, off unless enabled through tile_renderer_set_cache
+    bool cached;
+    TileChunkTarget* targets;     // uthash head
+    TileChunkTarget* lru_head;    // most recently drawn
+    TileChunkTarget* lru_tail;    // next to be evicted
+    size_t target_bytes;          // VRAM held by every target, color plus depth
+    size_t target_budget;
+
+    // per frame stats
+    size_t visible_chunks;
+    size_t rebuilt_chunks;
+    size_t draw_calls;
+    size_t texture_switches; // draw calls that bound a different texture than the one before
+    size_t cache_hits;       // visible chunks blitted from an up to date target
+    size_t cache_renders;    // targets rendered this frame, because they were missing, stale or too coarse
+    size_t cache_fallbacks;  // chunks drawn from their mesh since the budget or the per frame render cap ran out
+} TileRenderer;
+
+TileRenderer tile_renderer_init(const tile_sprite_funct resolve, void* user);
+void tile_renderer_free(TileRenderer* renderer);
+void tile_renderer_invalidate(TileRenderer* renderer);
+void tile_renderer_set_hold(TileRenderer* renderer, const tile_texture_funct hold);
+void tile_renderer_set_cache(TileRenderer* renderer, const bool enabled, const size_t budget);
+void tile_renderer_update(TileRenderer* renderer, TileGrid* grid, const Rectangle world_bounds, const float tile_size, const float zoom);
+void tile_renderer_draw(TileRenderer* renderer, TileGrid* grid, const Rectangle world_bounds, const float tile_size);
+
+#endif
\ No newline at end of file
@@ -1,10 +1,20 @@
 #include "utils.h"
 
 #include <ctype.h>
+#include <errno.h>
 #include <unistd.h>
 #include <string.h>
 #include <stdlib.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <arpa/inet.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 int bound_index_to_array (const int pos, const int array_size)
 {
@@ -56,9 +66,9 @@ char* get_file_content(const char* filepath)
 
     char* buffer = malloc(sizeof(char) * (len + 1));
     if (!buffer) {
-        fprintf(stderr, "get_file_length: malloc returned null\n");
+        fprintf(stderr, "get_file_content: malloc returned null\n");
         fclose(fp); fp = NULL;
-        exit(EXIT_FAILURE);
+        return NULL;
     }
 
     const unsigned long read = fread(buffer, sizeof(char), len, fp);
@@ -70,22 +80,296 @@ char* get_file_content(const char* filepath)
     return buffer;
 }
 
+// maps the whole file read only, the mapping outlives the descriptor and stays valid after the file is renamed over
+bool mapped_file_open(MappedFile* file, const char* path, const FileAccess access)
+{
+    if (!file || !valid_string(path))
+        return false;
+
+    file->data = NULL;
+    file->size = 0;
+
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "mapped_file_open: could not open \"%s\"\n", path);
+        return false;
+    }
+
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || !S_ISREG(st.st_mode) || ((unsigned long long)st.st_size > SIZE_MAX)) {
+        fprintf(stderr, "mapped_file_open: \"%s\" is not a regular file\n", path);
+        close(fd);
+        return false;
+    }
+
+    // mmap refuses a zero length, an empty file is an empty view
+    if (st.st_size == 0) {
+        close(fd);
+        return true;
+    }
+
+    void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "mapped_file_open: mmap of \"%s\" failed\n", path);
+        return false;
+    }
+
+    file->data = data;
+    file->size = st.st_size;
+
+    mapped_file_advise(file, 0, file->size, access);
+
+    return true;
+}
+
+void mapped_file_close(MappedFile* file)
+{
+    if (!file)
+        return;
+
+    if (file->data)
+        munmap((void*) file->data, file->size);
+
+    file->data = NULL;
+    file->size = 0;
+}
+
+// hints how a range will be read, the range is widened to whole pages
+bool mapped_file_advise(const MappedFile* file, const size_t offset, const size_t length, const FileAccess access)
+{
+    if (!file || !file->data || (offset >= file->size) || ((unsigned int) access > FILE_ACCESS_WILLNEED))
+        return false;
+
+    static const int advice[] = {
+        [FILE_ACCESS_NORMAL] = MADV_NORMAL,
+        [FILE_ACCESS_SEQUENTIAL] = MADV_SEQUENTIAL,
+        [FILE_ACCESS_RANDOM] = MADV_RANDOM,
+        [FILE_ACCESS_WILLNEED] = MADV_WILLNEED,
+    };
+
+    const size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    const size_t start = offset - (offset % page);
+    const size_t end = (length > (file->size - offset)) ? file->size : (offset + length);
+
+    if (madvise((void*)(file->data + start), end - start, advice[access]) != 0) {
+        fprintf(stderr, "mapped_file_advise: madvise failed\n");
+        return false;
+    }
+
+    return true;
+}
+
+static void file_writer_release(FileWriter* writer)
+{
+    if (writer->fd >= 0) {
+        close(writer->fd); writer->fd = -1;
+    }
+
+    if (writer->path) {
+        free(writer->path); writer->path = NULL;
+    }
+
+    if (writer->temp_path) {
+        free(writer->temp_path); writer->temp_path = NULL;
+    }
+
+    if (writer->buffer) {
+        free(writer->buffer); writer->buffer = NULL;
+    }
+
+    writer->used = 0;
+}
+
+// the temporary lives in the destination's directory, rename only replaces files atomically within one file system
+bool file_writer_open(FileWriter* writer, const char* path)
+{
+    if (!writer || !valid_string(path))
+        return false;
+
+    memset(writer, 0, sizeof(FileWriter));
+    writer->fd = -1;
+
+    const size_t temp_size = strlen(path) + 32;
+
+    writer->path = strdup(path);
+    writer->temp_path = malloc(temp_size);
+    writer->buffer = malloc(FILE_WRITER_BUFFER_SIZE);
+
+    if (!writer->path || !writer->temp_path || !writer->buffer) {
+        fprintf(stderr, "file_writer_open: malloc returned null\n");
+        file_writer_release(writer);
+        return false;
+    }
+
+    // every writer gets its own temporary, two saves of one path must not write into the same file
+    static atomic_uint serial = 0;
+
+    for (int attempt = 0; (writer->fd < 0) && (attempt < 16); attempt++) {
+        snprintf(writer->temp_path, temp_size, "%s.%ld.%u.tmp", path, (long)getpid(), atomic_fetch_add(&serial, 1));
+        writer->fd = open(writer->temp_path, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+
+        if ((writer->fd < 0) && (errno != EEXIST))
+            break;
+    }
+
+    if (writer->fd < 0) {
+        fprintf(stderr, "file_writer_open: could not create \"%s\"\n", writer->temp_path);
+        file_writer_release(writer);
+        return false;
+    }
+
+    return true;
+}
+
+// retries until every byte is written, writev may stop part way through
+static bool file_writer_flush_parts(FileWriter* writer, struct iovec* parts, int count)
+{
+    while (count > 0) {
+        const ssize_t written = writev(writer->fd, parts, count);
+
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+
+            fprintf(stderr, "file_writer: could not write \"%s\"\n", writer->temp_path);
+            writer->failed = true;
+            return false;
+        }
+
+        size_t left = written;
+
+        while ((count > 0) && (left >= parts->iov_len)) {
+            left -= parts->iov_len;
+            parts++;
+            count--;
+        }
+
+        if (count > 0) {
+            parts->iov_base = (char*)parts->iov_base + left;
+            parts->iov_len -= left;
+        }
+    }
+
+    return true;
+}
+
+// small parts are copied into the buffer, a part that does not fit goes out together with what is buffered in one writev
+bool file_writer_writev(FileWriter* writer, const struct iovec* parts, const int count)
+{
+    if (!writer || (writer->fd < 0) || writer->failed || (!parts && (count > 0)))
+        return false;
+
+    for (int i = 0; i < count; i++) {
+        const size_t size = parts[i].iov_len;
+
+        if (size <= (FILE_WRITER_BUFFER_SIZE - writer->used)) {
+            memcpy(writer->buffer + writer->used, parts[i].iov_base, size);
+            writer->used += size;
+        } else {
+            struct iovec pending[2] = {
+                { .iov_base = writer->buffer, .iov_len = writer->used },
+                parts[i],
+            };
+
+            const bool buffered = writer->used > 0;
+
+            if (!file_writer_flush_parts(writer, buffered ? pending : pending + 1, buffered ? 2 : 1))
+                return false;
+
+            writer->used = 0;
+        }
+
+        writer->written += size;
+    }
+
+    return true;
+}
+
+bool file_writer_write(FileWriter* writer, const void* data, const size_t size)
+{
+    const struct iovec part = { .iov_base = (void*)data, .iov_len = size };
+
+    return file_writer_writev(writer, &part, 1);
+}
+
+// the rename is only durable once the directory entry is, a crash before that may still show the old file
+static void file_writer_sync_directory(const char* path)
+{
+    const char* slash = strrchr(path, '/');
+    char* directory = slash ? strndup(path, (slash == path) ? 1 : (size_t)(slash - path)) : strdup(".");
+    if (!directory)
+        return;
+
+    const int fd = open(directory, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+
+    free(directory); directory = NULL;
+}
+
+// flushes, syncs and renames over the destination, on failure the destination is left as it was
+bool file_writer_commit(FileWriter* writer)
+{
+    if (!writer || (writer->fd < 0))
+        return false;
+
+    struct iovec rest = { .iov_base = writer->buffer, .iov_len = writer->used };
+
+    bool committed = !writer->failed && ((writer->used == 0) || file_writer_flush_parts(writer, &rest, 1));
+    writer->used = 0;
+
+    if (committed && (fsync(writer->fd) != 0)) {
+        fprintf(stderr, "file_writer_commit: fsync failed on \"%s\"\n", writer->temp_path);
+        committed = false;
+    }
+
+    committed = (close(writer->fd) == 0) && committed;
+    writer->fd = -1;
+
+    if (committed && (rename(writer->temp_path, writer->path) != 0)) {
+        fprintf(stderr, "file_writer_commit: could not replace \"%s\"\n", writer->path);
+        committed = false;
+    }
+
+    if (committed)
+        file_writer_sync_directory(writer->path);
+    else
+        unlink(writer->temp_path);
+
+    file_writer_release(writer);
+
+    return committed;
+}
+
+// drops everything written so far, the destination is never touched
+void file_writer_abort(FileWriter* writer)
+{
+    if (!writer || (writer->fd < 0))
+        return;
+
+    unlink(writer->temp_path);
+    file_writer_release(writer);
+}
+
 void write_string_to_file(const char* filename, const char* string)
 {
     if (!valid_string(filename) || !valid_string(string)) 
         return;
 
-    FILE* fp = fopen(filename, "w");
-    if (!fp) {
-        fprintf(stderr, "write_string_to_file: fopen returned null\n");
+    FileWriter writer;
+    if (!file_writer_open(&writer, filename))
         return;
-    }
 
-    const unsigned long len = strlen(string);
-    
-    fwrite(string, sizeof(char), len, fp);
+    if (!file_writer_write(&writer, string, strlen(string))) {
+        file_writer_abort(&writer);
+        return;
+    }
 
-    fclose(fp); fp = NULL;
+    file_writer_commit(&writer);
 }
 
 int filter_non_numeric_chars(char* string, const size_t string_size)
@@ -150,44 +434,202 @@ bool connected_to_internet()
     return connected;
 }
 
-char** text_split(const char* text, const char delim, int* count, char** copy_out)
+StringView string_view(const char* string)
 {
-    if (!valid_string(text) || (delim == '\0') || !count) 
-        return NULL;
+    return (StringView) {
+        .data = string,
+        .length = (string) ? strlen(string) : 0,
+    };
+}
 
-    (*copy_out) = strdup(text);
-    if ((*copy_out) == NULL) {
-        fprintf(stderr, "text_split: strdup returned null\n");
-        *count = 0;
-        return NULL;
+bool string_view_equals(const StringView view, const char* string)
+{
+    if (!string)
+        return false;
+
+    const size_t length = strlen(string);
+
+    return (view.length == length) && (memcmp(view.data, string, length) == 0);
+}
+
+// 'delim' must outlive the tokenizer, an empty text has no tokens
+TextTokenizer text_tokenizer_init(const char* text, const size_t length, const char* delim, const char quote)
+{
+    return text_tokenizer_init_records(text, length, delim, '\0', quote);
+}
+
+// fields and records in one pass, 'record' ends a token the way 'delim' does and flags it as the last of its record
+TextTokenizer text_tokenizer_init_records(const char* text, const size_t length, const char* delim, const char record, const char quote)
+{
+    const size_t delim_length = (delim) ? strlen(delim) : 0;
+
+    return (TextTokenizer) {
+        .cursor = text,
+        .end = (text) ? (text + length) : NULL,
+        .delim = delim,
+        .delim_length = delim_length,
+        .record = record,
+        .quote = quote,
+        .done = (!text || (length == 0) || (delim_length == 0)),
+        .record_end = false,
+        .block = NULL,
+        .block_length = 0,
+        .hits = 0,
+    };
+}
+
+// next byte equal to 'c' in [from, end), sixteen at a time where SSE2 is available, fields are often only a few
+// bytes long so an inlined compare beats a call to memchr per token
+static const char* text_find_char(const char* from, const char* end, const char c)
+{
+#ifdef __SSE2__
+    const __m128i needle = _mm_set1_epi8(c);
+
+    while ((end - from) >= 16) {
+        const int hits = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) from), needle));
+        if (hits)
+            return from + __builtin_ctz(hits);
+
+        from += 16;
     }
+#endif
+
+    return memchr(from, c, end - from);
+}
+
+static bool text_tokenizer_is_candidate(const TextTokenizer* tokenizer, const char c)
+{
+    return (c == tokenizer->delim[0]) || (tokenizer->record && (c == tokenizer->record));
+}
+
+#ifdef __SSE2__
+// one bit per byte of the 16 at 'from' holding either character
+static unsigned int text_match_16(const char* from, const __m128i first, const __m128i second)
+{
+    const __m128i bytes = _mm_loadu_si128((const __m128i*) from);
 
-    char* copy = (*copy_out);
+    return _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(bytes, first), _mm_cmpeq_epi8(bytes, second)));
+}
+#endif
+
+// next byte at or after 'from' that may end a token, one mask covers the separator and the record byte, and 64 bytes are
+// scanned at once so the block's remaining bits serve the next few tokens without another load or a mispredicted refill
+static const char* text_tokenizer_candidate(TextTokenizer* tokenizer, const char* from)
+{
+#ifdef __SSE2__
+    if (tokenizer->block && (from >= tokenizer->block) && ((size_t)(from - tokenizer->block) < tokenizer->block_length)) {
+        const unsigned long long left = tokenizer->hits & (~0ULL << (from - tokenizer->block));
+        if (left)
+            return tokenizer->block + __builtin_ctzll(left);
 
-    (*count) = 1;
-    for(const char* p = copy; *p; p++) {
-        if (*p == delim) 
-            (*count)++;
+        from = tokenizer->block + tokenizer->block_length;
     }
-    
-    char** tokens = malloc((*count) * sizeof(char*));
-    if (tokens == NULL) {
-        fprintf(stderr, "text_split: malloc returned null\n");
-        *count = 0;
-        return NULL;
+
+    const __m128i separator = _mm_set1_epi8(tokenizer->delim[0]);
+    const __m128i record = _mm_set1_epi8((tokenizer->record) ? tokenizer->record : tokenizer->delim[0]);
+
+    while ((tokenizer->end - from) >= 16) {
+        unsigned long long hits = text_match_16(from, separator, record);
+        size_t length = 16;
+
+        if ((tokenizer->end - from) >= 64) {
+            hits |= ((unsigned long long)text_match_16(from + 16, separator, record) << 16)
+                | ((unsigned long long)text_match_16(from + 32, separator, record) << 32)
+                | ((unsigned long long)text_match_16(from + 48, separator, record) << 48);
+            length = 64;
+        }
+
+        if (hits) {
+            tokenizer->block = from;
+            tokenizer->block_length = length;
+            tokenizer->hits = hits;
+            return from + __builtin_ctzll(hits);
+        }
+
+        from += length;
     }
+#endif
 
-    memset(tokens, 0, (*count) * sizeof(char*));
+    if (!tokenizer->record)
+        return memchr(from, tokenizer->delim[0], tokenizer->end - from);
 
-    int i = 0;
-    tokens[i++] = copy;
-    while ((copy = strchr(copy, delim))) {
-        *(copy++) = '\0';
-        if (i < (*count)) 
-            tokens[i++] = copy;
+    for (; from < tokenizer->end; from++) {
+        if (text_tokenizer_is_candidate(tokenizer, *from))
+            return from;
+    }
+
+    return NULL;
+}
+
+// first separator or record byte at or after 'from'
+static const char* text_tokenizer_find(TextTokenizer* tokenizer, const char* from)
+{
+    while (from < tokenizer->end) {
+        const char* hit = text_tokenizer_candidate(tokenizer, from);
+        if (!hit)
+            return NULL;
+
+        if (tokenizer->record && (*hit == tokenizer->record))
+            return hit;
+
+        if ((tokenizer->delim_length == 1) || (((size_t)(tokenizer->end - hit) >= tokenizer->delim_length) && (memcmp(hit, tokenizer->delim, tokenizer->delim_length) == 0)))
+            return hit;
+
+        from = hit + 1;
     }
 
-    return tokens;
+    return NULL;
+}
+
+// the token between the cursor and the next separator, false once the text is exhausted
+// a quoted token is the text between its quotes, separators inside them do not split it and a doubled quote is left as is,
+// anything between the closing quote and the next separator is dropped
+bool text_tokenizer_next(TextTokenizer* tokenizer, StringView* token)
+{
+    if (!tokenizer || !token || tokenizer->done)
+        return false;
+
+    const char* start = tokenizer->cursor;
+    const char* stop = NULL;
+    const char* search = start;
+
+    if (tokenizer->quote && (start < tokenizer->end) && (*start == tokenizer->quote)) {
+        const char* close = start + 1;
+
+        // a doubled quote is an escaped one, the field goes on
+        while ((close = text_find_char(close, tokenizer->end, tokenizer->quote))) {
+            if (((close + 1) < tokenizer->end) && (close[1] == tokenizer->quote))
+                close += 2;
+            else
+                break;
+        }
+
+        start++;
+        stop = (close) ? close : tokenizer->end;
+        search = (close) ? (close + 1) : tokenizer->end;
+    }
+
+    const char* separator = text_tokenizer_find(tokenizer, search);
+
+    if (!stop)
+        stop = (separator) ? separator : tokenizer->end;
+
+    (*token) = (StringView) {
+        .data = start,
+        .length = stop - start,
+    };
+
+    const bool record = separator && tokenizer->record && (*separator == tokenizer->record);
+
+    // a trailing separator still ends in one last empty token
+    if (separator)
+        tokenizer->cursor = separator + ((record) ? 1 : tokenizer->delim_length);
+    else
+        tokenizer->done = true;
+
+    tokenizer->record_end = record || !separator;
+
+    return true;
 }
 
 void format_view_count(char* dest, const size_t dest_size)
@@ -3,17 +3,84 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <sys/uio.h>
+
+#define FILE_WRITER_BUFFER_SIZE (1 << 20) // writes smaller than this are gathered, larger ones go straight to the file
+
+// a run of characters owned by someone else, not nul terminated
+typedef struct
+{
+    const char* data;
+    size_t length;
+} StringView;
+
+// splits a view without copying or allocating, tokens point into the text
+typedef struct
+{
+    const char* cursor;   // start of the next token
+    const char* end;
+    const char* delim;    // separator, may be several characters
+    size_t delim_length;
+    char record;          // also ends the token, and the record with it, '\0' when the text is a single record
+    char quote;           // a token starting with it runs to the closing one, '\0' when fields are never quoted
+    bool done;
+    bool record_end;      // the token last returned was the final one of its record
+    const char* block;    // bytes last scanned for separators, their candidates are taken one token at a time
+    size_t block_length;  // 64 while the text lasts, 16 near its end
+    unsigned long long hits; // one bit per byte of 'block' holding the separator's first character or 'record'
+} TextTokenizer;
+
+// how a mapping is about to be read, passed on to the kernel as a hint
+typedef enum
+{
+    FILE_ACCESS_NORMAL,
+    FILE_ACCESS_SEQUENTIAL, // front to back, read ahead aggressively
+    FILE_ACCESS_RANDOM,     // scattered reads, read ahead would only waste memory
+    FILE_ACCESS_WILLNEED,   // about to be read, start paging it in now
+} FileAccess;
+
+// read only view of a whole file, parsed in place instead of copied out
+typedef struct
+{
+    const unsigned char* data; // null when nothing is mapped, which includes an empty file
+    size_t size;
+} MappedFile;
+
+// streams a new copy of a file into a temporary next to it, the original is only replaced once every byte is on disk
+typedef struct
+{
+    char* path;            // destination, allocated
+    char* temp_path;       // allocated
+    int fd;
+    unsigned char* buffer; // FILE_WRITER_BUFFER_SIZE bytes, allocated
+    size_t used;
+    size_t written;        // bytes handed to the file so far, buffered ones included
+    bool failed;           // a write failed, commit only cleans up
+} FileWriter;
 
 int bound_index_to_array (const int pos, const int array_size);
 bool file_exists(const char* filename);
 const long get_file_length(FILE* fp);
 char* get_file_content(const char* filepath);
+bool mapped_file_open(MappedFile* file, const char* path, const FileAccess access);
+void mapped_file_close(MappedFile* file);
+bool mapped_file_advise(const MappedFile* file, const size_t offset, const size_t length, const FileAccess access);
+bool file_writer_open(FileWriter* writer, const char* path);
+bool file_writer_write(FileWriter* writer, const void* data, const size_t size);
+bool file_writer_writev(FileWriter* writer, const struct iovec* parts, const int count);
+bool file_writer_commit(FileWriter* writer);
+void file_writer_abort(FileWriter* writer);
 void write_string_to_file(const char* filename, const char* buffer);
 size_t trim_whitespace(char* string);
 int filter_non_numeric_chars(char* string, const size_t string_size);
 bool valid_string(const char* string);
 bool connected_to_internet();
-char** text_split(const char* text, const char delim, int* count, char** copy_output);
+StringView string_view(const char* string);
+bool string_view_equals(const StringView view, const char* string);
+TextTokenizer text_tokenizer_init(const char* text, const size_t length, const char* delim, const char quote);
+TextTokenizer text_tokenizer_init_records(const char* text, const size_t length, const char* delim, const char record, const char quote);
+bool text_tokenizer_next(TextTokenizer* tokenizer, StringView* token);
 void format_view_count(char* dest, const size_t dest_size);
 bool is_file_extension(const char* filepath, const char* extension);
 unsigned long int hash_string(const char* str);
@@ -0,0 +1,318 @@
+#include "world_stream.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static bool stream_queue_push(StreamQueue* queue, const StreamItem item)
+{
+    const size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    const size_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+
+    if ((tail - head) == WORLD_STREAM_QUEUE_SIZE)
+        return false;
+
+    queue->slots[tail & (WORLD_STREAM_QUEUE_SIZE - 1)] = item;
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+
+    return true;
+}
+
+static bool stream_queue_pop(StreamQueue* queue, StreamItem* out)
+{
+    const size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    const size_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+
+    if (head == tail)
+        return false;
+
+    (*out) = queue->slots[head & (WORLD_STREAM_QUEUE_SIZE - 1)];
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+
+    return true;
+}
+
+static void* world_stream_work(void* arg)
+{
+    WorldStream* stream = (WorldStream*) arg;
+
+    while (true) {
+        sem_wait(&stream->pending);
+
+        if (!atomic_load(&stream->running))
+            break;
+
+        StreamItem item;
+
+        pthread_mutex_lock(&stream->request_lock);
+        const bool popped = stream_queue_pop(&stream->requests, &item);
+        pthread_mutex_unlock(&stream->request_lock);
+
+        if (!popped)
+            continue;
+
+        // inflating happens outside the locks, that is the part the readers share out
+        item.chunk = malloc(sizeof(TileChunk));
+        if (item.chunk && !map_file_read_chunk(&stream->map, item.index, item.chunk)) {
+            free(item.chunk); item.chunk = NULL;
+        }
+
+        // in_flight is capped at the queue size, so there is always room
+        pthread_mutex_lock(&stream->result_lock);
+
+        while (!stream_queue_push(&stream->results, item))
+            usleep(1000);
+
+        pthread_mutex_unlock(&stream->result_lock);
+    }
+
+    return NULL;
+}
+
+// wakes every reader so each one sees 'running' cleared, then waits for them
+static void world_stream_stop(WorldStream* stream)
+{
+    atomic_store(&stream->running, false);
+
+    for (int i = 0; i < stream->thread_count; i++)
+        sem_post(&stream->pending);
+
+    for (int i = 0; i < stream->thread_count; i++)
+        pthread_join(stream->threads[i], NULL);
+
+    stream->thread_count = 0;
+}
+
+// the reader threads hold on to the stream, so it lives on the heap where it never moves
+WorldStream* world_stream_open(const char* path, const size_t budget, const map_slot_funct remap, void* user)
+{
+    WorldStream* stream = calloc(1, sizeof(WorldStream));
+    if (!stream) {
+        fprintf(stderr, "world_stream_open: calloc returned null\n");
+        return NULL;
+    }
+
+    if (!map_file_open(&stream->map, path, remap, user)) {
+        free(stream); stream = NULL;
+        return NULL;
+    }
+
+    stream->budget = budget;
+
+    atomic_init(&stream->requests.head, 0);
+    atomic_init(&stream->requests.tail, 0);
+    atomic_init(&stream->results.head, 0);
+    atomic_init(&stream->results.tail, 0);
+    atomic_init(&stream->running, true);
+
+    if (sem_init(&stream->pending, 0, 0) != 0) {
+        fprintf(stderr, "world_stream_open: sem_init failed\n");
+        map_file_close(&stream->map);
+        free(stream); stream = NULL;
+        return NULL;
+    }
+
+    pthread_mutex_init(&stream->request_lock, NULL);
+    pthread_mutex_init(&stream->result_lock, NULL);
+
+    // one reader per core up to the cap, a single core still gets its one reader
+    const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    const int readers = (cores < 1) ? 1 : ((cores > WORLD_STREAM_MAX_READERS) ? WORLD_STREAM_MAX_READERS : cores);
+
+    for (int i = 0; i < readers; i++) {
+        if (pthread_create(&stream->threads[i], NULL, world_stream_work, stream) != 0)
+            break;
+
+        stream->thread_count++;
+    }
+
+    // fewer readers than asked for only slows loading down, none at all means nothing would ever load
+    if (stream->thread_count == 0) {
+        fprintf(stderr, "world_stream_open: pthread_create failed\n");
+        pthread_mutex_destroy(&stream->request_lock);
+        pthread_mutex_destroy(&stream->result_lock);
+        sem_destroy(&stream->pending);
+        map_file_close(&stream->map);
+        free(stream); stream = NULL;
+        return NULL;
+    }
+
+    return stream;
+}
+
+void world_stream_close(WorldStream* stream)
+{
+    if (!stream)
+        return;
+
+    world_stream_stop(stream);
+
+    pthread_mutex_destroy(&stream->request_lock);
+    pthread_mutex_destroy(&stream->result_lock);
+    sem_destroy(&stream->pending);
+
+    StreamItem item;
+    while (stream_queue_pop(&stream->results, &item)) {
+        if (item.chunk) {
+            free(item.chunk); item.chunk = NULL;
+        }
+    }
+
+    if (stream->resident) {
+        free(stream->resident); stream->resident = NULL;
+    }
+
+    map_file_close(&stream->map);
+
+    free(stream); stream = NULL;
+}
+
+static bool world_stream_push_resident(WorldStream* stream, const size_t index)
+{
+    if (stream->resident_count == stream->resident_capacity) {
+        const size_t capacity = (stream->resident_capacity) ? (stream->resident_capacity * 2) : 1024;
+
+        size_t* resident = malloc(sizeof(size_t) * capacity);
+        if (!resident) {
+            fprintf(stderr, "world_stream_push_resident: malloc returned null\n");
+            return false;
+        }
+
+        // unwrap the ring into the new buffer
+        for (size_t i = 0; i < stream->resident_count; i++)
+            resident[i] = stream->resident[(stream->resident_head + i) % stream->resident_capacity];
+
+        if (stream->resident)
+            free(stream->resident);
+
+        stream->resident = resident;
+        stream->resident_capacity = capacity;
+        stream->resident_head = 0;
+    }
+
+    stream->resident[(stream->resident_head + stream->resident_count++) % stream->resident_capacity] = index;
+
+    return true;
+}
+
+static size_t world_stream_pop_resident(WorldStream* stream)
+{
+    const size_t index = stream->resident[stream->resident_head];
+
+    stream->resident_head = (stream->resident_head + 1) % stream->resident_capacity;
+    stream->resident_count--;
+
+    return index;
+}
+
+// hands a finished read to the grid, cells painted while the block was in flight win over the file's
+static void world_stream_accept(WorldStream* stream, TileGrid* grid, const StreamItem item)
+{
+    MapChunkEntry* entry = &stream->map.chunks[item.index];
+
+    if (!item.chunk) {
+        entry->state = MAP_CHUNK_FAILED;
+        return;
+    }
+
+    TileChunk* painted = tile_grid_find_chunk(grid, item.chunk->cx, item.chunk->cy);
+
+    if (painted) {
+        for (int c = 0; c < TILE_CHUNK_CELLS; c++) {
+            if (!tile_cell_is_empty(painted->cells[c]) || tile_cell_is_empty(item.chunk->cells[c]))
+                continue;
+
+            painted->cells[c] = item.chunk->cells[c];
+            painted->count++;
+            grid->cell_count++;
+        }
+
+        // version 0 never matches, the merged chunk differs from the file and is never evicted
+        tile_grid_touch_chunk(grid, painted);
+        entry->version = 0;
+
+        free(item.chunk);
+    }
+    else {
+        tile_grid_insert_chunk(grid, item.chunk);
+        entry->version = grid->revision;
+
+        world_stream_push_resident(stream, item.index);
+    }
+
+    entry->state = MAP_CHUNK_IN_GRID;
+    stream->loaded_chunks++;
+}
+
+// oldest loads go first, while panning that is also the chunk farthest behind the camera, costs O(evicted) rather than O(resident)
+static void world_stream_evict(WorldStream* stream, TileGrid* grid, const int cx0, const int cy0, const int cx1, const int cy1)
+{
+    // evicting down to three quarters of the budget keeps this from running every frame
+    const size_t target = (stream->budget / 4) * 3;
+
+    for (size_t n = stream->resident_count; (n > 0) && (tile_grid_memory_usage(grid) > target); n--) {
+        const size_t index = world_stream_pop_resident(stream);
+        MapChunkEntry* entry = &stream->map.chunks[index];
+
+        if (entry->state != MAP_CHUNK_IN_GRID)
+            continue;
+
+        const int cx = (int)(entry->key >> 32);
+        const int cy = (int)(entry->key & 0xFFFFFFFF);
+
+        // erased since it was loaded, nothing left to evict
+        TileChunk* chunk = tile_grid_find_chunk(grid, cx, cy);
+        if (!chunk)
+            continue;
+
+        // only chunks identical to their block can be dropped, an edited one stays until it is saved
+        if (chunk->version != entry->version)
+            continue;
+
+        // still in view, check it again on a later pass
+        if ((cx >= cx0) && (cx <= cx1) && (cy >= cy0) && (cy <= cy1)) {
+            world_stream_push_resident(stream, index);
+            continue;
+        }
+
+        entry->state = MAP_CHUNK_ON_DISK;
+        entry->version = 0;
+
+        tile_grid_remove_chunk(grid, chunk);
+        stream->evicted_chunks++;
+    }
+}
+
+// call once per frame with the chunk window in view: takes in finished reads, requests missing chunks and evicts far ones
+void world_stream_update(WorldStream* stream, TileGrid* grid, const int cx0, const int cy0, const int cx1, const int cy1)
+{
+    if (!stream || !grid)
+        return;
+
+    StreamItem item;
+    while (stream_queue_pop(&stream->results, &item)) {
+        stream->in_flight--;
+        world_stream_accept(stream, grid, item);
+    }
+
+    const int x0 = cx0 - WORLD_STREAM_MARGIN, x1 = cx1 + WORLD_STREAM_MARGIN;
+    const int y0 = cy0 - WORLD_STREAM_MARGIN, y1 = cy1 + WORLD_STREAM_MARGIN;
+
+    for (int cy = y0; (cy <= y1) && (stream->in_flight < WORLD_STREAM_QUEUE_SIZE); cy++) {
+        for (int cx = x0; (cx <= x1) && (stream->in_flight < WORLD_STREAM_QUEUE_SIZE); cx++) {
+            const long index = map_file_find_chunk(&stream->map, cx, cy);
+            if ((index < 0) || (stream->map.chunks[index].state != MAP_CHUNK_ON_DISK))
+                continue;
+
+            if (!stream_queue_push(&stream->requests, (StreamItem){ .index = index, .chunk = NULL }))
+                break;
+
+            stream->map.chunks[index].state = MAP_CHUNK_REQUESTED;
+            stream->in_flight++;
+            sem_post(&stream->pending);
+        }
+    }
+
+    if (tile_grid_memory_usage(grid) > stream->budget)
+        world_stream_evict(stream, grid, x0, y0, x1, y1);
+}
\ No newline at end of file
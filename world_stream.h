@@ -0,0 +1,57 @@
+#ifndef WORLD_STREAM_H
+#define WORLD_STREAM_H
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#include "tile_grid.h"
+#include "map_file.h"
+
+#define WORLD_STREAM_QUEUE_SIZE 256 // must be a power of two
+#define WORLD_STREAM_MARGIN 2       // chunks kept around the view so panning finds them already loaded
+#define WORLD_STREAM_MAX_READERS 4  // reader threads, inflating blocks is what a fast pan waits on
+
+typedef struct
+{
+    size_t index;     // toc entry of the chunk
+    TileChunk* chunk; // null in a request, or when the block could not be read
+} StreamItem;
+
+// single producer, single consumer ring, same contract as AssetQueue, the readers take turns at their end through a lock
+typedef struct
+{
+    StreamItem slots[WORLD_STREAM_QUEUE_SIZE];
+    atomic_size_t head;
+    atomic_size_t tail;
+} StreamQueue;
+
+typedef struct
+{
+    MapFile map;
+    pthread_t threads[WORLD_STREAM_MAX_READERS];
+    int thread_count;
+    sem_t pending;
+    atomic_bool running;
+    StreamQueue requests; // main thread -> readers
+    StreamQueue results;  // readers -> main thread
+    pthread_mutex_t request_lock; // held by the reader popping a request
+    pthread_mutex_t result_lock;  // held by the reader pushing a result
+    size_t in_flight;     // never above WORLD_STREAM_QUEUE_SIZE, so a reader never waits on the main thread
+    size_t budget;        // grid bytes above which chunks that still match the file are evicted
+    size_t* resident;     // ring of toc entries in the order they were loaded, the eviction order, allocated
+    size_t resident_head;
+    size_t resident_count;
+    size_t resident_capacity;
+
+    // stats
+    size_t loaded_chunks;
+    size_t evicted_chunks;
+} WorldStream;
+
+WorldStream* world_stream_open(const char* path, const size_t budget, const map_slot_funct remap, void* user);
+void world_stream_close(WorldStream* stream);
+void world_stream_update(WorldStream* stream, TileGrid* grid, const int cx0, const int cy0, const int cx1, const int cy1);
+
+#endif
\ No newline at end of file